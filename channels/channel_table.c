@@ -0,0 +1,208 @@
+#include "channels/channel_table.h"
+
+#include <errno.h> // for errno
+#include <fcntl.h> // for open
+#include <string.h> // for memcmp
+#include <sys/mman.h> // for mmap
+#include <sys/stat.h> // for fstat
+#include <unistd.h> // for close
+
+_Static_assert(sizeof(ChannelTableEntry) == 32, "ChannelTableEntry is part of the file format");
+
+// The default lineup's favorites, in ascending order.
+static const unsigned short DEFAULT_FAVORITES[] = { 1, 7, 42, 101, 200 };
+
+static const ChannelTableEntry* entry(const ChannelTable* table, const unsigned short channel)
+{
+    return (channel < CHANNEL_TABLE_ENTRY_COUNT) ? &table->entries[channel] : NULL;
+}
+
+bool channel_table_link(ChannelTableEntry* entries)
+{
+    int first = 0;
+    int last = 0;
+    int first_favorite = 0;
+    for (int channel = CHANNEL_TABLE_MIN_CHANNEL; channel <= CHANNEL_TABLE_MAX_CHANNEL; channel++)
+    {
+        if (entries[channel].flags & CHANNEL_ENABLED)
+        {
+            first = first ? first : channel;
+            last = channel;
+            if ((entries[channel].flags & CHANNEL_FAVORITE) && first_favorite == 0)
+            {
+                first_favorite = channel;
+            }
+        }
+    }
+    if (first == 0)
+    {
+        return false;
+    }
+
+    // Walk down once for the next links & up once for the previous ones.
+    int next = first;
+    int next_favorite = first_favorite;
+    for (int channel = CHANNEL_TABLE_ENTRY_COUNT - 1; channel >= 0; channel--)
+    {
+        entries[channel].next = (uint16_t)next;
+        entries[channel].next_favorite = (uint16_t)(next_favorite ? next_favorite : channel);
+        if (entries[channel].flags & CHANNEL_ENABLED)
+        {
+            next = channel;
+            if (entries[channel].flags & CHANNEL_FAVORITE)
+            {
+                next_favorite = channel;
+            }
+        }
+    }
+    int prev = last;
+    for (int channel = 0; channel < CHANNEL_TABLE_ENTRY_COUNT; channel++)
+    {
+        entries[channel].prev = (uint16_t)prev;
+        if (entries[channel].flags & CHANNEL_ENABLED)
+        {
+            prev = channel;
+        }
+    }
+    return true;
+}
+
+bool channel_table_validate(const ChannelTableEntry* entries)
+{
+    ChannelTableEntry linked[CHANNEL_TABLE_ENTRY_COUNT];
+    memcpy(linked, entries, sizeof(linked));
+    if ((entries[0].flags & CHANNEL_ENABLED) || !channel_table_link(linked))
+    {
+        return false;
+    }
+    for (int channel = 0; channel < CHANNEL_TABLE_ENTRY_COUNT; channel++)
+    {
+        const ChannelTableEntry* e = &entries[channel];
+        if ((e->flags & ~(CHANNEL_ENABLED | CHANNEL_FAVORITE)) != 0
+            || ((e->flags & CHANNEL_FAVORITE) && !(e->flags & CHANNEL_ENABLED))
+            || memchr(e->name, '\0', sizeof(e->name)) == NULL
+            || e->next != linked[channel].next
+            || e->prev != linked[channel].prev
+            || e->next_favorite != linked[channel].next_favorite)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool channel_table_open(ChannelTable* table, const char* path)
+{
+    memset(table, 0, sizeof(*table));
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == -1)
+    {
+        close(fd);
+        return false;
+    }
+    const size_t size = CHANNEL_TABLE_HEADER_SIZE + CHANNEL_TABLE_ENTRY_COUNT * sizeof(ChannelTableEntry);
+    if ((size_t)info.st_size != size)
+    {
+        close(fd);
+        errno = EINVAL;
+        return false;
+    }
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return false;
+    }
+
+    const unsigned char* header = map;
+    const uint16_t count = (uint16_t)(header[8] | header[9] << 8);
+    const uint16_t entry_size = (uint16_t)(header[10] | header[11] << 8);
+    const ChannelTableEntry* entries = (const ChannelTableEntry*)(header + CHANNEL_TABLE_HEADER_SIZE);
+    if (memcmp(header, CHANNEL_TABLE_MAGIC, 8) != 0 || count != CHANNEL_TABLE_ENTRY_COUNT
+        || entry_size != sizeof(ChannelTableEntry) || !channel_table_validate(entries))
+    {
+        munmap(map, size);
+        errno = EINVAL;
+        return false;
+    }
+    table->entries = entries;
+    table->map = map;
+    table->map_size = size;
+    return true;
+}
+
+void channel_table_close(ChannelTable* table)
+{
+    if (table->map != NULL)
+    {
+        munmap(table->map, table->map_size);
+    }
+    memset(table, 0, sizeof(*table));
+}
+
+unsigned short channel_table_first(const ChannelTable* table)
+{
+    if (table == NULL)
+    {
+        return CHANNEL_TABLE_MIN_CHANNEL;
+    }
+    return table->entries[0].next;
+}
+
+unsigned short channel_table_next(const ChannelTable* table, const unsigned short channel)
+{
+    if (table == NULL)
+    {
+        return (channel >= CHANNEL_TABLE_MAX_CHANNEL) ? CHANNEL_TABLE_MIN_CHANNEL : channel + 1;
+    }
+    const ChannelTableEntry* e = entry(table, channel);
+    return e ? e->next : channel_table_first(table);
+}
+
+unsigned short channel_table_prev(const ChannelTable* table, const unsigned short channel)
+{
+    if (table == NULL)
+    {
+        return (channel <= CHANNEL_TABLE_MIN_CHANNEL) ? CHANNEL_TABLE_MAX_CHANNEL : channel - 1;
+    }
+    const ChannelTableEntry* e = entry(table, channel);
+    return e ? e->prev : table->entries[0].prev;
+}
+
+unsigned short channel_table_next_favorite(const ChannelTable* table, const unsigned short channel)
+{
+    if (table == NULL)
+    {
+        for (unsigned int i = 0; i < sizeof(DEFAULT_FAVORITES) / sizeof(DEFAULT_FAVORITES[0]); i++)
+        {
+            if (DEFAULT_FAVORITES[i] > channel)
+            {
+                return DEFAULT_FAVORITES[i];
+            }
+        }
+        return DEFAULT_FAVORITES[0];
+    }
+    const ChannelTableEntry* e = entry(table, channel);
+    return e ? e->next_favorite : table->entries[0].next_favorite;
+}
+
+bool channel_table_is_enabled(const ChannelTable* table, const unsigned short channel)
+{
+    if (table == NULL)
+    {
+        return channel >= CHANNEL_TABLE_MIN_CHANNEL && channel <= CHANNEL_TABLE_MAX_CHANNEL;
+    }
+    const ChannelTableEntry* e = entry(table, channel);
+    return e && (e->flags & CHANNEL_ENABLED);
+}
+
+const char* channel_table_name(const ChannelTable* table, const unsigned short channel)
+{
+    const ChannelTableEntry* e = (table != NULL) ? entry(table, channel) : NULL;
+    return e ? e->name : "";
+}
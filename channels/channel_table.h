@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdbool.h> // for bool
+#include <stddef.h> // for size_t
+#include <stdint.h> // for uint16_t
+
+// Channel lineup: which channel numbers are in use, their names & the favorites.
+//
+// The table is a binary file that is memory-mapped as is. It has one fixed size entry per channel
+// number, and every entry (in use or not) carries precomputed links to the next & previous channel in
+// use and to the next favorite, so channel up/down & the favorites jump over unused numbers in O(1).
+// `build_channel_table` builds it from a CSV file.
+//
+// The functions take NULL for the default lineup: every channel in [1, 256] is in use and the
+// favorites are 1, 7, 42, 101 & 200 (what the JavaScript machine does).
+//
+// File format (little endian):
+//   header:  "TVCHAN01", u16 entry count (CHANNEL_TABLE_ENTRY_COUNT), u16 entry size, u32 0
+//   entries: one per channel number from 0 (never in use), see ChannelTableEntry.
+
+#define CHANNEL_TABLE_MIN_CHANNEL 1
+#define CHANNEL_TABLE_MAX_CHANNEL 256
+#define CHANNEL_TABLE_ENTRY_COUNT (CHANNEL_TABLE_MAX_CHANNEL + 1)
+#define CHANNEL_TABLE_NAME_SIZE 24
+
+#define CHANNEL_TABLE_MAGIC "TVCHAN01"
+#define CHANNEL_TABLE_HEADER_SIZE 16
+
+// Entry flags.
+#define CHANNEL_ENABLED 0x01
+#define CHANNEL_FAVORITE 0x02
+
+typedef struct ChannelTableEntry {
+    // The next & previous enabled channel, wrapping around.
+    uint16_t next;
+    uint16_t prev;
+    // The next favorite channel, wrapping around. The channel itself if there are no favorites.
+    uint16_t next_favorite;
+    uint8_t flags;
+    uint8_t reserved;
+    // NUL terminated, empty if the channel has no name.
+    char name[CHANNEL_TABLE_NAME_SIZE];
+} ChannelTableEntry;
+
+typedef struct ChannelTable {
+    // Indexed by channel number.
+    const ChannelTableEntry* entries;
+    // The mapping.
+    void* map;
+    size_t map_size;
+} ChannelTable;
+
+// Map the table file at `path` & check it. Returns false (errno is set, EINVAL for a malformed file).
+bool channel_table_open(ChannelTable* table, const char* path);
+
+// Unmap the table.
+void channel_table_close(ChannelTable* table);
+
+// Check the flags, names & links of the CHANNEL_TABLE_ENTRY_COUNT `entries`. Returns false if any is off.
+bool channel_table_validate(const ChannelTableEntry* entries);
+
+// Fill in the links of `entries` (CHANNEL_TABLE_ENTRY_COUNT of them) from their flags.
+// Returns false if no channel is enabled.
+bool channel_table_link(ChannelTableEntry* entries);
+
+// The lowest enabled channel.
+unsigned short channel_table_first(const ChannelTable* table);
+
+// The enabled channel after/before `channel`, wrapping around.
+unsigned short channel_table_next(const ChannelTable* table, const unsigned short channel);
+unsigned short channel_table_prev(const ChannelTable* table, const unsigned short channel);
+
+// The favorite after `channel`, wrapping around.
+unsigned short channel_table_next_favorite(const ChannelTable* table, const unsigned short channel);
+
+// True if `channel` is in range & enabled.
+bool channel_table_is_enabled(const ChannelTable* table, const unsigned short channel);
+
+// The name of `channel`, "" if it has none.
+const char* channel_table_name(const ChannelTable* table, const unsigned short channel);
@@ -0,0 +1,328 @@
+#include "input/gesture.h"
+
+#ifndef TVREMOTE_EMBEDDED
+#include <stdio.h> // for fprintf
+#endif
+#include <string.h> // for memset
+
+static long long event_time_us(const struct input_event* event)
+{
+    return (long long)event->input_event_sec * SECONDS_TO_MS * MS_TO_MICROSEC + (long long)event->input_event_usec;
+}
+
+// Whether the active state (or one of its ancestors) listens to `event_id`.
+static bool is_handled(const GestureRecognizer* gestures, const int event_id)
+{
+    if (event_id == NO_EVENT)
+    {
+        return false;
+    }
+    if (gestures->machine != NULL)
+    {
+        return gestures->machine->handles(gestures->machine->ctx, event_id);
+    }
+    return gestures->sm->current_event_handlers[event_id] != NULL;
+}
+
+// Whether another press of `key` could still turn into a gesture.
+static bool more_taps_handled(const GestureRecognizer* gestures, const GestureKey* key)
+{
+    return gestures->tap_window_us > 0
+        && key->taps < GESTURE_MAX_TAPS
+        && is_handled(gestures, key->tap_events[key->taps]);
+}
+
+static int dispatch(GestureRecognizer* gestures, const int event_id, const struct input_event* source)
+{
+    if (gestures->machine != NULL)
+    {
+        gestures->machine->dispatch(gestures->machine->ctx, event_id);
+    }
+    else
+    {
+        TvRemoteSm_dispatch_event(gestures->sm, (TvRemoteSm_EventId)event_id);
+    }
+    if (gestures->on_dispatch != NULL)
+    {
+        gestures->on_dispatch(gestures->ctx, event_id, source);
+    }
+    return 1;
+}
+
+// Dispatch the presses held back for `key` as the gesture they add up to, or one by one.
+static int flush_key(GestureRecognizer* gestures, GestureKey* key, const long long now_us)
+{
+    const int taps = key->taps;
+    if (taps == 0)
+    {
+        return 0;
+    }
+    key->taps = 0;
+    histogram_record(&gestures->press_delay, (uint64_t)(now_us > key->last_press_us ? now_us - key->last_press_us : 0));
+    gestures->delayed_presses += (uint64_t)taps;
+
+    const int gesture = key->tap_events[taps - 1];
+    if (taps > 1 && is_handled(gestures, gesture))
+    {
+        gestures->multi_taps++;
+        return dispatch(gestures, gesture, &key->last_press);
+    }
+    int dispatched = 0;
+    for (int i = 0; i < taps; i++)
+    {
+        dispatched += dispatch(gestures, key->tap_events[0], &key->last_press);
+    }
+    return dispatched;
+}
+
+// Flush both keys, the one pressed first goes first.
+static int flush_keys(GestureRecognizer* gestures, const long long now_us, const bool only_due)
+{
+    GestureKey* first = &gestures->b1;
+    GestureKey* second = &gestures->b2;
+    if (second->taps > 0 && (first->taps == 0 || second->last_press_us < first->last_press_us))
+    {
+        first = &gestures->b2;
+        second = &gestures->b1;
+    }
+    int dispatched = 0;
+    if (first->taps > 0 && (!only_due || first->deadline_us <= now_us))
+    {
+        dispatched += flush_key(gestures, first, now_us);
+    }
+    if (second->taps > 0 && (!only_due || second->deadline_us <= now_us))
+    {
+        dispatched += flush_key(gestures, second, now_us);
+    }
+    return dispatched;
+}
+
+static int press(GestureRecognizer* gestures, GestureKey* key, GestureKey* other, const struct input_event* event, const long long now_us)
+{
+    int dispatched = 0;
+
+    // Chord: the other key is held down & its press is still held back.
+    if (other->taps == 1 && other->state.pressed
+        && gestures->chord_window_us > 0 && now_us - other->last_press_us <= gestures->chord_window_us
+        && is_handled(gestures, gestures->chord_event))
+    {
+        dispatched += flush_key(gestures, key, now_us);
+        other->taps = 0;
+        // Holding the chord doesn't also make a long-press.
+        key->state.long_press = true;
+        other->state.long_press = true;
+        gestures->chords++;
+        return dispatched + dispatch(gestures, gestures->chord_event, event);
+    }
+
+    // Pressing one key ends the taps of the other.
+    dispatched += flush_key(gestures, other, now_us);
+
+    key->taps++;
+    key->last_press_us = now_us;
+    key->last_press = *event;
+    if (more_taps_handled(gestures, key))
+    {
+        key->deadline_us = now_us + gestures->tap_window_us;
+        return dispatched;
+    }
+    if (key->taps == 1 && gestures->chord_window_us > 0 && is_handled(gestures, gestures->chord_event))
+    {
+        key->deadline_us = now_us + gestures->chord_window_us;
+        return dispatched;
+    }
+    if (key->taps == 1)
+    {
+        // Nothing to wait for: the single press path.
+        key->taps = 0;
+        gestures->immediate_presses++;
+        return dispatched + dispatch(gestures, key->tap_events[0], event);
+    }
+    return dispatched + flush_key(gestures, key, now_us);
+}
+
+static void gesture_key_init(GestureKey* key, const TvRemoteSm_EventId press_event, const TvRemoteSm_EventId long_press_event,
+    const int double_press_event, const int triple_press_event)
+{
+    memset(key, 0, sizeof(*key));
+    key_state_init(&key->state, press_event, long_press_event);
+    key->tap_events[0] = press_event;
+    key->tap_events[1] = double_press_event;
+    key->tap_events[2] = triple_press_event;
+}
+
+void gesture_init(GestureRecognizer* gestures, TvRemoteSm* sm, const unsigned int tap_window_ms, const unsigned int chord_window_ms)
+{
+    memset(gestures, 0, sizeof(*gestures));
+    gesture_key_init(&gestures->b1, TvRemoteSm_EventId_B1_PRESS, TvRemoteSm_EventId_B1_LONG_PRESS,
+        TvRemoteSm_EventId_B1_DOUBLE_PRESS, NO_EVENT);
+    gesture_key_init(&gestures->b2, TvRemoteSm_EventId_B2_PRESS, TvRemoteSm_EventId_B2_LONG_PRESS,
+        TvRemoteSm_EventId_B2_DOUBLE_PRESS, TvRemoteSm_EventId_B2_TRIPLE_PRESS);
+    gestures->chord_event = TvRemoteSm_EventId_CHORD_PRESS;
+    gestures->tap_window_us = (long long)tap_window_ms * MS_TO_MICROSEC;
+    gestures->chord_window_us = (long long)chord_window_ms * MS_TO_MICROSEC;
+    gestures->sm = sm;
+    histogram_reset(&gestures->press_delay);
+}
+
+void gesture_set_hold_timer(GestureRecognizer* gestures, const bool enabled)
+{
+    gestures->hold_timer = enabled;
+}
+
+void gesture_set_machine(GestureRecognizer* gestures, const GestureMachine* machine)
+{
+    gestures->machine = machine;
+}
+
+void gesture_set_callback(GestureRecognizer* gestures, GestureDispatchCallback on_dispatch, void* ctx)
+{
+    gestures->on_dispatch = on_dispatch;
+    gestures->ctx = ctx;
+}
+
+int gesture_handle_input_event(GestureRecognizer* gestures, const struct input_event* event)
+{
+    switch (event->code)
+    {
+    case B1_CODE:
+        return gesture_handle_button_event(gestures, GESTURE_B1, event);
+    case B2_CODE:
+        return gesture_handle_button_event(gestures, GESTURE_B2, event);
+    default:
+        // Ignore other keys.
+        return 0;
+    }
+}
+
+int gesture_handle_button_event(GestureRecognizer* gestures, const GestureButton button, const struct input_event* event)
+{
+    if (event->type != EV_KEY || event->value < RELEASED_EVENT || event->value > REPEATED_EVENT)
+    {
+        return 0;
+    }
+
+    GestureKey* key = (button == GESTURE_B1) ? &gestures->b1 : &gestures->b2;
+    GestureKey* other = (button == GESTURE_B1) ? &gestures->b2 : &gestures->b1;
+
+    // Whatever ran out before this event goes first.
+    const long long now_us = event_time_us(event);
+    int dispatched = gesture_expire(gestures, now_us);
+    if (event->value == REPEATED_EVENT && gestures->hold_timer)
+    {
+        return dispatched;
+    }
+
+    const int event_id = key_state_update(event->value, eventTimeInMilliseconds(event), &key->state);
+    if (event->value == RELEASED_EVENT && key->taps > 0 && !more_taps_handled(gestures, key))
+    {
+        // Only waiting for a chord, which needs the key held down.
+        return dispatched + flush_key(gestures, key, now_us);
+    }
+    if (event_id == NO_EVENT)
+    {
+        return dispatched;
+    }
+    if (event_id == key->state.press_event)
+    {
+        return dispatched + press(gestures, key, other, event, now_us);
+    }
+
+    // Long-press: the presses before it are dispatched first.
+    dispatched += flush_keys(gestures, now_us, false);
+    return dispatched + dispatch(gestures, event_id, event);
+}
+
+// When the long-press of `key` is due (us), or -1 if it isn't held or already long-pressed.
+static long long hold_deadline_us(const GestureKey* key)
+{
+    if (!key->state.pressed || key->state.long_press)
+    {
+        return -1;
+    }
+    // key_state_update() needs more than LONG_PRESS_TIMEOUT ms.
+    return ((long long)key->state.press_start_time + LONG_PRESS_TIMEOUT + 1) * MS_TO_MICROSEC;
+}
+
+// The long-press of `key` from the hold timer, as key_state_update() does for a key repeat.
+static int expire_hold(GestureRecognizer* gestures, GestureKey* key, const long long now_us)
+{
+    const long long deadline_us = hold_deadline_us(key);
+    if (deadline_us < 0 || deadline_us > now_us)
+    {
+        return 0;
+    }
+    key->state.long_press = true;
+    struct input_event source = key->last_press;
+    source.value = REPEATED_EVENT;
+    source.input_event_sec = now_us / (SECONDS_TO_MS * MS_TO_MICROSEC);
+    source.input_event_usec = now_us % (SECONDS_TO_MS * MS_TO_MICROSEC);
+    const int dispatched = flush_keys(gestures, now_us, false);
+    return dispatched + dispatch(gestures, key->state.long_press_event, &source);
+}
+
+int gesture_expire(GestureRecognizer* gestures, const long long now_us)
+{
+    int dispatched = flush_keys(gestures, now_us, true);
+    if (gestures->hold_timer)
+    {
+        dispatched += expire_hold(gestures, &gestures->b1, now_us);
+        dispatched += expire_hold(gestures, &gestures->b2, now_us);
+    }
+    return dispatched;
+}
+
+int gesture_flush(GestureRecognizer* gestures)
+{
+    const long long last_us = gestures->b1.last_press_us > gestures->b2.last_press_us
+        ? gestures->b1.last_press_us : gestures->b2.last_press_us;
+    return flush_keys(gestures, last_us, false);
+}
+
+int gesture_timeout_ms(const GestureRecognizer* gestures, const long long now_us)
+{
+    long long deadline_us = -1;
+    if (gestures->b1.taps > 0)
+    {
+        deadline_us = gestures->b1.deadline_us;
+    }
+    if (gestures->b2.taps > 0 && (deadline_us == -1 || gestures->b2.deadline_us < deadline_us))
+    {
+        deadline_us = gestures->b2.deadline_us;
+    }
+    for (int i = 0; i < 2 && gestures->hold_timer; i++)
+    {
+        const long long hold_us = hold_deadline_us((i == 0) ? &gestures->b1 : &gestures->b2);
+        if (hold_us >= 0 && (deadline_us == -1 || hold_us < deadline_us))
+        {
+            deadline_us = hold_us;
+        }
+    }
+    if (deadline_us == -1)
+    {
+        return -1;
+    }
+    if (deadline_us <= now_us)
+    {
+        return 0;
+    }
+    return (int)((deadline_us - now_us + MS_TO_MICROSEC - 1) / MS_TO_MICROSEC);
+}
+
+#ifndef TVREMOTE_EMBEDDED
+void gesture_report(const GestureRecognizer* gestures)
+{
+    const Histogram* delay = &gestures->press_delay;
+    fprintf(stderr, "Gestures: %llu presses dispatched right away, %llu held back, %llu double/triple presses, %llu chords.\n",
+        (unsigned long long)gestures->immediate_presses, (unsigned long long)gestures->delayed_presses,
+        (unsigned long long)gestures->multi_taps, (unsigned long long)gestures->chords);
+    if (delay->total > 0)
+    {
+        fprintf(stderr, "Added delay (us): p50 %llu, p99 %llu, max %llu (tap window %lld, chord window %lld).\n",
+            (unsigned long long)histogram_percentile(delay, 50),
+            (unsigned long long)histogram_percentile(delay, 99),
+            (unsigned long long)delay->max,
+            gestures->tap_window_us, gestures->chord_window_us);
+    }
+}
+#endif
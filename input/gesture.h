@@ -0,0 +1,117 @@
+#pragma once
+
+#include <linux/input.h> // for input_event
+#include <stdbool.h> // for bool
+#include <stdint.h> // for uint64_t
+
+#include "input/key_input.h"
+#include "metrics/histogram.h"
+#include "state_machine/TvRemoteSm.h"
+
+// Gesture recognizer between the keys & the state machine.
+//
+// Turns timed key edges into the diagram's gesture events:
+//   - CHORD_PRESS: B1 & B2 pressed within the chord window of each other,
+//   - B1_DOUBLE_PRESS, B2_DOUBLE_PRESS / B2_TRIPLE_PRESS: B1 pressed twice, B2 pressed 2/3 times, each press
+//     within the tap window of the previous.
+// Each key is a small automaton: idle -> 1 tap pending -> 2 taps pending -> ... A pending press is
+// dispatched when its window runs out, when the other key is pressed, or when a long-press starts.
+//
+// A press is only held back when the active state handles the gesture it could become: in TV_OFF
+// (or with both windows set to 0) every press is dispatched right away. Otherwise the added delay is
+// bounded by the tap window (B2, B1 in channel select) or the chord window (B1), and recorded per press.
+
+// Default windows in ms.
+#define DEFAULT_TAP_WINDOW 250
+#define DEFAULT_CHORD_WINDOW 50
+
+// Presses counted per key: press, double press, triple press.
+#define GESTURE_MAX_TAPS 3
+
+// The two buttons of a remote, for input that doesn't use B1_CODE & B2_CODE (see gesture_handle_button_event()).
+typedef enum GestureButton
+{
+    GESTURE_B1 = 0,
+    GESTURE_B2 = 1,
+} GestureButton;
+
+// A state machine that isn't a TvRemoteSm of this build (e.g. loaded with dlopen, see sm_reload.h).
+// Takes the TvRemoteSm_EventId values of this build.
+typedef struct GestureMachine {
+    void (*dispatch)(void* ctx, const int event_id);
+    // Whether the active state handles `event_id`.
+    bool (*handles)(void* ctx, const int event_id);
+    void* ctx;
+} GestureMachine;
+
+// Called after every event the recognizer dispatches, with the key event it comes from
+// (the last press of a gesture).
+typedef void (*GestureDispatchCallback)(void* ctx, const int event_id, const struct input_event* source);
+
+typedef struct GestureKey {
+    KeyState state;
+    // Events for 1, 2 & 3 presses. NO_EVENT if the diagram has none.
+    int tap_events[GESTURE_MAX_TAPS];
+    // Presses not dispatched yet, the time of the last one (us) & its key event.
+    int taps;
+    long long last_press_us;
+    struct input_event last_press;
+    // When the pending presses are dispatched (us).
+    long long deadline_us;
+} GestureKey;
+
+typedef struct GestureRecognizer {
+    GestureKey b1;
+    GestureKey b2;
+    int chord_event;
+    long long tap_window_us;
+    long long chord_window_us;
+    TvRemoteSm* sm;
+    // Used instead of `sm` when set.
+    const GestureMachine* machine;
+    GestureDispatchCallback on_dispatch;
+    void* ctx;
+    // Long-presses come from a timer (see gesture_set_hold_timer()) instead of the key repeats.
+    bool hold_timer;
+    // Delay added to presses (us), and what the held back presses became.
+    Histogram press_delay;
+    uint64_t immediate_presses;
+    uint64_t delayed_presses;
+    uint64_t multi_taps;
+    uint64_t chords;
+} GestureRecognizer;
+
+// Set up the recognizer for B1 & B2 of `sm`. A window of 0 disables the gestures that need it.
+void gesture_init(GestureRecognizer* gestures, TvRemoteSm* sm, const unsigned int tap_window_ms, const unsigned int chord_window_ms);
+
+// Drive `machine` instead of the TvRemoteSm passed to gesture_init().
+void gesture_set_machine(GestureRecognizer* gestures, const GestureMachine* machine);
+
+// Call `on_dispatch` for every dispatched event (e.g. for latency measurements).
+void gesture_set_callback(GestureRecognizer* gestures, GestureDispatchCallback on_dispatch, void* ctx);
+
+// Dispatch a long-press LONG_PRESS_TIMEOUT after the press of a key that is still held, as part of
+// gesture_expire() & gesture_timeout_ms(), & ignore the key repeats. The deadline only exists while a
+// key is held, so the caller can sleep without a timeout otherwise.
+void gesture_set_hold_timer(GestureRecognizer* gestures, const bool enabled);
+
+// Feed a keyboard event. Returns the number of state machine events dispatched.
+int gesture_handle_input_event(GestureRecognizer* gestures, const struct input_event* event);
+
+// Feed a key event of `button`, whatever its key code. Returns the number of state machine events dispatched.
+int gesture_handle_button_event(GestureRecognizer* gestures, const GestureButton button, const struct input_event* event);
+
+// Dispatch the presses whose window ran out by `now_us` (on the clock of the input events), and the
+// long-presses that are due with the hold timer. Returns the number of state machine events dispatched.
+int gesture_expire(GestureRecognizer* gestures, const long long now_us);
+
+// Dispatch every pending press, e.g. at the end of the input.
+int gesture_flush(GestureRecognizer* gestures);
+
+// Milliseconds until the next pending press (or long-press with the hold timer) is due (rounded up), or -1 if none is.
+int gesture_timeout_ms(const GestureRecognizer* gestures, const long long now_us);
+
+#ifndef TVREMOTE_EMBEDDED
+// Print the added delay & the gesture counts to stderr.
+void gesture_report(const GestureRecognizer* gestures);
+#endif
@@ -0,0 +1,85 @@
+#include "input/key_input.h"
+
+#include <stddef.h> // for NULL
+#include <sys/time.h> // for gettimeofday
+
+const unsigned int LONG_PRESS_TIMEOUT = 800; // ms.
+
+void key_state_init(KeyState* key, const TvRemoteSm_EventId press_event, const TvRemoteSm_EventId long_press_event)
+{
+    key->pressed = false;
+    key->press_start_time = 0;
+    key->long_press = false;
+    key->press_event = press_event;
+    key->long_press_event = long_press_event;
+}
+
+// Function to get the time in ms.
+long long timeInMilliseconds(void) {
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (((long long)tv.tv_sec)*SECONDS_TO_MS)+(tv.tv_usec/MS_TO_MICROSEC);
+}
+
+// Function to get the time in us.
+long long timeInMicroseconds(void) {
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (((long long)tv.tv_sec)*SECONDS_TO_MS*MS_TO_MICROSEC)+tv.tv_usec;
+}
+
+// Function to get the kernel timestamp of an input event in ms.
+// The kernel stamps events with the same clock as gettimeofday by default.
+long long eventTimeInMilliseconds(const struct input_event* event) {
+    return (((long long)event->input_event_sec)*SECONDS_TO_MS)+(event->input_event_usec/MS_TO_MICROSEC);
+}
+
+// Track the state transitions between key press & long-press.
+int key_state_update(const int value, const long long now, KeyState* key)
+{
+    switch (value)
+    {
+        case RELEASED_EVENT:
+        {
+            // Clear the flags.
+            key->pressed = false;
+            key->long_press = false;
+            key->press_start_time = 0;
+            break;
+        }
+        case PRESSED_EVENT:
+        {
+            // Check if the key has already been pressed.
+            // If not, then register the press.
+            // This will be cleared on the key release event.
+            if (!key->pressed)
+            {
+                key->pressed = true;
+                key->press_start_time = now;
+                return key->press_event;
+            }
+            break;
+        }
+        case REPEATED_EVENT:
+        {
+            // Check if the key has already been pressed and a long-press event hasn't been recorded.
+            // If the long-press event hasn't been recorded, then register the long-press.
+            // This is necessary because this event will continue to be triggered while the key is depressed.
+            if (key->pressed && !key->long_press)
+            {
+                // Check if it has been long enough to be considered a "long-press";
+                if ((now - (long long)key->press_start_time) > LONG_PRESS_TIMEOUT)
+                {
+                    key->long_press = true;
+                    return key->long_press_event;
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return NO_EVENT;
+}
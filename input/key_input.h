@@ -0,0 +1,50 @@
+#pragma once
+
+#include <linux/input.h> // for input_event
+#include <stdbool.h> // for bool
+
+// The state machine for the TV remote.
+#include "state_machine/TvRemoteSm.h"
+
+// Key codes for B1 & B2.
+#define B1_CODE 17 // w
+#define B2_CODE 31 // s
+
+// Key event types.
+#define RELEASED_EVENT 0
+#define PRESSED_EVENT 1
+#define REPEATED_EVENT 2
+
+// Returned when an input event didn't dispatch a state machine event.
+#define NO_EVENT -1
+
+#define SECONDS_TO_MS 1000
+#define MS_TO_MICROSEC 1000
+#define SECONDS_TO_NANOSEC 1000000
+
+extern const unsigned int LONG_PRESS_TIMEOUT; // ms.
+
+typedef struct KeyState {
+    unsigned long long press_start_time;
+    bool pressed;
+    bool long_press;
+    int press_event;
+    int long_press_event;
+} KeyState;
+
+// Reset a key & set the events it dispatches.
+void key_state_init(KeyState* key, const TvRemoteSm_EventId press_event, const TvRemoteSm_EventId long_press_event);
+
+// Function to get the time in ms.
+long long timeInMilliseconds(void);
+
+// Function to get the time in us.
+long long timeInMicroseconds(void);
+
+// Function to get the kernel timestamp of an input event in ms.
+long long eventTimeInMilliseconds(const struct input_event* event);
+
+// Track the state transitions between key press & long-press without dispatching anything.
+// `now` is the time of the key event in ms.
+// Returns the event the key event amounts to or NO_EVENT.
+int key_state_update(const int value, const long long now, KeyState* key);
@@ -0,0 +1,377 @@
+#include "input/key_trace.h"
+
+#include <errno.h> // for errno
+#include <fcntl.h> // for open
+#include <stdlib.h> // for realloc
+#include <string.h> // for memcmp
+#include <sys/mman.h> // for mmap
+#include <sys/stat.h> // for fstat
+#include <unistd.h> // for close
+
+#include "state_machine/TvRemoteSm.h"
+
+_Static_assert(sizeof(KeyTraceHeader) == 64, "KeyTraceHeader is part of the file format");
+_Static_assert(sizeof(KeyTraceBlock) == 32, "KeyTraceBlock is part of the file format");
+
+static uint64_t align8(const uint64_t size)
+{
+    return (size + 7) & ~(uint64_t)7;
+}
+
+// Bytes of the codes, values & states of `count` events.
+static uint64_t columns_size(const uint32_t count)
+{
+    return (uint64_t)count * (sizeof(uint16_t) + 2 * sizeof(uint8_t));
+}
+
+static uint64_t names_size(const uint16_t state_count)
+{
+    return align8((uint64_t)state_count * KEY_TRACE_NAME_SIZE);
+}
+
+static const uint8_t* block_data(const KeyTrace* trace, const uint32_t block)
+{
+    return (const uint8_t*)trace->map + trace->blocks[block].offset;
+}
+
+static bool check(const KeyTrace* trace)
+{
+    const KeyTraceHeader* header = trace->header;
+    if (trace->map_size < sizeof(KeyTraceHeader) || memcmp(header->magic, KEY_TRACE_MAGIC, sizeof(header->magic)) != 0
+        || header->block_events != KEY_TRACE_BLOCK_EVENTS || header->name_size != KEY_TRACE_NAME_SIZE
+        || header->state_count == 0 || header->state_count > KEY_TRACE_MAX_STATES)
+    {
+        return false;
+    }
+    const uint64_t blocks_start = sizeof(KeyTraceHeader) + names_size(header->state_count);
+    if (header->index_offset < blocks_start || header->index_offset % 8 != 0 || header->index_offset > trace->map_size
+        || (trace->map_size - header->index_offset) / sizeof(KeyTraceBlock) != header->block_count
+        || (trace->map_size - header->index_offset) % sizeof(KeyTraceBlock) != 0)
+    {
+        return false;
+    }
+    uint64_t events = 0;
+    uint64_t next_offset = blocks_start;
+    for (uint32_t i = 0; i < header->block_count; i++)
+    {
+        const KeyTraceBlock* block = &trace->blocks[i];
+        if (block->count == 0 || block->count > KEY_TRACE_BLOCK_EVENTS || block->offset != next_offset
+            || block->time_size > block->count * 10u)
+        {
+            return false;
+        }
+        next_offset = align8(block->offset + columns_size(block->count) + block->time_size);
+        events += block->count;
+    }
+    return next_offset == header->index_offset && events == header->event_count;
+}
+
+bool key_trace_open(KeyTrace* trace, const char* path)
+{
+    memset(trace, 0, sizeof(*trace));
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == -1)
+    {
+        close(fd);
+        return false;
+    }
+    if ((size_t)info.st_size < sizeof(KeyTraceHeader))
+    {
+        close(fd);
+        errno = EINVAL;
+        return false;
+    }
+    void* map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return false;
+    }
+    // Queries read the columns front to back.
+    madvise(map, (size_t)info.st_size, MADV_SEQUENTIAL);
+
+    trace->map = map;
+    trace->map_size = (size_t)info.st_size;
+    trace->header = map;
+    trace->state_names = (const char (*)[KEY_TRACE_NAME_SIZE])((const uint8_t*)map + sizeof(KeyTraceHeader));
+    trace->blocks = (const KeyTraceBlock*)((const uint8_t*)map
+        + (trace->header->index_offset <= trace->map_size ? trace->header->index_offset : 0));
+    if (!check(trace))
+    {
+        munmap(map, trace->map_size);
+        memset(trace, 0, sizeof(*trace));
+        errno = EINVAL;
+        return false;
+    }
+    return true;
+}
+
+void key_trace_close(KeyTrace* trace)
+{
+    if (trace->map != NULL)
+    {
+        munmap(trace->map, trace->map_size);
+    }
+    memset(trace, 0, sizeof(*trace));
+}
+
+const uint16_t* key_trace_codes(const KeyTrace* trace, const uint32_t block)
+{
+    return (const uint16_t*)block_data(trace, block);
+}
+
+const uint8_t* key_trace_values(const KeyTrace* trace, const uint32_t block)
+{
+    return block_data(trace, block) + (size_t)trace->blocks[block].count * sizeof(uint16_t);
+}
+
+const uint8_t* key_trace_states(const KeyTrace* trace, const uint32_t block)
+{
+    return block_data(trace, block) + (size_t)trace->blocks[block].count * (sizeof(uint16_t) + sizeof(uint8_t));
+}
+
+// Decode one zigzag LEB128 varint of at most 10 bytes from [*p, end). Returns false if it runs past `end`.
+static inline bool read_varint(const uint8_t** p, const uint8_t* end, int64_t* value)
+{
+    uint64_t bits = 0;
+    for (int shift = 0; shift < 70 && *p < end; shift += 7)
+    {
+        const uint8_t byte = *(*p)++;
+        bits |= (uint64_t)(byte & 0x7f) << shift;
+        if (byte < 0x80)
+        {
+            *value = (int64_t)(bits >> 1) ^ -(int64_t)(bits & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool key_trace_times(const KeyTrace* trace, const uint32_t block, int64_t* times_us)
+{
+    const KeyTraceBlock* b = &trace->blocks[block];
+    const uint8_t* p = block_data(trace, block) + columns_size(b->count);
+    const uint8_t* end = p + b->time_size;
+    int64_t at_us = b->first_us;
+    for (uint32_t i = 0; i < b->count; i++)
+    {
+        int64_t delta;
+        if (!read_varint(&p, end, &delta))
+        {
+            return false;
+        }
+        at_us += delta;
+        times_us[i] = at_us;
+    }
+    return true;
+}
+
+uint32_t key_trace_find_block(const KeyTrace* trace, const int64_t at_us)
+{
+    uint32_t low = 0;
+    uint32_t high = trace->header->block_count;
+    while (low < high)
+    {
+        const uint32_t middle = low + (high - low) / 2;
+        if (trace->blocks[middle].last_us < at_us)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+int key_trace_state_id(const KeyTrace* trace, const char* name)
+{
+    for (int id = 0; id < trace->header->state_count; id++)
+    {
+        if (strncmp(trace->state_names[id], name, KEY_TRACE_NAME_SIZE) == 0)
+        {
+            return id;
+        }
+    }
+    return -1;
+}
+
+bool key_trace_time_in_states(const KeyTrace* trace, uint64_t* state_us)
+{
+    // Every u8 state indexes this, whatever the file says.
+    uint64_t totals[KEY_TRACE_MAX_STATES] = { 0 };
+    int previous_state = -1;
+    int64_t previous_us = 0;
+    for (uint32_t block = 0; block < trace->header->block_count; block++)
+    {
+        const KeyTraceBlock* b = &trace->blocks[block];
+        const uint8_t* states = key_trace_states(trace, block);
+        const uint8_t* p = states + b->count;
+        const uint8_t* end = p + b->time_size;
+        int64_t delta;
+        if (!read_varint(&p, end, &delta))
+        {
+            return false;
+        }
+        if (previous_state >= 0)
+        {
+            totals[previous_state] += (uint64_t)(b->first_us + delta - previous_us);
+        }
+        int64_t at_us = b->first_us + delta;
+        for (uint32_t i = 1; i < b->count; i++)
+        {
+            if (!read_varint(&p, end, &delta))
+            {
+                return false;
+            }
+            totals[states[i - 1]] += (uint64_t)delta;
+            at_us += delta;
+        }
+        previous_state = states[b->count - 1];
+        previous_us = at_us;
+    }
+    for (int id = 0; id < trace->header->state_count; id++)
+    {
+        state_us[id] += totals[id];
+    }
+    return true;
+}
+
+static bool write_at(KeyTraceWriter* writer, const void* data, const size_t size)
+{
+    static const uint8_t zeros[8] = { 0 };
+    const size_t padding = (size_t)(align8(writer->offset + size) - (writer->offset + size));
+    if (fwrite(data, 1, size, writer->file) != size || fwrite(zeros, 1, padding, writer->file) != padding)
+    {
+        return false;
+    }
+    writer->offset += size + padding;
+    return true;
+}
+
+static bool flush_block(KeyTraceWriter* writer)
+{
+    if (writer->count == 0)
+    {
+        return true;
+    }
+    if (writer->header.block_count == writer->block_capacity)
+    {
+        const uint32_t capacity = writer->block_capacity ? writer->block_capacity * 2 : 64;
+        KeyTraceBlock* blocks = realloc(writer->blocks, capacity * sizeof(KeyTraceBlock));
+        if (blocks == NULL)
+        {
+            return false;
+        }
+        writer->blocks = blocks;
+        writer->block_capacity = capacity;
+    }
+    KeyTraceBlock* block = &writer->blocks[writer->header.block_count];
+    block->first_us = writer->block_first_us;
+    block->last_us = writer->previous_us;
+    block->offset = writer->offset;
+    block->count = writer->count;
+    block->time_size = writer->time_size;
+    // One write per column, then the padding after the times.
+    if (fwrite(writer->codes, sizeof(uint16_t), writer->count, writer->file) != writer->count
+        || fwrite(writer->values, 1, writer->count, writer->file) != writer->count
+        || fwrite(writer->states, 1, writer->count, writer->file) != writer->count)
+    {
+        return false;
+    }
+    writer->offset += columns_size(writer->count);
+    if (!write_at(writer, writer->times, writer->time_size))
+    {
+        return false;
+    }
+    writer->header.block_count++;
+    writer->count = 0;
+    writer->time_size = 0;
+    return true;
+}
+
+bool key_trace_writer_open(KeyTraceWriter* writer, const char* path)
+{
+    memset(writer, 0, sizeof(*writer));
+    writer->file = fopen(path, "wb");
+    if (writer->file == NULL)
+    {
+        return false;
+    }
+    memcpy(writer->header.magic, KEY_TRACE_MAGIC, sizeof(writer->header.magic));
+    writer->header.block_events = KEY_TRACE_BLOCK_EVENTS;
+    writer->header.state_count = TvRemoteSm_StateIdCount;
+    writer->header.name_size = KEY_TRACE_NAME_SIZE;
+
+    // The header is written again with the totals on close.
+    bool ok = write_at(writer, &writer->header, sizeof(writer->header));
+    char names[TvRemoteSm_StateIdCount][KEY_TRACE_NAME_SIZE] = { { 0 } };
+    for (int id = 0; id < TvRemoteSm_StateIdCount; id++)
+    {
+        strncpy(names[id], TvRemoteSm_state_id_to_string((TvRemoteSm_StateId)id), KEY_TRACE_NAME_SIZE - 1);
+    }
+    ok = ok && write_at(writer, names, sizeof(names));
+    if (!ok)
+    {
+        const int error = errno;
+        fclose(writer->file);
+        writer->file = NULL;
+        errno = error;
+    }
+    return ok;
+}
+
+bool key_trace_writer_add(KeyTraceWriter* writer, const int64_t at_us, const uint16_t code, const uint8_t value,
+    const uint8_t state_id)
+{
+    if (writer->count == KEY_TRACE_BLOCK_EVENTS && !flush_block(writer))
+    {
+        return false;
+    }
+    if (writer->header.event_count == 0)
+    {
+        writer->header.first_us = at_us;
+    }
+    if (writer->count == 0)
+    {
+        writer->block_first_us = at_us;
+        writer->previous_us = at_us;
+    }
+    // Zigzag, then 7 bits per byte.
+    const int64_t delta = at_us - writer->previous_us;
+    uint64_t bits = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+    while (bits >= 0x80)
+    {
+        writer->times[writer->time_size++] = (uint8_t)(bits | 0x80);
+        bits >>= 7;
+    }
+    writer->times[writer->time_size++] = (uint8_t)bits;
+    writer->codes[writer->count] = code;
+    writer->values[writer->count] = value;
+    writer->states[writer->count] = state_id;
+    writer->count++;
+    writer->previous_us = at_us;
+    writer->header.event_count++;
+    writer->header.last_us = at_us;
+    return true;
+}
+
+bool key_trace_writer_close(KeyTraceWriter* writer)
+{
+    bool ok = flush_block(writer);
+    writer->header.index_offset = writer->offset;
+    ok = ok && write_at(writer, writer->blocks, (size_t)writer->header.block_count * sizeof(KeyTraceBlock));
+    ok = ok && fseek(writer->file, 0, SEEK_SET) == 0
+        && fwrite(&writer->header, sizeof(writer->header), 1, writer->file) == 1;
+    ok = (fclose(writer->file) == 0) && ok;
+    free(writer->blocks);
+    writer->file = NULL;
+    writer->blocks = NULL;
+    return ok;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <stdbool.h> // for bool
+#include <stddef.h> // for size_t
+#include <stdint.h> // for uint16_t
+#include <stdio.h> // for FILE
+
+// Recorded key sessions in a compact columnar file that is memory-mapped as is.
+//
+// Only the key events are kept (no EV_SYN/EV_MSC), each with the state the machine was in once it
+// had handled it. The events are stored in blocks of up to KEY_TRACE_BLOCK_EVENTS, one column after
+// the other, so a query only touches the columns it needs:
+//   - codes: u16 key code per event,
+//   - values: u8 (0 release, 1 press, 2 auto-repeat),
+//   - states: u8 TvRemoteSm_StateId after the event, as numbered in the state name table,
+//   - times: microseconds since the previous event of the block (the first one since the block's
+//     first_us), zigzag encoded as LEB128 varints.
+// The codes, values & states are used in place; only the times have to be decoded. An index of
+// the blocks, with their first & last times, follows them.
+//
+// The state names are those of the machine that recorded the file, so queries by name still hold
+// after the diagram has added or renumbered states.
+//
+// File format (little endian, every section 8 byte aligned):
+//   header:      KeyTraceHeader
+//   state names: state_count names of KEY_TRACE_NAME_SIZE bytes, NUL terminated
+//   blocks:      codes, values, states & times of each block, padded to 8 bytes
+//   index:       block_count KeyTraceBlock
+
+#define KEY_TRACE_MAGIC "TVKTRC01"
+#define KEY_TRACE_BLOCK_EVENTS 4096
+#define KEY_TRACE_NAME_SIZE 32
+#define KEY_TRACE_MAX_STATES 256
+
+typedef struct KeyTraceHeader {
+    char magic[8];
+    uint32_t block_events;
+    uint32_t block_count;
+    uint64_t event_count;
+    uint64_t index_offset;
+    int64_t first_us;
+    int64_t last_us;
+    uint16_t state_count;
+    uint16_t name_size;
+    uint32_t reserved[3];
+} KeyTraceHeader;
+
+typedef struct KeyTraceBlock {
+    int64_t first_us;
+    int64_t last_us;
+    // From the start of the file.
+    uint64_t offset;
+    uint32_t count;
+    // Bytes of varints.
+    uint32_t time_size;
+} KeyTraceBlock;
+
+typedef struct KeyTrace {
+    const KeyTraceHeader* header;
+    const char (*state_names)[KEY_TRACE_NAME_SIZE];
+    const KeyTraceBlock* blocks;
+    // The mapping.
+    void* map;
+    size_t map_size;
+} KeyTrace;
+
+// About 64 KB: allocate it statically or on the heap.
+typedef struct KeyTraceWriter {
+    FILE* file;
+    KeyTraceHeader header;
+    uint64_t offset;
+    // The block being filled.
+    uint32_t count;
+    int64_t block_first_us;
+    int64_t previous_us;
+    uint16_t codes[KEY_TRACE_BLOCK_EVENTS];
+    uint8_t values[KEY_TRACE_BLOCK_EVENTS];
+    uint8_t states[KEY_TRACE_BLOCK_EVENTS];
+    // At most 10 bytes per varint.
+    uint8_t times[KEY_TRACE_BLOCK_EVENTS * 10];
+    uint32_t time_size;
+    // The blocks written so far.
+    KeyTraceBlock* blocks;
+    uint32_t block_capacity;
+} KeyTraceWriter;
+
+// Map the trace file at `path` & check its header & index. Returns false (errno is set, EINVAL for a
+// malformed file).
+bool key_trace_open(KeyTrace* trace, const char* path);
+
+// Unmap the trace.
+void key_trace_close(KeyTrace* trace);
+
+// The columns of block `block`, in place.
+const uint16_t* key_trace_codes(const KeyTrace* trace, const uint32_t block);
+const uint8_t* key_trace_values(const KeyTrace* trace, const uint32_t block);
+const uint8_t* key_trace_states(const KeyTrace* trace, const uint32_t block);
+
+// Decode the times of block `block` into `times_us` (room for KEY_TRACE_BLOCK_EVENTS). Returns false
+// if the varints are malformed.
+bool key_trace_times(const KeyTrace* trace, const uint32_t block, int64_t* times_us);
+
+// The first block that may hold events at or after `at_us` (block_count if none), for traces whose
+// times don't go back.
+uint32_t key_trace_find_block(const KeyTrace* trace, const int64_t at_us);
+
+// The id of state `name` in this file, -1 if it has none.
+int key_trace_state_id(const KeyTrace* trace, const char* name);
+
+// Add the microseconds spent in each state (by the ids of the file), from every event to the next,
+// to `state_us` (room for header->state_count). Returns false if the times are malformed.
+bool key_trace_time_in_states(const KeyTrace* trace, uint64_t* state_us);
+
+// Start writing a trace to `path`, with the state names of this build. Returns false (errno is set).
+bool key_trace_writer_open(KeyTraceWriter* writer, const char* path);
+
+// Append one key event. Returns false on a write error.
+bool key_trace_writer_add(KeyTraceWriter* writer, const int64_t at_us, const uint16_t code, const uint8_t value,
+    const uint8_t state_id);
+
+// Write the last block, the index & the header and close the file. Returns false on a write error.
+bool key_trace_writer_close(KeyTraceWriter* writer);
@@ -0,0 +1,100 @@
+#include "input/latency.h"
+
+#include <stdio.h> // for fprintf
+#include <string.h> // for memset
+#include <sys/ioctl.h> // for ioctl
+#include <time.h> // for clock_gettime
+
+#define SECONDS_TO_MICROSEC 1000000ULL
+
+void latency_init(LatencyStats* stats, const int fd)
+{
+    memset(stats, 0, sizeof(*stats));
+    int clock = CLOCK_MONOTONIC;
+    if (ioctl(fd, EVIOCSCLOCKID, &clock) == 0)
+    {
+        stats->clock = CLOCK_MONOTONIC;
+    }
+    else
+    {
+        // Older kernels or not an evdev device: the events use the wall clock.
+        stats->clock = CLOCK_REALTIME;
+    }
+}
+
+uint64_t latency_now_us(const LatencyStats* stats)
+{
+    struct timespec ts;
+    clock_gettime(stats->clock, &ts);
+    return (uint64_t)ts.tv_sec * SECONDS_TO_MICROSEC + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static uint64_t event_time_us(const struct input_event* event)
+{
+    return (uint64_t)event->input_event_sec * SECONDS_TO_MICROSEC + (uint64_t)event->input_event_usec;
+}
+
+static uint64_t elapsed_us(const uint64_t from, const uint64_t to)
+{
+    return to > from ? to - from : 0;
+}
+
+void latency_dispatched(LatencyStats* stats, const struct input_event* event, const int event_id)
+{
+    if (event_id < 0 || event_id >= TvRemoteSm_EventIdCount)
+    {
+        return;
+    }
+    const uint64_t event_time = event_time_us(event);
+    histogram_record(&stats->dispatch[event_id], elapsed_us(event_time, latency_now_us(stats)));
+
+    if (stats->pending_count == LATENCY_MAX_PENDING)
+    {
+        stats->unmeasured++;
+        return;
+    }
+    stats->pending_events[stats->pending_count] = event_id;
+    stats->pending_times[stats->pending_count] = event_time;
+    stats->pending_count++;
+}
+
+void latency_output_flushed(LatencyStats* stats)
+{
+    const uint64_t now = latency_now_us(stats);
+    for (int i = 0; i < stats->pending_count; i++)
+    {
+        histogram_record(&stats->output[stats->pending_events[i]], elapsed_us(stats->pending_times[i], now));
+    }
+    stats->pending_count = 0;
+}
+
+static void print_row(const char* name, const char* stage, const Histogram* histogram)
+{
+    if (histogram->total == 0)
+    {
+        return;
+    }
+    fprintf(stderr, "%-14s %-9s %8llu %9llu %9llu %9llu %9llu %9llu\n", name, stage,
+        (unsigned long long)histogram->total,
+        (unsigned long long)histogram_percentile(histogram, 50),
+        (unsigned long long)histogram_percentile(histogram, 90),
+        (unsigned long long)histogram_percentile(histogram, 99),
+        (unsigned long long)histogram_percentile(histogram, 99.9),
+        (unsigned long long)histogram->max);
+}
+
+void latency_report(const LatencyStats* stats)
+{
+    fprintf(stderr, "Input latency (us, %s clock):\n", stats->clock == CLOCK_MONOTONIC ? "monotonic" : "realtime");
+    fprintf(stderr, "%-14s %-9s %8s %9s %9s %9s %9s %9s\n", "event", "stage", "count", "p50", "p90", "p99", "p99.9", "max");
+    for (int event = 0; event < TvRemoteSm_EventIdCount; event++)
+    {
+        const char* name = TvRemoteSm_event_id_to_string((TvRemoteSm_EventId)event);
+        print_row(name, "dispatch", &stats->dispatch[event]);
+        print_row(name, "output", &stats->output[event]);
+    }
+    if (stats->unmeasured > 0)
+    {
+        fprintf(stderr, "%llu events had no output measurement (too many pending).\n", (unsigned long long)stats->unmeasured);
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <linux/input.h> // for input_event
+#include <stdint.h> // for uint64_t
+
+#include "metrics/histogram.h"
+#include "state_machine/TvRemoteSm.h"
+
+// Input-to-action latency measurement.
+//
+// Measured from the kernel timestamp of the key event to
+//   - dispatch: `TvRemoteSm_dispatch_event()` returning, and
+//   - output: the output of that event being flushed (stdout flushed or the display frame drawn).
+// The device clock is switched to CLOCK_MONOTONIC so the timestamps can be compared with
+// `clock_gettime()`.
+
+// Events whose output is waiting for a coalesced display frame.
+#define LATENCY_MAX_PENDING 64
+
+typedef struct LatencyStats {
+    clockid_t clock;
+    Histogram dispatch[TvRemoteSm_EventIdCount];
+    Histogram output[TvRemoteSm_EventIdCount];
+    // Events dispatched but whose output isn't visible yet.
+    int pending_count;
+    int pending_events[LATENCY_MAX_PENDING];
+    uint64_t pending_times[LATENCY_MAX_PENDING];
+    uint64_t unmeasured;
+} LatencyStats;
+
+// Switch the input device `fd` to the monotonic clock & reset the statistics.
+void latency_init(LatencyStats* stats, const int fd);
+
+// The current time in microseconds, on the same clock as the input events.
+uint64_t latency_now_us(const LatencyStats* stats);
+
+// Record that `event` read from the device dispatched `event_id`, just now.
+void latency_dispatched(LatencyStats* stats, const struct input_event* event, const int event_id);
+
+// Record that the output of every pending event is now visible.
+void latency_output_flushed(LatencyStats* stats);
+
+// Print the percentiles per event type to stderr.
+void latency_report(const LatencyStats* stats);
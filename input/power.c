@@ -0,0 +1,74 @@
+#include "input/power.h"
+
+#include <stdint.h> // for uintptr_t
+#include <string.h> // for memset
+#include <sys/ioctl.h> // for ioctl
+
+#define KEY_B1 1u
+#define KEY_B2 2u
+
+// Event types whose codes are filtered. EV_SYN is left alone: it's what wakes the process up, and the
+// kernel drops a SYN_REPORT that has nothing left before it.
+static const unsigned int MASKED_TYPES[] = { EV_KEY, EV_MSC, EV_LED, EV_REL, EV_ABS, EV_SW };
+
+// Bytes of the largest code bitmap (EV_KEY).
+#define MASK_SIZE ((KEY_MAX + 8) / 8)
+
+static bool set_mask(const int fd, const unsigned int type, const unsigned char* codes)
+{
+    struct input_mask mask = {
+        .type = type,
+        .codes_size = MASK_SIZE,
+        .codes_ptr = (uintptr_t)codes,
+    };
+    return ioctl(fd, EVIOCSMASK, &mask) == 0;
+}
+
+void power_policy_init(PowerPolicy* policy, const int fd, GestureRecognizer* gestures)
+{
+    memset(policy, 0, sizeof(*policy));
+    policy->fd = fd;
+    gesture_set_hold_timer(gestures, true);
+}
+
+bool power_policy_update(PowerPolicy* policy, const GestureRecognizer* gestures)
+{
+    if (policy->unsupported)
+    {
+        return true;
+    }
+    const bool tv_off = gestures->sm->state_id == TvRemoteSm_StateId_TV_OFF;
+    const unsigned int keys = (tv_off && !gestures->b2.state.pressed) ? KEY_B1 : (KEY_B1 | KEY_B2);
+    if (keys == policy->keys)
+    {
+        return true;
+    }
+
+    unsigned char codes[MASK_SIZE];
+    memset(codes, 0, sizeof(codes));
+    bool ok = true;
+    if (policy->keys == 0)
+    {
+        // First update: nothing but the keys.
+        for (unsigned int i = 0; i < sizeof(MASKED_TYPES) / sizeof(MASKED_TYPES[0]) && ok; i++)
+        {
+            ok = MASKED_TYPES[i] == EV_KEY || set_mask(policy->fd, MASKED_TYPES[i], codes);
+        }
+    }
+    if (keys & KEY_B1)
+    {
+        codes[B1_CODE / 8] |= (unsigned char)(1u << (B1_CODE % 8));
+    }
+    if (keys & KEY_B2)
+    {
+        codes[B2_CODE / 8] |= (unsigned char)(1u << (B2_CODE % 8));
+    }
+    ok = ok && set_mask(policy->fd, EV_KEY, codes);
+    if (!ok)
+    {
+        policy->unsupported = true;
+        return false;
+    }
+    policy->keys = keys;
+    return true;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdbool.h> // for bool
+
+#include "input/gesture.h"
+#include "state_machine/TvRemoteSm.h"
+
+// Power-aware input: the process only wakes up for the key edges the active state can use.
+//
+// The kernel drops the other events before they reach the process (EVIOCSMASK, Linux 4.4+): every key
+// but B1 & B2, the scan codes (EV_MSC), LEDs and axes. In TV_OFF only B1 gets through, since its
+// long-press is the only event TV_OFF handles. B2 stays let through until it's released so its key
+// state never misses the release. The long-presses come from the gesture hold timer, which only
+// exists while a key is held (see gesture_set_hold_timer()), so the key repeats can be ignored and
+// the process sleeps without a timeout when no key is held & no press is held back.
+//
+// Key repeats can't be masked by value: B1's repeats still arrive while it is held.
+
+typedef struct PowerPolicy {
+    int fd;
+    // EVIOCSMASK failed (not an evdev device or an older kernel): every event gets through.
+    bool unsupported;
+    // The keys let through: 0 before the first update, else bit 0 for B1 & bit 1 for B2.
+    unsigned int keys;
+} PowerPolicy;
+
+// Use the policy for the device `fd` & turn on the hold timer of `gestures`.
+void power_policy_init(PowerPolicy* policy, const int fd, GestureRecognizer* gestures);
+
+// Let through the keys that the active state of `gestures->sm` can use. Cheap when nothing changes,
+// so it can be called after every event. Returns false (once) if the device has no event mask.
+bool power_policy_update(PowerPolicy* policy, const GestureRecognizer* gestures);
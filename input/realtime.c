@@ -0,0 +1,159 @@
+// for CPU_SET & pthread_attr_setaffinity_np
+#define _GNU_SOURCE
+
+#include "input/realtime.h"
+
+#include <errno.h> // for errno
+#include <pthread.h> // for pthread_create
+#include <sched.h> // for sched_param
+#include <signal.h> // for pthread_sigmask
+#include <stdint.h> // for uint8_t
+#include <stdio.h> // for fprintf
+#include <string.h> // for strerror
+#include <sys/mman.h> // for mlockall
+#include <unistd.h> // for sysconf
+
+_Static_assert(REALTIME_MAX_CPUS == CPU_SETSIZE, "REALTIME_MAX_CPUS must be the size of a cpu_set_t");
+
+typedef struct RealtimeThread {
+    void* (*loop)(void*);
+    void* arg;
+    // The signal mask of the caller, which the thread runs with.
+    sigset_t signals;
+} RealtimeThread;
+
+void realtime_prefault(void* data, const size_t size)
+{
+    const long page_size = sysconf(_SC_PAGESIZE);
+    volatile uint8_t* bytes = data;
+    for (size_t i = 0; i < size; i += (size_t)page_size)
+    {
+        bytes[i] = bytes[i];
+    }
+    if (size > 0)
+    {
+        bytes[size - 1] = bytes[size - 1];
+    }
+}
+
+// Touch the stack the loop will grow into, from a frame of its own.
+static __attribute__((noinline)) void prefault_stack(void)
+{
+    volatile uint8_t stack[REALTIME_STACK_PREFAULT];
+    for (size_t i = 0; i < sizeof(stack); i += 256)
+    {
+        stack[i] = 0;
+    }
+}
+
+static void* start_thread(void* arg)
+{
+    RealtimeThread* thread = arg;
+    prefault_stack();
+    pthread_sigmask(SIG_SETMASK, &thread->signals, NULL);
+    return thread->loop(thread->arg);
+}
+
+// Start the thread with SCHED_FIFO & on the CPU of `options` if asked. Returns 0 or the error.
+static int create_thread(pthread_t* id, const RealtimeOptions* options, const bool fifo, const bool pinned, RealtimeThread* thread)
+{
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, REALTIME_STACK_SIZE);
+    if (pinned)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(options->cpu, &cpus);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+    }
+    if (fifo)
+    {
+        const struct sched_param param = { .sched_priority = options->priority };
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &param);
+    }
+    const int error = pthread_create(id, &attr, start_thread, thread);
+    pthread_attr_destroy(&attr);
+    return error;
+}
+
+bool realtime_run(const RealtimeOptions* options, void* (*loop)(void*), void* arg, RealtimeStatus* status)
+{
+    *status = (RealtimeStatus){ 0 };
+    if (options->lock_memory)
+    {
+        status->locked = mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+        if (!status->locked)
+        {
+            fprintf(stderr, "Cannot lock the memory: %s. Pages may be faulted in while running.\n", strerror(errno));
+        }
+    }
+
+    // Only the thread takes the stop signals while the caller waits for it.
+    RealtimeThread thread = { .loop = loop, .arg = arg };
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, &thread.signals);
+
+    // Leave out what isn't permitted (EPERM) or doesn't exist (EINVAL): the CPU pin & SCHED_FIFO each on its
+    // own, then both, then the stack size with the default attributes.
+    const bool fifo = options->priority > 0;
+    const bool pinned = options->cpu >= 0;
+    status->fifo = fifo;
+    status->pinned = pinned;
+    pthread_t id;
+    int error = create_thread(&id, options, fifo, pinned, &thread);
+    int fifo_error = error;
+    int pin_error = error;
+    if (error != 0 && fifo && pinned)
+    {
+        fifo_error = create_thread(&id, options, true, false, &thread);
+        if (fifo_error == 0)
+        {
+            status->pinned = false;
+            error = 0;
+        }
+        else
+        {
+            pin_error = create_thread(&id, options, false, true, &thread);
+            if (pin_error == 0)
+            {
+                status->fifo = false;
+                error = 0;
+            }
+        }
+    }
+    if (error != 0 && (fifo || pinned))
+    {
+        status->fifo = false;
+        status->pinned = false;
+        error = create_thread(&id, options, false, false, &thread);
+    }
+    if (error != 0)
+    {
+        error = pthread_create(&id, NULL, start_thread, &thread);
+    }
+    if (fifo && !status->fifo)
+    {
+        fprintf(stderr, "Cannot use SCHED_FIFO priority %d: %s. The input thread runs at normal priority.\n",
+            options->priority, strerror(fifo_error));
+    }
+    if (pinned && !status->pinned)
+    {
+        fprintf(stderr, "Cannot pin the input thread to CPU %d: %s. It runs on any CPU.\n", options->cpu, strerror(pin_error));
+    }
+    if (error != 0)
+    {
+        pthread_sigmask(SIG_SETMASK, &thread.signals, NULL);
+        fprintf(stderr, "Cannot start the input thread: %s.\n", strerror(error));
+        errno = error;
+        return false;
+    }
+    pthread_join(id, NULL);
+    pthread_sigmask(SIG_SETMASK, &thread.signals, NULL);
+    return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdbool.h> // for bool
+#include <stddef.h> // for size_t
+
+// A dedicated thread for the input & dispatch loop, so long-press timing holds on a loaded host.
+//
+// The thread runs:
+//   - under SCHED_FIFO at `priority` when that is permitted (CAP_SYS_NICE or RLIMIT_RTPRIO), at
+//     normal priority otherwise,
+//   - on `cpu` only, if it isn't -1,
+//   - with every page of the process locked in memory (mlockall, current & future) if `lock_memory`,
+//   - with REALTIME_STACK_PREFAULT bytes of its stack touched before the loop starts.
+// What the loop uses beyond its stack (the TvRemoteSm, the recognizer) is touched by the caller with
+// realtime_prefault(), so the loop doesn't take page faults on its first events.
+//
+// The thread has the signal mask of the caller: if SIGINT & SIGTERM aren't blocked, they go to the thread,
+// so a read or poll it is blocked in returns EINTR.
+
+#define REALTIME_DEFAULT_PRIORITY 50
+#define REALTIME_STACK_SIZE (1024 * 1024)
+#define REALTIME_STACK_PREFAULT (256 * 1024)
+// The CPUs a thread can be pinned to: [0, REALTIME_MAX_CPUS), the CPU_SETSIZE of a cpu_set_t.
+#define REALTIME_MAX_CPUS 1024
+
+typedef struct RealtimeOptions {
+    // SCHED_FIFO priority (1-99), 0 for the normal policy.
+    int priority;
+    // -1 for any.
+    int cpu;
+    bool lock_memory;
+} RealtimeOptions;
+
+// What could be applied.
+typedef struct RealtimeStatus {
+    bool fifo;
+    bool pinned;
+    bool locked;
+} RealtimeStatus;
+
+// Write every page of [data, data + size) without changing it, so it is mapped before it's needed.
+void realtime_prefault(void* data, const size_t size);
+
+// Run `loop(arg)` on a thread set up as `options` asks & wait for it to return. What can't be applied
+// is reported on stderr & left out of `status`. Returns false (errno is set) if no thread can be started,
+// not even with the default attributes.
+bool realtime_run(const RealtimeOptions* options, void* (*loop)(void*), void* arg, RealtimeStatus* status);
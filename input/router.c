@@ -0,0 +1,412 @@
+#include "input/router.h"
+
+#include <errno.h> // for errno
+#include <fcntl.h> // for open
+#include <stdio.h> // for fprintf
+#include <stdlib.h> // for calloc
+#include <string.h> // for strcmp
+#include <sys/epoll.h> // for epoll_wait
+#include <unistd.h> // for read
+
+// Events read per epoll wakeup & per read().
+#define MAX_READY 64
+#define READ_EVENTS 64
+
+#define LINE_SIZE 512
+
+static void remote_show(void* ctx, const char* message)
+{
+    const RouterRemote* remote = ctx;
+    printf("%s: %s\n", remote->name, message);
+}
+
+static void remote_value(void* ctx, TvOutputField field, unsigned short value)
+{
+    const RouterRemote* remote = ctx;
+    (void)field;
+    printf("%s: %d\n", remote->name, value);
+}
+
+static int find_remote(Router* router, const char* name)
+{
+    for (int i = 0; i < router->remote_count; i++)
+    {
+        if (strcmp(router->remotes[i].name, name) == 0)
+        {
+            return i;
+        }
+    }
+    if (router->remote_count == ROUTER_MAX_REMOTES)
+    {
+        return -1;
+    }
+    RouterRemote* remote = &router->remotes[router->remote_count];
+    snprintf(remote->name, sizeof(remote->name), "%s", name);
+    TvRemoteSm_ctor(&remote->sm);
+    remote->sink.show = remote_show;
+    remote->sink.value = remote_value;
+    remote->sink.ctx = remote;
+    remote->sm.vars.output = &remote->sink;
+    remote->sm.vars.channels = router->channels;
+    return router->remote_count++;
+}
+
+static int find_device(Router* router, const char* path)
+{
+    for (int i = 0; i < router->device_count; i++)
+    {
+        if (strcmp(router->devices[i].path, path) == 0)
+        {
+            return i;
+        }
+    }
+    if (router->device_count == router->device_capacity)
+    {
+        const int capacity = router->device_capacity ? router->device_capacity * 2 : 16;
+        RouterDevice* devices = realloc(router->devices, (size_t)capacity * sizeof(devices[0]));
+        if (devices == NULL)
+        {
+            return -1;
+        }
+        router->devices = devices;
+        router->device_capacity = capacity;
+    }
+    RouterDevice* device = &router->devices[router->device_count];
+    memset(device, 0, sizeof(*device));
+    snprintf(device->path, sizeof(device->path), "%s", path);
+    device->fd = -1;
+    return router->device_count++;
+}
+
+// The recognizer for the keys of `device` that go to `remote`, created on first use.
+static int find_binding(Router* router, const RouterDevice* device, const int remote)
+{
+    for (int i = 0; i < device->key_count; i++)
+    {
+        if (router->bindings[device->keys[i].binding].remote == remote)
+        {
+            return device->keys[i].binding;
+        }
+    }
+    if (router->binding_count == router->binding_capacity)
+    {
+        const int capacity = router->binding_capacity ? router->binding_capacity * 2 : 16;
+        RouterBinding* bindings = realloc(router->bindings, (size_t)capacity * sizeof(bindings[0]));
+        if (bindings == NULL)
+        {
+            return -1;
+        }
+        router->bindings = bindings;
+        router->binding_capacity = capacity;
+    }
+    RouterBinding* binding = &router->bindings[router->binding_count];
+    gesture_init(&binding->gestures, &router->remotes[remote].sm, router->tap_window_ms, router->chord_window_ms);
+    binding->remote = remote;
+    return router->binding_count++;
+}
+
+// Add the rule "DEVICE_PATH KEY_CODE TV_NAME B1|B2". Returns an error message or NULL.
+static const char* add_route(Router* router, char* line)
+{
+    char path[ROUTER_PATH_SIZE];
+    char name[ROUTER_NAME_SIZE];
+    char button_name[8];
+    unsigned int code;
+    char extra;
+    if (sscanf(line, "%255s %u %31s %7s %c", path, &code, name, button_name, &extra) != 4)
+    {
+        return "expected DEVICE_PATH KEY_CODE TV_NAME B1|B2";
+    }
+    if (code > KEY_MAX)
+    {
+        return "key code out of range";
+    }
+    GestureButton button;
+    if (strcmp(button_name, "B1") == 0)
+    {
+        button = GESTURE_B1;
+    }
+    else if (strcmp(button_name, "B2") == 0)
+    {
+        button = GESTURE_B2;
+    }
+    else
+    {
+        return "button must be B1 or B2";
+    }
+
+    const int remote = find_remote(router, name);
+    if (remote < 0)
+    {
+        return "too many TVs";
+    }
+    const int device_index = find_device(router, path);
+    if (device_index < 0)
+    {
+        return "out of memory";
+    }
+    RouterDevice* device = &router->devices[device_index];
+    for (int i = 0; i < device->key_count; i++)
+    {
+        const RouterKey* key = &device->keys[i];
+        if (key->code == code)
+        {
+            return "key code already routed for this device";
+        }
+        if (router->bindings[key->binding].remote == remote && key->button == button)
+        {
+            // Two keys would share one KeyState.
+            return "button of this TV already routed for this device";
+        }
+    }
+    if (device->key_count == ROUTER_MAX_KEYS_PER_DEVICE)
+    {
+        return "too many keys for this device";
+    }
+    const int binding = find_binding(router, device, remote);
+    if (binding < 0)
+    {
+        return "out of memory";
+    }
+    device->keys[device->key_count++] = (RouterKey){ .code = (unsigned short)code, .button = button, .binding = binding };
+    return NULL;
+}
+
+bool router_load(Router* router, const char* path, const unsigned int tap_window_ms, const unsigned int chord_window_ms,
+    const ChannelTable* channels)
+{
+    memset(router, 0, sizeof(*router));
+    router->epoll_fd = -1;
+    router->tap_window_ms = tap_window_ms;
+    router->chord_window_ms = chord_window_ms;
+    router->channels = channels;
+    // Fixed, the state machines are pointed to by the recognizers & sinks.
+    router->remotes = calloc(ROUTER_MAX_REMOTES, sizeof(router->remotes[0]));
+    if (router->remotes == NULL)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        return false;
+    }
+
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Cannot open %s: %s.\n", path, strerror(errno));
+        return false;
+    }
+    char line[LINE_SIZE];
+    int line_number = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file) != NULL)
+    {
+        line_number++;
+        char* text = line + strspn(line, " \t");
+        if (*text == '\n' || *text == '\r' || *text == '\0' || *text == '#')
+        {
+            continue;
+        }
+        const char* error = add_route(router, text);
+        if (error != NULL)
+        {
+            fprintf(stderr, "%s:%d: %s.\n", path, line_number, error);
+            ok = false;
+        }
+    }
+    fclose(file);
+    if (ok && router->device_count == 0)
+    {
+        fprintf(stderr, "%s: no routes.\n", path);
+        ok = false;
+    }
+    return ok;
+}
+
+static void close_device(Router* router, RouterDevice* device)
+{
+    epoll_ctl(router->epoll_fd, EPOLL_CTL_DEL, device->fd, NULL);
+    close(device->fd);
+    device->fd = -1;
+    router->open_devices--;
+}
+
+// Route the events of one device. Returns the number of state machine events dispatched.
+static int route_events(Router* router, const RouterDevice* device, const struct input_event* events, const int count)
+{
+    int dispatched = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (events[i].type != EV_KEY)
+        {
+            continue;
+        }
+        for (int k = 0; k < device->key_count; k++)
+        {
+            const RouterKey* key = &device->keys[k];
+            if (key->code == events[i].code)
+            {
+                RouterBinding* binding = &router->bindings[key->binding];
+                const int n = gesture_handle_button_event(&binding->gestures, key->button, &events[i]);
+                router->remotes[binding->remote].events += (uint64_t)n;
+                dispatched += n;
+                break;
+            }
+        }
+    }
+    return dispatched;
+}
+
+// Read everything available on a device. Returns the number of state machine events dispatched.
+static int read_device(Router* router, RouterDevice* device)
+{
+    struct input_event events[READ_EVENTS];
+    int dispatched = 0;
+    while (device->fd != -1)
+    {
+        const ssize_t n = read(device->fd, events, sizeof(events));
+        if (n > 0)
+        {
+            dispatched += route_events(router, device, events, (int)((size_t)n / sizeof(events[0])));
+            if ((size_t)n < sizeof(events))
+            {
+                break;
+            }
+        }
+        else if (n == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (n == -1 && errno == EAGAIN)
+        {
+            break;
+        }
+        else
+        {
+            // Unplugged (ENODEV) or end of file.
+            fprintf(stderr, "Lost %s: %s.\n", device->path, (n == 0) ? "end of input" : strerror(errno));
+            close_device(router, device);
+        }
+    }
+    return dispatched;
+}
+
+// Dispatch the held back presses that are due. Returns the number of state machine events dispatched.
+static int expire_all(Router* router, const long long now_us)
+{
+    int dispatched = 0;
+    for (int i = 0; i < router->binding_count; i++)
+    {
+        RouterBinding* binding = &router->bindings[i];
+        const int n = gesture_expire(&binding->gestures, now_us);
+        router->remotes[binding->remote].events += (uint64_t)n;
+        dispatched += n;
+    }
+    return dispatched;
+}
+
+// Milliseconds until the next held back press is due, or -1.
+static int next_timeout_ms(const Router* router, const long long now_us)
+{
+    int timeout = -1;
+    for (int i = 0; i < router->binding_count; i++)
+    {
+        const int t = gesture_timeout_ms(&router->bindings[i].gestures, now_us);
+        if (t >= 0 && (timeout < 0 || t < timeout))
+        {
+            timeout = t;
+        }
+    }
+    return timeout;
+}
+
+bool router_run(Router* router, volatile sig_atomic_t* stop)
+{
+    router->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (router->epoll_fd == -1)
+    {
+        fprintf(stderr, "Cannot create the epoll instance: %s.\n", strerror(errno));
+        return false;
+    }
+    for (int i = 0; i < router->device_count; i++)
+    {
+        RouterDevice* device = &router->devices[i];
+        device->fd = open(device->path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (device->fd == -1)
+        {
+            fprintf(stderr, "Cannot open %s: %s.\n", device->path, strerror(errno));
+            return false;
+        }
+        struct epoll_event event = { .events = EPOLLIN, .data.u32 = (uint32_t)i };
+        if (epoll_ctl(router->epoll_fd, EPOLL_CTL_ADD, device->fd, &event) == -1)
+        {
+            fprintf(stderr, "Cannot watch %s: %s.\n", device->path, strerror(errno));
+            return false;
+        }
+        router->open_devices++;
+    }
+
+    for (int i = 0; i < router->remote_count; i++)
+    {
+        TvRemoteSm_start(&router->remotes[i].sm);
+    }
+    printf("Starting loop (%d devices, %d TVs).\n", router->device_count, router->remote_count);
+    fflush(stdout);
+
+    struct epoll_event ready[MAX_READY];
+    while (!*stop && router->open_devices > 0)
+    {
+        const int count = epoll_wait(router->epoll_fd, ready, MAX_READY, next_timeout_ms(router, timeInMicroseconds()));
+        if (count == -1 && errno != EINTR)
+        {
+            fprintf(stderr, "%s.\n", strerror(errno));
+            break;
+        }
+        // The new events expire their own recognizer's presses up to their timestamps first,
+        // then the presses of every recognizer whose window ran out are dispatched.
+        int dispatched = 0;
+        for (int i = 0; i < count; i++)
+        {
+            dispatched += read_device(router, &router->devices[ready[i].data.u32]);
+        }
+        dispatched += expire_all(router, timeInMicroseconds());
+        if (dispatched > 0)
+        {
+            fflush(stdout);
+        }
+    }
+
+    // Dispatch the presses still held back.
+    for (int i = 0; i < router->binding_count; i++)
+    {
+        RouterBinding* binding = &router->bindings[i];
+        router->remotes[binding->remote].events += (uint64_t)gesture_flush(&binding->gestures);
+    }
+    fflush(stdout);
+    return true;
+}
+
+void router_report(const Router* router)
+{
+    for (int i = 0; i < router->remote_count; i++)
+    {
+        fprintf(stderr, "%s: %llu events.\n", router->remotes[i].name, (unsigned long long)router->remotes[i].events);
+    }
+}
+
+void router_free(Router* router)
+{
+    for (int i = 0; i < router->device_count; i++)
+    {
+        if (router->devices[i].fd != -1)
+        {
+            close(router->devices[i].fd);
+        }
+    }
+    if (router->epoll_fd != -1)
+    {
+        close(router->epoll_fd);
+    }
+    free(router->devices);
+    free(router->bindings);
+    free(router->remotes);
+    memset(router, 0, sizeof(*router));
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <signal.h> // for sig_atomic_t
+#include <stdbool.h> // for bool
+#include <stdint.h> // for uint64_t
+
+#include "channels/channel_table.h"
+#include "input/gesture.h"
+#include "output/tv_output.h"
+#include "state_machine/TvRemoteSm.h"
+
+// Several keypads driving several TVs from one process.
+//
+// A routes file maps (input device, key code) to (TV, button), one rule per line:
+//   DEVICE_PATH KEY_CODE TV_NAME B1|B2
+// Empty lines & lines starting with '#' are ignored. Every TV is its own TvRemoteSm, created in the
+// order the names first appear. Every (device, TV) pair gets its own gesture recognizer (& so its own
+// KeyStates), so keypads pressing the same button of the same TV at the same time don't disturb each
+// other's long-press, double-press or chord timing.
+//
+// All devices are read from one epoll loop. The output of each TV is printed with its name in front.
+
+#define ROUTER_MAX_REMOTES 64
+#define ROUTER_MAX_KEYS_PER_DEVICE 16
+#define ROUTER_NAME_SIZE 32
+#define ROUTER_PATH_SIZE 256
+
+typedef struct RouterRemote {
+    char name[ROUTER_NAME_SIZE];
+    TvRemoteSm sm;
+    TvOutputSink sink;
+    uint64_t events;
+} RouterRemote;
+
+// A key of a device & the button it is for.
+typedef struct RouterKey {
+    unsigned short code;
+    GestureButton button;
+    // Index into `Router.bindings`.
+    int binding;
+} RouterKey;
+
+// The keys of one device that go to one TV.
+typedef struct RouterBinding {
+    GestureRecognizer gestures;
+    int remote;
+} RouterBinding;
+
+typedef struct RouterDevice {
+    char path[ROUTER_PATH_SIZE];
+    int fd;
+    int key_count;
+    RouterKey keys[ROUTER_MAX_KEYS_PER_DEVICE];
+} RouterDevice;
+
+typedef struct Router {
+    RouterRemote* remotes;
+    int remote_count;
+    RouterDevice* devices;
+    int device_count;
+    int device_capacity;
+    RouterBinding* bindings;
+    int binding_count;
+    int binding_capacity;
+    unsigned int tap_window_ms;
+    unsigned int chord_window_ms;
+    const ChannelTable* channels;
+    int epoll_fd;
+    // Devices still open.
+    int open_devices;
+} Router;
+
+// Read the routes from `path` & set up a TV for every name. Devices aren't opened yet.
+// Errors are printed to stderr. Returns false on failure.
+bool router_load(Router* router, const char* path, const unsigned int tap_window_ms, const unsigned int chord_window_ms,
+    const ChannelTable* channels);
+
+// Open every device, start every TV & read the devices until `*stop` is set or every device is gone.
+// Returns false if a device can't be opened (printed to stderr).
+bool router_run(Router* router, volatile sig_atomic_t* stop);
+
+// Print the events dispatched per TV to stderr.
+void router_report(const Router* router);
+
+// Close the devices & free everything.
+void router_free(Router* router);
@@ -0,0 +1,118 @@
+#include "input/uinput_device.h"
+
+#include <dirent.h> // for opendir
+#include <errno.h> // for errno
+#include <fcntl.h> // for open
+#include <linux/uinput.h> // for uinput_setup
+#include <stdio.h> // for snprintf
+#include <string.h> // for strncmp
+#include <sys/ioctl.h> // for ioctl
+#include <time.h> // for nanosleep
+#include <unistd.h> // for write
+
+// The device node appears asynchronously (udev), so poll for it.
+#define NODE_WAIT_ATTEMPTS 100
+#define NODE_WAIT_NANOSEC 10000000
+
+// Find "eventN" under the device's sysfs directory.
+static int find_event_node(const int fd, char* device_path, const size_t size)
+{
+    char sysname[64];
+    if (ioctl(fd, UI_GET_SYSNAME(sizeof(sysname)), sysname) < 0)
+    {
+        return -1;
+    }
+
+    char sys_path[128];
+    snprintf(sys_path, sizeof(sys_path), "/sys/devices/virtual/input/%s", sysname);
+
+    for (int attempt = 0; attempt < NODE_WAIT_ATTEMPTS; attempt++)
+    {
+        DIR* dir = opendir(sys_path);
+        if (dir != NULL)
+        {
+            struct dirent* entry;
+            while ((entry = readdir(dir)) != NULL)
+            {
+                if (strncmp(entry->d_name, "event", 5) == 0)
+                {
+                    snprintf(device_path, size, "/dev/input/%s", entry->d_name);
+                    closedir(dir);
+                    if (access(device_path, R_OK) == 0)
+                    {
+                        return 0;
+                    }
+                    dir = NULL;
+                    break;
+                }
+            }
+            if (dir != NULL)
+            {
+                closedir(dir);
+            }
+        }
+        const struct timespec delay = { .tv_sec = 0, .tv_nsec = NODE_WAIT_NANOSEC };
+        nanosleep(&delay, NULL);
+    }
+    errno = ENOENT;
+    return -1;
+}
+
+int uinput_create_keyboard(const char* name, const int* codes, const int count, char* device_path, const size_t size)
+{
+    const int fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd == -1)
+    {
+        return -1;
+    }
+
+    int result = ioctl(fd, UI_SET_EVBIT, EV_KEY);
+    result |= ioctl(fd, UI_SET_EVBIT, EV_REP);
+    for (int i = 0; i < count; i++)
+    {
+        result |= ioctl(fd, UI_SET_KEYBIT, codes[i]);
+    }
+
+    struct uinput_setup setup;
+    memset(&setup, 0, sizeof(setup));
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x1234;
+    setup.id.product = 0x5678;
+    snprintf(setup.name, UINPUT_MAX_NAME_SIZE, "%s", name);
+    result |= ioctl(fd, UI_DEV_SETUP, &setup);
+    result |= ioctl(fd, UI_DEV_CREATE);
+
+    if (result < 0 || find_event_node(fd, device_path, size) < 0)
+    {
+        const int error = errno;
+        uinput_destroy_keyboard(fd);
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
+
+static int emit(const int fd, const int type, const int code, const int value)
+{
+    struct input_event event;
+    memset(&event, 0, sizeof(event));
+    event.type = (unsigned short)type;
+    event.code = (unsigned short)code;
+    event.value = value;
+    return write(fd, &event, sizeof(event)) == (ssize_t)sizeof(event) ? 0 : -1;
+}
+
+int uinput_send_key(const int fd, const int code, const int value)
+{
+    if (emit(fd, EV_KEY, code, value) < 0)
+    {
+        return -1;
+    }
+    return emit(fd, EV_SYN, SYN_REPORT, 0);
+}
+
+void uinput_destroy_keyboard(const int fd)
+{
+    ioctl(fd, UI_DEV_DESTROY);
+    close(fd);
+}
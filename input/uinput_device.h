@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stddef.h> // for size_t
+
+// Virtual keyboard through /dev/uinput, for driving `remote` without real hardware (needs root).
+
+// Create a keyboard named `name` that can send the `count` key `codes`. Autorepeat is enabled so
+// held keys produce REPEATED_EVENTs like a real keyboard. The event device node
+// (e.g. /dev/input/event7) is written to `device_path`.
+// Returns the uinput file descriptor or -1 (errno is set).
+int uinput_create_keyboard(const char* name, const int* codes, const int count, char* device_path, const size_t size);
+
+// Send a key event (RELEASED_EVENT/PRESSED_EVENT) followed by a SYN_REPORT. Returns 0 or -1.
+int uinput_send_key(const int fd, const int code, const int value);
+
+// Remove the virtual keyboard.
+void uinput_destroy_keyboard(const int fd);
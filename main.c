@@ -1,10 +1,14 @@
 #include <errno.h> // for errno
 #include <fcntl.h> // for open
+#include <getopt.h> // for getopt_long
 #include <linux/input.h> // for input_event
+#include <poll.h> // for poll
+#include <signal.h> // for sigaction
 #include <stdbool.h> // for bool
 #include <stdio.h> // for fprint
 #include <stdlib.h> // for EXIT_FAILURE & EXIT_SUCCESS
 #include <string.h> // for strerror
+#include <sys/signalfd.h> // for signalfd
 #include <termios.h> // for termios
 #include <time.h> // for nanosleep
 #include <unistd.h> // for read & STDIN_FILENO
@@ -12,18 +16,56 @@
 // The state machine for the TV remote.
 #include "state_machine/TvRemoteSm.h"
 
-// Key codes for B1 & B2.
-#define B1_CODE 17 // w
-#define B2_CODE 31 // b
+// B1 & B2 key handling.
+#include "input/key_input.h"
 
-// Key event types.
-#define RELEASED_EVENT 0
-#define PRESSED_EVENT 1
-#define REPEATED_EVENT 2
+// Chords & multi-taps.
+#include "input/gesture.h"
 
-#define SECONDS_TO_MS 1000
-#define MS_TO_MICROSEC 1000
-#define SECONDS_TO_NANOSEC 1000000
+// Terminal on-screen display.
+#include "output/osd.h"
+
+// Output written by a separate thread.
+#include "output/async_writer.h"
+
+// Input-to-action latency measurement.
+#include "input/latency.h"
+
+// Channel lineup.
+#include "channels/channel_table.h"
+
+// Several keypads & TVs.
+#include "input/router.h"
+
+// Waking up only for the keys the active state uses.
+#include "input/power.h"
+#include "metrics/power_stats.h"
+
+// Counters served over HTTP.
+#include "metrics/metrics_server.h"
+
+// The state machine loaded from a shared object & swapped when it's rebuilt.
+#include "state_machine/sm_reload.h"
+
+// The input loop on a thread of its own, with real-time scheduling.
+#include "input/realtime.h"
+
+// The state saved on exit & restored on start.
+#include "state_machine/TvRemoteSm_persist.h"
+
+// The keyboard read by default.
+#define DEFAULT_DEVICE "/dev/input/by-path/platform-i8042-serio-0-event-kbd"
+
+#define DEFAULT_OSD_FPS 30
+#define DEFAULT_ASYNC_QUEUE 256
+
+// Events read from the device & queued while the state machine is swapped.
+#define RELOAD_QUEUE_SIZE 256
+
+// On SIGINT/SIGTERM, the input events already available are dispatched before exiting, up to
+// SHUTDOWN_DRAIN_EVENTS of them or for SHUTDOWN_DRAIN_MS, so a key held down can't hold up the exit.
+#define SHUTDOWN_DRAIN_EVENTS 256
+#define SHUTDOWN_DRAIN_MS 100
 
 // https://stackoverflow.com/questions/1157209/is-there-an-alternative-sleep-function-in-c-to-milliseconds
 /* msleep(): Sleep for the requested number of milliseconds. */
@@ -44,92 +86,627 @@ int msleep(const unsigned long msec)
     return res;
 }
 
-// Function to get the time in ms.
-long long timeInMilliseconds(void) {
-    struct timeval tv;
+// The terminal settings before console_echo(true), restored by console_echo(false).
+static struct termios saved_console;
+static bool console_saved = false;
 
-    gettimeofday(&tv, NULL);
-    return (((long long)tv.tv_sec)*SECONDS_TO_MS)+(tv.tv_usec/MS_TO_MICROSEC);
+// Put the terminal back as it was. Registered with atexit() too, so an early return restores it.
+void restore_console(void)
+{
+    if (console_saved)
+    {
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved_console);
+        console_saved = false;
+    }
 }
 
 // logic comes from https://github.com/MichaelDipperstein/keypress/blob/master/keypress.c
 void console_echo(const bool echo_off)
 {
-    unsigned char echo_bit;
-    if(echo_off)
+    if (!echo_off)
     {
-        echo_bit = ECHO; // Set to disable echo.
-    }
-    else {
-        echo_bit = 0; // Clear to enable echo.
+        restore_console();
+        return;
     }
-
     struct termios state;
-    tcgetattr(STDIN_FILENO, &state);
-    state.c_lflag &= ~(echo_bit | ICANON);;
+    if (console_saved || tcgetattr(STDIN_FILENO, &state) == -1)
+    {
+        // Already off, or not a terminal.
+        return;
+    }
+    saved_console = state;
+    console_saved = true;
+    atexit(restore_console);
+    state.c_lflag &= ~(ECHO | ICANON);
     tcsetattr(STDIN_FILENO, TCSANOW, &state);
 }
 
-const unsigned int LONG_PRESS_TIMEOUT = 800; // ms.
+// Command line options.
+typedef struct RemoteOptions {
+    const char* device;
+    const char* channels;
+    const char* routes;
+    bool latency;
+    unsigned int tap_ms;
+    unsigned int chord_ms;
+    bool osd;
+    unsigned int osd_fps;
+    bool async_output;
+    unsigned int async_queue;
+    TvAsyncPolicy async_policy;
+    unsigned int throttle_us;
+    bool power_save;
+    bool power_report;
+    const char* metrics;
+    const char* hot_reload;
+    bool realtime;
+    int rt_priority;
+    int rt_cpu;
+    bool mlock;
+    const char* state;
+} RemoteOptions;
 
-typedef struct KeyState {
-    unsigned long long press_start_time;
-    bool pressed;
-    bool long_press;
-    int press_event;
-    int long_press_event;
-} KeyState;
+void print_usage(const char* name)
+{
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -d, --device PATH  input device to read (default %s)\n"
+        "  -c, --channels PATH        channel table to use (see build_channel_table, default 1-256)\n"
+        "  -r, --routes PATH          drive several TVs from several devices as routed by PATH\n"
+        "  -l, --latency      measure input-to-action latency & report it on exit\n"
+        "      --tap-ms N     window for double/triple presses (default %d, 0 disables them)\n"
+        "      --chord-ms N   window for pressing B1 & B2 together (default %d, 0 disables it)\n"
+        "  -o, --osd          show a status display that is updated in place\n"
+        "      --osd-fps N    maximum display updates per second (default %d)\n"
+        "  -a, --async-output write the output from a separate thread so it never blocks input\n"
+        "      --async-queue N        messages the output queue holds (default %d)\n"
+        "      --async-policy POLICY  drop-oldest (default) or coalesce when the queue is full\n"
+        "      --throttle-us N        sleep after every output write (simulates a slow terminal)\n"
+        "  -p, --power-save   only wake up for the keys the active state uses (B1 when the TV is off)\n"
+        "      --power-report report the wakeups/s & CPU time per state on exit\n"
+        "  -m, --metrics ADDR serve the counters over HTTP on a Unix socket (/path) or a port of 127.0.0.1\n"
+        "      --hot-reload SO        run the state machine of SO (tvremote_sm.so) & swap it in when SO is rebuilt\n"
+        "      --realtime[=PRIO]      run the input loop on a thread of its own, SCHED_FIFO PRIO when permitted\n"
+        "                             (default %d, 0 for normal priority)\n"
+        "      --cpu N        pin the --realtime thread to CPU N\n"
+        "      --mlock        lock the memory of the process with --realtime\n"
+        "  -s, --state PATH   restore the state saved in PATH on start & save it there on exit\n"
+        "  -h, --help         show this help\n",
+        name, DEFAULT_DEVICE, DEFAULT_TAP_WINDOW, DEFAULT_CHORD_WINDOW, DEFAULT_OSD_FPS, DEFAULT_ASYNC_QUEUE,
+        REALTIME_DEFAULT_PRIORITY);
+}
 
-// Handle the state transitions between key press & long-press.
-void handle_button_press(const int value, KeyState* key, TvRemoteSm* tv_remote)
+// Parse the command line. Returns false if the program should exit.
+bool parse_options(int argc, char ** argv, RemoteOptions* options)
 {
-    switch (value)
+    enum { OPTION_OSD_FPS = 256, OPTION_ASYNC_QUEUE, OPTION_ASYNC_POLICY, OPTION_THROTTLE_US, OPTION_TAP_MS, OPTION_CHORD_MS,
+        OPTION_POWER_REPORT, OPTION_HOT_RELOAD, OPTION_REALTIME, OPTION_CPU, OPTION_MLOCK };
+    static const struct option long_options[] = {
+        { "device", required_argument, NULL, 'd' },
+        { "channels", required_argument, NULL, 'c' },
+        { "routes", required_argument, NULL, 'r' },
+        { "latency", no_argument, NULL, 'l' },
+        { "tap-ms", required_argument, NULL, OPTION_TAP_MS },
+        { "chord-ms", required_argument, NULL, OPTION_CHORD_MS },
+        { "osd", no_argument, NULL, 'o' },
+        { "osd-fps", required_argument, NULL, OPTION_OSD_FPS },
+        { "async-output", no_argument, NULL, 'a' },
+        { "async-queue", required_argument, NULL, OPTION_ASYNC_QUEUE },
+        { "async-policy", required_argument, NULL, OPTION_ASYNC_POLICY },
+        { "throttle-us", required_argument, NULL, OPTION_THROTTLE_US },
+        { "power-save", no_argument, NULL, 'p' },
+        { "power-report", no_argument, NULL, OPTION_POWER_REPORT },
+        { "metrics", required_argument, NULL, 'm' },
+        { "hot-reload", required_argument, NULL, OPTION_HOT_RELOAD },
+        { "realtime", optional_argument, NULL, OPTION_REALTIME },
+        { "cpu", required_argument, NULL, OPTION_CPU },
+        { "mlock", no_argument, NULL, OPTION_MLOCK },
+        { "state", required_argument, NULL, 's' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    options->device = DEFAULT_DEVICE;
+    options->channels = NULL;
+    options->routes = NULL;
+    options->latency = false;
+    options->tap_ms = DEFAULT_TAP_WINDOW;
+    options->chord_ms = DEFAULT_CHORD_WINDOW;
+    options->osd = false;
+    options->osd_fps = DEFAULT_OSD_FPS;
+    options->async_output = false;
+    options->async_queue = DEFAULT_ASYNC_QUEUE;
+    options->async_policy = TV_ASYNC_DROP_OLDEST;
+    options->throttle_us = 0;
+    options->power_save = false;
+    options->power_report = false;
+    options->metrics = NULL;
+    options->hot_reload = NULL;
+    options->realtime = false;
+    options->rt_priority = REALTIME_DEFAULT_PRIORITY;
+    options->rt_cpu = -1;
+    options->mlock = false;
+    options->state = NULL;
+
+    int option;
+    while ((option = getopt_long(argc, argv, "d:c:r:loapm:s:h", long_options, NULL)) != -1)
     {
-        case RELEASED_EVENT:
+        switch (option)
         {
-            // Clear the flags.
-            key->pressed = false;
-            key->long_press = false;
-            key->press_start_time = 0;
-            break;
-        }
-        case PRESSED_EVENT:
-        {
-            // Check if the key has already been pressed.
-            // If not, then register the press.
-            // This will be cleared on the key release event.
-            if (!key->pressed)
+            case 'd':
+                options->device = optarg;
+                break;
+            case 'c':
+                options->channels = optarg;
+                break;
+            case 'r':
+                options->routes = optarg;
+                break;
+            case 'l':
+                options->latency = true;
+                break;
+            case OPTION_TAP_MS:
+                options->tap_ms = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case OPTION_CHORD_MS:
+                options->chord_ms = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'o':
+                options->osd = true;
+                break;
+            case OPTION_OSD_FPS:
+                options->osd_fps = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'a':
+                options->async_output = true;
+                break;
+            case OPTION_ASYNC_QUEUE:
+                options->async_queue = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case OPTION_ASYNC_POLICY:
+                if (strcmp(optarg, "drop-oldest") == 0)
+                {
+                    options->async_policy = TV_ASYNC_DROP_OLDEST;
+                }
+                else if (strcmp(optarg, "coalesce") == 0)
+                {
+                    options->async_policy = TV_ASYNC_COALESCE;
+                }
+                else
+                {
+                    fprintf(stderr, "Unknown async policy: %s.\n", optarg);
+                    return false;
+                }
+                break;
+            case OPTION_THROTTLE_US:
+                options->throttle_us = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'p':
+                options->power_save = true;
+                break;
+            case OPTION_POWER_REPORT:
+                options->power_report = true;
+                break;
+            case 'm':
+                options->metrics = optarg;
+                break;
+            case OPTION_HOT_RELOAD:
+                options->hot_reload = optarg;
+                break;
+            case OPTION_REALTIME:
+                options->realtime = true;
+                if (optarg != NULL)
+                {
+                    options->rt_priority = (int)strtol(optarg, NULL, 10);
+                }
+                break;
+            case OPTION_CPU:
             {
-                key->pressed = true;
-                key->press_start_time = timeInMilliseconds();
-                TvRemoteSm_dispatch_event(tv_remote, key->press_event);
+                char* end;
+                errno = 0;
+                const long cpu = strtol(optarg, &end, 10);
+                if (end == optarg || *end != '\0' || errno != 0 || cpu < 0 || cpu >= REALTIME_MAX_CPUS)
+                {
+                    fprintf(stderr, "The --cpu number must be in [0, %d].\n", REALTIME_MAX_CPUS - 1);
+                    return false;
+                }
+                options->rt_cpu = (int)cpu;
+                break;
             }
-            break;
+            case OPTION_MLOCK:
+                options->mlock = true;
+                break;
+            case 's':
+                options->state = optarg;
+                break;
+            default:
+                print_usage(argv[0]);
+                return false;
+        }
+    }
+    if (options->osd && options->async_output)
+    {
+        fprintf(stderr, "--osd and --async-output can't be combined.\n");
+        return false;
+    }
+    if (options->routes != NULL && (options->osd || options->async_output || options->latency || options->power_save
+        || options->power_report || options->metrics != NULL || options->hot_reload != NULL || options->realtime || options->state != NULL))
+    {
+        fprintf(stderr, "--routes can't be combined with --osd, --async-output, --latency, --metrics, --hot-reload, --realtime, --state or the power options.\n");
+        return false;
+    }
+    if (options->rt_priority < 0 || options->rt_priority > 99)
+    {
+        fprintf(stderr, "The --realtime priority must be in [0, 99].\n");
+        return false;
+    }
+    if (!options->realtime && (options->rt_cpu != -1 || options->mlock))
+    {
+        fprintf(stderr, "--cpu and --mlock need --realtime.\n");
+        return false;
+    }
+    // These read the TvRemoteSm of this build.
+    if (options->hot_reload != NULL && (options->osd || options->power_save || options->power_report || options->metrics != NULL
+        || options->state != NULL))
+    {
+        fprintf(stderr, "--hot-reload can't be combined with --osd, --power-save, --power-report, --metrics or --state.\n");
+        return false;
+    }
+    return true;
+}
+
+// Set by SIGINT/SIGTERM to leave the main loop.
+static volatile sig_atomic_t stop_requested = false;
+
+void request_stop(int signal_number)
+{
+    (void)signal_number;
+    stop_requested = true;
+}
+
+// Stop the main loop on SIGINT/SIGTERM. No SA_RESTART, so a blocked read returns EINTR.
+void install_stop_handler(void)
+{
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = request_stop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+}
+
+// Block SIGINT/SIGTERM in this thread & the threads it starts, & receive them from a signalfd the input
+// loop polls instead: the loop stops between two events & the shutdown runs from main(), not from a handler.
+// Returns the signalfd, or -1 with install_stop_handler() used instead.
+int open_stop_signal_fd(void)
+{
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    const int signal_fd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signal_fd == -1)
+    {
+        pthread_sigmask(SIG_UNBLOCK, &signals, NULL);
+        install_stop_handler();
+    }
+    return signal_fd;
+}
+
+// The current time in us, on the clock of the input events.
+long long input_time_us(const RemoteOptions* options, const LatencyStats* latency)
+{
+    return options->latency ? (long long)latency_now_us(latency) : timeInMicroseconds();
+}
+
+// What every event the gesture recognizer dispatches is recorded in.
+typedef struct DispatchRecorders {
+    const RemoteOptions* options;
+    const TvRemoteSm* sm;
+    LatencyStats* latency;
+    TvMetrics* metrics;
+} DispatchRecorders;
+
+// Record the latency & the counters of every event the gesture recognizer dispatches.
+void record_dispatch(void* ctx, const int event_id, const struct input_event* source)
+{
+    DispatchRecorders* recorders = ctx;
+    if (recorders->options->latency)
+    {
+        latency_dispatched(recorders->latency, source, event_id);
+    }
+    if (recorders->options->metrics != NULL)
+    {
+        const long long event_us = (long long)source->input_event_sec * SECONDS_TO_MS * MS_TO_MICROSEC + source->input_event_usec;
+        const long long now_us = input_time_us(recorders->options, recorders->latency);
+        tv_metrics_dispatched(recorders->metrics, recorders->sm, event_id, (uint64_t)(now_us > event_us ? now_us - event_us : 0));
+    }
+}
+
+// Read the devices of the routes file until stopped. Returns the exit status.
+int run_routes(const RemoteOptions* options, const ChannelTable* channels)
+{
+    Router router;
+    if (!router_load(&router, options->routes, options->tap_ms, options->chord_ms, channels))
+    {
+        router_free(&router);
+        return EXIT_FAILURE;
+    }
+    install_stop_handler();
+    const bool ran = router_run(&router, &stop_requested);
+    if (ran)
+    {
+        router_report(&router);
+    }
+    router_free(&router);
+    return ran ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Swap in the rebuilt state machine between two events: the events already waiting on the device are
+// read & queued first, then dispatched to the new machine. Returns the number of state machine events dispatched.
+int reload_machine(TvSmReloader* reloader, const int fd, GestureRecognizer* gestures)
+{
+    struct input_event queue[RELOAD_QUEUE_SIZE];
+    int queued = 0;
+    struct pollfd input = { .fd = fd, .events = POLLIN };
+    while (queued < RELOAD_QUEUE_SIZE && poll(&input, 1, 0) == 1 && (input.revents & POLLIN)
+        && read(fd, &queue[queued], sizeof(queue[0])) == sizeof(queue[0]))
+    {
+        queued++;
+    }
+
+    uint64_t load_us;
+    uint64_t swap_us;
+    if (sm_reload_swap(reloader, &load_us, &swap_us))
+    {
+        fprintf(stderr, "Reloaded %s in %llu us (swap %llu us), state %s, %d events queued.\n", reloader->path,
+            (unsigned long long)(load_us + swap_us), (unsigned long long)swap_us, sm_reload_state_name(reloader), queued);
+    }
+
+    int dispatched = 0;
+    for (int i = 0; i < queued; i++)
+    {
+        dispatched += gesture_handle_input_event(gestures, &queue[i]);
+    }
+    return dispatched;
+}
+
+// Make the output of the events dispatched so far to `sm` visible.
+// Returns the ms until the next display frame is due, or -1 (see tv_osd_flush()).
+int flush_output(const RemoteOptions* options, const TvRemoteSm* sm, TvOsd* osd, LatencyStats* latency)
+{
+    int osd_wait = -1;
+    if (options->osd)
+    {
+        // The mask is cleared at the top of the loop, after every dispatch of the iteration was flushed.
+        tv_osd_update(osd, &sm->vars);
+        const unsigned long long frames = osd->frames;
+        osd_wait = tv_osd_flush(osd, timeInMilliseconds());
+        if (options->latency && osd->frames != frames)
+        {
+            latency_output_flushed(latency);
+        }
+    }
+    else
+    {
+        // One flush per event, so a pipe (e.g. remote_e2e) sees the output right away.
+        // With --async-output this is a no-op & the latency is the hand-off to the writer thread.
+        fflush(stdout);
+        if (options->latency)
+        {
+            latency_output_flushed(latency);
+        }
+    }
+    return osd_wait;
+}
+
+// The shorter of two poll timeouts, where -1 means none.
+int earliest_timeout(const int a, const int b)
+{
+    if (a < 0)
+    {
+        return b;
+    }
+    if (b < 0)
+    {
+        return a;
+    }
+    return a < b ? a : b;
+}
+
+// What the input loop works on, set up by main().
+typedef struct InputLoop {
+    const RemoteOptions* options;
+    TvRemoteSm* sm;
+    GestureRecognizer* gestures;
+    int fd;
+    TvOsd* osd;
+    LatencyStats* latency;
+    TvMetrics* metrics;
+    MetricsServer* metrics_server;
+    TvSmReloader* reloader;
+    PowerPolicy* power;
+    PowerStats* power_stats;
+    // See open_stop_signal_fd(), -1 if the loop is stopped by install_stop_handler().
+    int signal_fd;
+    // errno of what ended the loop when it wasn't stopped.
+    int error;
+    // When a stop signal was read from `signal_fd` (timeInMicroseconds()), 0 if none was.
+    long long stop_us;
+} InputLoop;
+
+// Read & dispatch the input events until stopped or the device fails. A thread of its own with --realtime.
+void* run_input_loop(void* arg)
+{
+    InputLoop* loop = arg;
+    const RemoteOptions* options = loop->options;
+    TvRemoteSm* sm = loop->sm;
+    GestureRecognizer* gestures = loop->gestures;
+    const int fd = loop->fd;
+    TvOsd* osd = loop->osd;
+    LatencyStats* latency = loop->latency;
+    TvMetrics* metrics = loop->metrics;
+    MetricsServer* metrics_server = loop->metrics_server;
+    TvSmReloader* reloader = loop->reloader;
+    PowerPolicy* power = loop->power;
+    PowerStats* power_stats = loop->power_stats;
+
+    int osd_wait = -1;
+    if (options->osd)
+    {
+        osd_wait = tv_osd_flush(osd, timeInMilliseconds());
+    }
+    while(!stop_requested)
+    {
+        if (options->power_save && !power_policy_update(power, gestures))
+        {
+            fprintf(stderr, "Cannot set the event mask of %s: %s. Every key wakes the process up.\n", options->device, strerror(errno));
         }
-        case REPEATED_EVENT:
+        // What the dispatches since the last iteration changed.
+        const unsigned char changed = sm->vars.changed;
+        sm->vars.changed = 0;
+        // The time since the state was entered is charged to the state it's spent in, only when it changes.
+        if (options->power_report && (changed & TV_CHANGED_STATE))
         {
-            // Check if the key has already been pressed and a long-press event hasn't been recorded.
-            // If the long-press event hasn't been recorded, then register the long-press.
-            // This is necessary because this event will continue to be triggered while the key is depressed.
-            if (key->pressed && !key->long_press)
+            power_stats_sample(power_stats, sm->state_id);
+        }
+
+        // Wait for the next event, or until a pending display frame or held back key press is due.
+        // The metrics clients, the shared object's changes & the stop signals are handled from the same poll().
+        const int wait = earliest_timeout(osd_wait, gesture_timeout_ms(gestures, input_time_us(options, latency)));
+        if (wait >= 0 || options->metrics != NULL || options->hot_reload != NULL || loop->signal_fd != -1)
+        {
+            struct pollfd fds[3 + METRICS_MAX_FDS] = { { .fd = fd, .events = POLLIN }, { .fd = -1 },
+                { .fd = loop->signal_fd, .events = POLLIN } };
+            if (options->hot_reload != NULL)
+            {
+                fds[1] = (struct pollfd){ .fd = sm_reload_fd(reloader), .events = POLLIN };
+            }
+            int fd_count = 3;
+            if (options->metrics != NULL)
+            {
+                fd_count += metrics_server_poll_fds(metrics_server, &fds[3]);
+            }
+            const int ready = poll(fds, (nfds_t)fd_count, wait);
+            if (ready == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            struct signalfd_siginfo signal_info;
+            if (fds[2].revents != 0 && read(loop->signal_fd, &signal_info, sizeof(signal_info)) == (ssize_t)sizeof(signal_info))
+            {
+                // What is already queued on the device is dispatched by drain_input().
+                loop->stop_us = timeInMicroseconds();
+                stop_requested = true;
+                break;
+            }
+            if (options->metrics != NULL)
             {
-                // Check if it has been long enough to be considered a "long-press";
-                if ((timeInMilliseconds() - key->press_start_time) > LONG_PRESS_TIMEOUT)
+                metrics_server_handle(metrics_server, &fds[3], fd_count - 3);
+            }
+            if (fds[1].revents != 0 && sm_reload_changed(reloader)
+                && reload_machine(reloader, fd, gestures) > 0)
+            {
+                osd_wait = flush_output(options, sm, osd, latency);
+            }
+            if (fds[0].revents == 0) {
+                const int dispatched = gesture_expire(gestures, input_time_us(options, latency));
+                if (dispatched > 0 || (ready == 0 && options->osd))
                 {
-                    key->long_press = true;
-                    TvRemoteSm_dispatch_event(tv_remote, key->long_press_event);
+                    osd_wait = flush_output(options, sm, osd, latency);
                 }
+                continue;
+            }
+        }
+
+        // Read an event from the keyboard.
+        struct input_event event;
+        const ssize_t n = read(fd, &event, sizeof event);
+        if (n == (ssize_t)-1) {
+            if (errno == EINTR) {
+                // Continue processing in the case of an interrupted system call.
+                continue;
+            } else {
+                // Error.
+                break;
             }
+        } else if (n != sizeof event) {
+            // Failed to read enough data to constitute an event.
+            errno = EIO;
             break;
         }
-        default:
+
+        if (event.type == EV_SYN && event.code == SYN_DROPPED && options->metrics != NULL)
+        {
+            tv_metrics_input_dropped(metrics);
+        }
+
+        // Forward B1 & B2 key events to the state machine. Other events are ignored.
+        if (gesture_handle_input_event(gestures, &event) > 0)
+        {
+            osd_wait = flush_output(options, sm, osd, latency);
+        }
+    }
+    loop->error = errno;
+    return NULL;
+}
+
+// Show the power & mode of a state restored by --state on the output, as entering it would have.
+void show_restored_state(const TvOutputSink* sink, const TvRemoteSm* sm)
+{
+    const TvRemoteSm_StateId state_id = sm->state_id;
+    tv_output_show(sink, (state_id == TvRemoteSm_StateId_TV_OFF) ? "TV OFF" : "TV ON");
+    if (state_id >= TvRemoteSm_StateId_BRIGHTNESS_CHANGE && state_id <= TvRemoteSm_StateId_BRIGHTNESS_UP)
+    {
+        tv_output_show(sink, "Brightness Change");
+    }
+    else if (state_id == TvRemoteSm_StateId_CHANNEL_ENTRY)
+    {
+        tv_output_show(sink, "Channel Entry");
+        tv_output_value(sink, TV_OUTPUT_CHANNEL_ENTRY, sm->vars.channel_entry);
+    }
+    else if (state_id >= TvRemoteSm_StateId_CHANNEL_SELECT && state_id <= TvRemoteSm_StateId_CHANNEL_UP)
+    {
+        tv_output_show(sink, "Channel Select");
+    }
+    else if (state_id >= TvRemoteSm_StateId_VOLUME_CHANGE && state_id <= TvRemoteSm_StateId_VOLUME_UP)
+    {
+        tv_output_show(sink, "Volume Change");
+    }
+}
+
+// Dispatch the input events already available on the device when the loop was stopped, within
+// SHUTDOWN_DRAIN_EVENTS & SHUTDOWN_DRAIN_MS. Returns the number of events read.
+int drain_input(const InputLoop* loop)
+{
+    const long long deadline = timeInMilliseconds() + SHUTDOWN_DRAIN_MS;
+    int drained = 0;
+    struct pollfd input = { .fd = loop->fd, .events = POLLIN };
+    while (drained < SHUTDOWN_DRAIN_EVENTS && timeInMilliseconds() < deadline
+        && poll(&input, 1, 0) == 1 && (input.revents & POLLIN) != 0)
+    {
+        struct input_event event;
+        if (read(loop->fd, &event, sizeof event) != (ssize_t)sizeof event)
+        {
             break;
+        }
+        drained++;
+        gesture_handle_input_event(loop->gestures, &event);
     }
-    return;
+    return drained;
 }
 
 int main(int argc, char ** argv)
 {
+    RemoteOptions options;
+    if (!parse_options(argc, argv, &options))
+    {
+        return EXIT_FAILURE;
+    }
+
     // Don't echo key inputs.
     const bool ECHO_OFF = true;
     console_echo(ECHO_OFF);
@@ -137,86 +714,248 @@ int main(int argc, char ** argv)
     // Configure the State Machine for the TV remote.
     TvRemoteSm TvRemote;
     TvRemoteSm_ctor(&TvRemote);
-    TvRemoteSm_start(&TvRemote);
-
-    // Store the state of the buttons.
-    KeyState b1 = {
-        .pressed = false,
-        .press_start_time = 0,
-        .long_press = false,
-        .press_event = TvRemoteSm_EventId_B1_PRESS,
-        .long_press_event = TvRemoteSm_EventId_B1_LONG_PRESS
-    };
-    KeyState b2 = {
-        .pressed = false,
-        .press_start_time = 0,
-        .long_press = false,
-        .press_event = TvRemoteSm_EventId_B2_PRESS,
-        .long_press_event = TvRemoteSm_EventId_B2_LONG_PRESS
-    };
+
+    // Tune the channels of the lineup instead of every number.
+    ChannelTable channels;
+    if (options.channels != NULL)
+    {
+        if (!channel_table_open(&channels, options.channels))
+        {
+            fprintf(stderr, "Cannot load channel table %s: %s.\n", options.channels, strerror(errno));
+            return EXIT_FAILURE;
+        }
+        TvRemote.vars.channels = &channels;
+    }
+
+    if (options.routes != NULL)
+    {
+        const int status = run_routes(&options, TvRemote.vars.channels);
+        if (options.channels != NULL)
+        {
+            channel_table_close(&channels);
+        }
+        const bool ECHO_ON = false;
+        console_echo(ECHO_ON);
+        return status;
+    }
+
+    // Before the output & --realtime threads are started, so they inherit the blocked signals.
+    const int signal_fd = open_stop_signal_fd();
+    // What is opened from here on is closed at the end of main(), also when opening the rest fails.
+    int exit_status = EXIT_SUCCESS;
+
+    // Send the output actions to the display instead of printing them.
+    TvOsd osd;
+    if (options.osd)
+    {
+        tv_osd_init(&osd, options.osd_fps, STDOUT_FILENO);
+        tv_osd_set_channel_table(&osd, TvRemote.vars.channels);
+        TvRemote.vars.output = &osd.sink;
+    }
+
+    // Or queue them for the writer thread.
+    TvAsyncWriter async_writer;
+    if (options.async_output)
+    {
+        fflush(stdout);
+        if (!tv_async_writer_start(&async_writer, options.async_queue, options.async_policy, STDOUT_FILENO, options.throttle_us))
+        {
+            fprintf(stderr, "Cannot start the output thread.\n");
+            exit_status = EXIT_FAILURE;
+            goto close_signals;
+        }
+        TvRemote.vars.output = &async_writer.sink;
+    }
+
+    // Or run the machine of the shared object instead of the one linked in.
+    TvSmReloader reloader;
+    if (options.hot_reload != NULL)
+    {
+        if (!sm_reload_open(&reloader, options.hot_reload, TvRemote.vars.output, TvRemote.vars.channels))
+        {
+            exit_status = EXIT_FAILURE;
+            goto stop_writer;
+        }
+    }
+    // Carry on from where the last run stopped, or start from the initial state.
+    else if (options.state != NULL && TvRemoteSm_persist_load(&TvRemote, options.state))
+    {
+        // The display shows the values, the other outputs start with them. Nothing is queued for the writer yet.
+        if (!options.osd)
+        {
+            printf("Restored %s: volume %d, brightness %d, channel %d.\n", TvRemoteSm_state_id_to_string(TvRemote.state_id),
+                TvRemote.vars.volume, TvRemote.vars.brightness, TvRemote.vars.channel);
+            fflush(stdout);
+        }
+        show_restored_state(TvRemote.vars.output, &TvRemote);
+    }
+    else
+    {
+        if (options.state != NULL && errno != ENOENT)
+        {
+            fprintf(stderr, "Cannot restore the state saved in %s: %s. Starting from the initial state.\n", options.state, strerror(errno));
+        }
+        TvRemoteSm_start(&TvRemote);
+    }
+    if (options.osd)
+    {
+        tv_osd_update(&osd, &TvRemote.vars);
+    }
+
+    // Store the state of the buttons & recognize chords and multi-taps.
+    GestureRecognizer gestures;
+    gesture_init(&gestures, &TvRemote, options.tap_ms, options.chord_ms);
+    if (options.hot_reload != NULL)
+    {
+        gesture_set_machine(&gestures, &reloader.machine);
+    }
 
     // Open the keyboard input device.
     // https://stackoverflow.com/questions/20943322/accessing-keys-from-linux-input-device/20946151#20946151
-    const char *dev = "/dev/input/by-path/platform-i8042-serio-0-event-kbd";
-    struct input_event event;
-    ssize_t n;
+    const char *dev = options.device;
     const int fd = open(dev, O_RDONLY);
     if (fd == -1) {
         fprintf(stderr, "Cannot open %s: %s.\n", dev, strerror(errno));
-        return EXIT_FAILURE;
+        exit_status = EXIT_FAILURE;
+        goto close_reloader;
     }
 
-    printf("Starting loop.\n");
-    while(true)
+    LatencyStats latency;
+    if (options.latency)
     {
-        // Read an event from the keyboard.
-        n = read(fd, &event, sizeof event);
-        if (n == (ssize_t)-1) {
-            if (errno == EINTR) {
-                // Continue processing in the case of an interrupted system call.
-                continue;
-            } else {
-                // Error.
-                break;
-            }
-        } else if (n != sizeof event) {
-            // Failed to read enough data to constitute an event.
-            errno = EIO;
-            break;
+        latency_init(&latency, fd);
+    }
+
+    // Serve the counters from this loop.
+    TvMetrics metrics;
+    MetricsServer metrics_server;
+    if (options.metrics != NULL)
+    {
+        tv_metrics_init(&metrics, &TvRemote);
+        if (!metrics_server_open(&metrics_server, options.metrics, &metrics, &TvRemote))
+        {
+            exit_status = EXIT_FAILURE;
+            goto close_input;
         }
+    }
+    DispatchRecorders recorders = { .options = &options, .sm = &TvRemote, .latency = &latency, .metrics = &metrics };
+    if (options.latency || options.metrics != NULL)
+    {
+        gesture_set_callback(&gestures, record_dispatch, &recorders);
+    }
 
-        // Check if this is a key event with an event that we care about:
-        // - RELEASED_EVENT: 0
-        // - PRESSED_EVENT: 1
-        // - REPEATED_EVENT: 2
-        if (event.type == EV_KEY && event.value >= 0 && event.value <= 2)
+    // Mask the keys the active state doesn't use & time long-presses instead of waking up for key repeats.
+    PowerPolicy power;
+    if (options.power_save)
+    {
+        power_policy_init(&power, fd, &gestures);
+    }
+    PowerStats power_stats;
+    if (options.power_report)
+    {
+        power_stats_init(&power_stats, TvRemote.state_id);
+    }
+
+    printf("Starting loop.\n");
+    fflush(stdout);
+    InputLoop loop = { .options = &options, .sm = &TvRemote, .gestures = &gestures, .fd = fd, .osd = &osd,
+        .latency = &latency, .metrics = &metrics, .metrics_server = &metrics_server, .reloader = &reloader,
+        .power = &power, .power_stats = &power_stats, .signal_fd = signal_fd };
+    if (options.realtime)
+    {
+        // Map what the loop uses before it runs.
+        realtime_prefault(&TvRemote, sizeof(TvRemote));
+        realtime_prefault(&gestures, sizeof(gestures));
+        const RealtimeOptions realtime = { .priority = options.rt_priority, .cpu = options.rt_cpu, .lock_memory = options.mlock };
+        RealtimeStatus status;
+        if (!realtime_run(&realtime, run_input_loop, &loop, &status))
         {
-            switch (event.code)
-            {
-            case B1_CODE:
-            {
-                handle_button_press(event.value, &b1, &TvRemote);
-                break;
-            }
-            case B2_CODE:
-            {
-                handle_button_press(event.value, &b2, &TvRemote);
-                break;
-            }
-            default:
-                // Ignore other keys.
-                break;
-            }
+            fprintf(stderr, "Running the input loop on the main thread.\n");
+            run_input_loop(&loop);
         }
     }
-    // Flush any remaining output.
+    else
+    {
+        run_input_loop(&loop);
+    }
+    const int loop_errno = loop.error;
+    if (options.power_report)
+    {
+        power_stats_sample(&power_stats, TvRemote.state_id);
+    }
+    // Dispatch what was pressed before the stop signal & the presses still held back, then flush any
+    // remaining output & save the state the presses left.
+    const int drained = stop_requested ? drain_input(&loop) : 0;
+    const long long drained_us = timeInMicroseconds();
+    gesture_flush(&gestures);
+    if (options.osd)
+    {
+        tv_osd_update(&osd, &TvRemote.vars);
+        tv_osd_finish(&osd);
+    }
+    if (options.async_output)
+    {
+        tv_async_writer_stop(&async_writer);
+        tv_async_writer_report(&async_writer);
+    }
     fflush(stdout);
-    fprintf(stderr, "%s.\n", strerror(errno));
+    const long long flushed_us = timeInMicroseconds();
+    if (options.state != NULL && !TvRemoteSm_persist_save(&TvRemote, options.state))
+    {
+        fprintf(stderr, "Cannot save the state to %s: %s.\n", options.state, strerror(errno));
+    }
+    if (loop.stop_us != 0)
+    {
+        const long long saved_us = timeInMicroseconds();
+        fprintf(stderr, "Shut down in %.1f ms (%d events drained in %.1f ms, output flushed in %.1f ms, state saved in %.1f ms).\n",
+            (double)(saved_us - loop.stop_us) / 1000, drained, (double)(drained_us - loop.stop_us) / 1000,
+            (double)(flushed_us - drained_us) / 1000, (double)(saved_us - flushed_us) / 1000);
+    }
+    if (options.latency)
+    {
+        latency_report(&latency);
+        gesture_report(&gestures);
+    }
+    if (options.power_report)
+    {
+        power_stats_report(&power_stats);
+    }
+    if (!stop_requested)
+    {
+        fprintf(stderr, "%s.\n", strerror(loop_errno));
+    }
+
+    if (options.metrics != NULL)
+    {
+        metrics_server_close(&metrics_server);
+    }
+close_input:
+    close(fd);
+close_reloader:
+    if (options.hot_reload != NULL)
+    {
+        sm_reload_close(&reloader);
+    }
+stop_writer:
+    // The loop ran & the writer was stopped above unless opening failed.
+    if (options.async_output && exit_status == EXIT_FAILURE)
+    {
+        tv_async_writer_stop(&async_writer);
+    }
+close_signals:
+    if (options.channels != NULL)
+    {
+        channel_table_close(&channels);
+    }
+    if (signal_fd != -1)
+    {
+        close(signal_fd);
+    }
 
     // Reset the console.
     const bool ECHO_ON = false;
     console_echo(ECHO_ON);
 
     // Exit the application.
-    return EXIT_SUCCESS;
+    return exit_status;
 }
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "metrics/histogram.h"
+
+#include <string.h> // for memset
+
+#define EXACT_VALUES 16
+#define SUB_BUCKET_BITS 3
+#define SUB_BUCKETS (1 << SUB_BUCKET_BITS)
+
+static int bucket_of(const uint64_t value)
+{
+    if (value < EXACT_VALUES)
+    {
+        return (int)value;
+    }
+    const int exponent = 63 - __builtin_clzll(value);
+    const int sub_bucket = (int)((value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    return EXACT_VALUES + (exponent - 4) * SUB_BUCKETS + sub_bucket;
+}
+
+static uint64_t bucket_lower_bound(const int bucket)
+{
+    if (bucket < EXACT_VALUES)
+    {
+        return (uint64_t)bucket;
+    }
+    const int exponent = (bucket - EXACT_VALUES) / SUB_BUCKETS + 4;
+    const uint64_t sub_bucket = (uint64_t)((bucket - EXACT_VALUES) % SUB_BUCKETS);
+    return (1ULL << exponent) + (sub_bucket << (exponent - SUB_BUCKET_BITS));
+}
+
+uint64_t histogram_bucket_upper_bound(const int bucket)
+{
+    if (bucket + 1 >= HISTOGRAM_BUCKETS)
+    {
+        return UINT64_MAX;
+    }
+    return bucket_lower_bound(bucket + 1) - 1;
+}
+
+void histogram_reset(Histogram* histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+}
+
+void histogram_record(Histogram* histogram, const uint64_t value)
+{
+    histogram->counts[bucket_of(value)]++;
+    histogram->total++;
+    histogram->sum += value;
+    if (value > histogram->max)
+    {
+        histogram->max = value;
+    }
+}
+
+uint64_t histogram_percentile(const Histogram* histogram, const double percentile)
+{
+    if (histogram->total == 0)
+    {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)((percentile / 100.0) * (double)histogram->total + 0.5);
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++)
+    {
+        seen += histogram->counts[bucket];
+        if (seen >= rank)
+        {
+            // Report the bucket's upper bound, but never more than the largest sample.
+            const uint64_t upper = histogram_bucket_upper_bound(bucket);
+            return upper < histogram->max ? upper : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+void histogram_merge(Histogram* into, const Histogram* from)
+{
+    for (int bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++)
+    {
+        into->counts[bucket] += from->counts[bucket];
+    }
+    into->total += from->total;
+    into->sum += from->sum;
+    if (from->max > into->max)
+    {
+        into->max = from->max;
+    }
+}
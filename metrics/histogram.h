@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h> // for uint64_t
+
+// Log-linear histogram: exact below 16, then 8 buckets per power of two (12.5% resolution).
+// Fixed size, no allocation, cheap enough to update on every event.
+
+enum
+{
+    HISTOGRAM_BUCKETS = 496
+};
+
+typedef struct Histogram {
+    uint64_t counts[HISTOGRAM_BUCKETS];
+    uint64_t total;
+    uint64_t sum;
+    uint64_t max;
+} Histogram;
+
+void histogram_reset(Histogram* histogram);
+
+void histogram_record(Histogram* histogram, const uint64_t value);
+
+// Value below which `percentile` (0-100) of the samples fall. 0 if empty.
+uint64_t histogram_percentile(const Histogram* histogram, const double percentile);
+
+// Upper bound of the values counted in `bucket` (for exporting cumulative buckets).
+uint64_t histogram_bucket_upper_bound(const int bucket);
+
+// Add the counts of `from` to `into`.
+void histogram_merge(Histogram* into, const Histogram* from);
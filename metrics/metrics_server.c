@@ -0,0 +1,265 @@
+#include "metrics/metrics_server.h"
+
+#include <arpa/inet.h> // for htonl
+#include <errno.h> // for errno
+#include <fcntl.h> // for fcntl
+#include <stdio.h> // for fprintf
+#include <stdlib.h> // for strtoul
+#include <string.h> // for memset
+#include <sys/socket.h> // for socket
+#include <sys/stat.h> // for stat
+#include <sys/un.h> // for sockaddr_un
+#include <unistd.h> // for close
+
+// Room left in front of the body for the status line & headers.
+#define HEADER_SIZE 128
+
+static void close_client(MetricsClient* client)
+{
+    close(client->fd);
+    client->fd = -1;
+}
+
+static int free_slot(const MetricsServer* server)
+{
+    for (int i = 0; i < METRICS_MAX_CLIENTS; i++)
+    {
+        if (server->clients[i].fd == -1)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int open_unix(MetricsServer* server, const char* path)
+{
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+    // A socket left behind by a previous run, but nothing else.
+    struct stat info;
+    if (stat(path, &info) == 0 && S_ISSOCK(info.st_mode))
+    {
+        unlink(path);
+    }
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1 || bind(fd, (const struct sockaddr*)&address, sizeof(address)) == -1)
+    {
+        const int error = errno;
+        if (fd != -1)
+        {
+            close(fd);
+        }
+        errno = error;
+        return -1;
+    }
+    strcpy(server->unix_path, path);
+    return fd;
+}
+
+static int open_tcp(const char* port_text)
+{
+    char* end;
+    const unsigned long port = strtoul(port_text, &end, 10);
+    if (*port_text == '\0' || *end != '\0' || port == 0 || port > 65535)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    struct sockaddr_in address = {
+        .sin_family = AF_INET,
+        .sin_port = htons((uint16_t)port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    const int reuse = 1;
+    if (fd == -1 || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) == -1
+        || bind(fd, (const struct sockaddr*)&address, sizeof(address)) == -1)
+    {
+        const int error = errno;
+        if (fd != -1)
+        {
+            close(fd);
+        }
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
+
+bool metrics_server_open(MetricsServer* server, const char* address, const TvMetrics* metrics, const TvRemoteSm* sm)
+{
+    memset(server, 0, sizeof(*server));
+    for (int i = 0; i < METRICS_MAX_CLIENTS; i++)
+    {
+        server->clients[i].fd = -1;
+    }
+    server->metrics = metrics;
+    server->sm = sm;
+    server->listen_fd = (address[0] == '/') ? open_unix(server, address) : open_tcp(address);
+    if (server->listen_fd == -1 || listen(server->listen_fd, METRICS_MAX_CLIENTS) == -1)
+    {
+        fprintf(stderr, "Cannot listen on %s: %s.\n", address, strerror(errno));
+        metrics_server_close(server);
+        return false;
+    }
+    return true;
+}
+
+int metrics_server_poll_fds(const MetricsServer* server, struct pollfd* fds)
+{
+    int count = 0;
+    // Connections wait in the backlog while every slot is busy.
+    fds[count++] = (struct pollfd){ .fd = server->listen_fd, .events = (free_slot(server) >= 0) ? POLLIN : 0 };
+    for (int i = 0; i < METRICS_MAX_CLIENTS; i++)
+    {
+        const MetricsClient* client = &server->clients[i];
+        if (client->fd != -1)
+        {
+            fds[count++] = (struct pollfd){ .fd = client->fd, .events = (client->response_length > 0) ? POLLOUT : POLLIN };
+        }
+    }
+    return count;
+}
+
+static void accept_clients(MetricsServer* server)
+{
+    int slot;
+    while ((slot = free_slot(server)) >= 0)
+    {
+        const int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd == -1)
+        {
+            return;
+        }
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        MetricsClient* client = &server->clients[slot];
+        client->fd = fd;
+        client->request_length = 0;
+        client->response_length = 0;
+        client->response_sent = 0;
+    }
+}
+
+// Put the response for the request of `client` in its buffer.
+static void respond(MetricsServer* server, MetricsClient* client)
+{
+    const bool get = strncmp(client->request, "GET ", 4) == 0;
+    char* body = client->response + HEADER_SIZE;
+    size_t body_length = 0;
+    if (get)
+    {
+        body_length = tv_metrics_render(server->metrics, server->sm, body, sizeof(client->response) - HEADER_SIZE);
+        server->scrapes++;
+    }
+    char header[HEADER_SIZE];
+    const int header_length = snprintf(header, sizeof(header),
+        "HTTP/1.0 %s\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+        get ? "200 OK" : "405 Method Not Allowed", body_length);
+    memcpy(body - header_length, header, (size_t)header_length);
+    client->response_sent = HEADER_SIZE - (size_t)header_length;
+    client->response_length = HEADER_SIZE + body_length;
+}
+
+static void read_request(MetricsServer* server, MetricsClient* client)
+{
+    const ssize_t n = read(client->fd, client->request + client->request_length,
+        sizeof(client->request) - 1 - client->request_length);
+    if (n == -1 && (errno == EAGAIN || errno == EINTR))
+    {
+        return;
+    }
+    if (n <= 0)
+    {
+        close_client(client);
+        return;
+    }
+    client->request_length += (size_t)n;
+    client->request[client->request_length] = '\0';
+    // The headers aren't needed, only their end. A request that fills the buffer is answered as is.
+    if (strstr(client->request, "\r\n\r\n") != NULL || strstr(client->request, "\n\n") != NULL
+        || client->request_length == sizeof(client->request) - 1)
+    {
+        respond(server, client);
+    }
+}
+
+static void send_response(MetricsClient* client)
+{
+    const ssize_t n = send(client->fd, client->response + client->response_sent,
+        client->response_length - client->response_sent, MSG_NOSIGNAL);
+    if (n == -1 && (errno == EAGAIN || errno == EINTR))
+    {
+        return;
+    }
+    if (n <= 0)
+    {
+        close_client(client);
+        return;
+    }
+    client->response_sent += (size_t)n;
+    if (client->response_sent == client->response_length)
+    {
+        close_client(client);
+    }
+}
+
+void metrics_server_handle(MetricsServer* server, const struct pollfd* fds, const int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (fds[i].revents == 0)
+        {
+            continue;
+        }
+        if (fds[i].fd == server->listen_fd)
+        {
+            accept_clients(server);
+            continue;
+        }
+        for (int c = 0; c < METRICS_MAX_CLIENTS; c++)
+        {
+            MetricsClient* client = &server->clients[c];
+            if (client->fd != fds[i].fd)
+            {
+                continue;
+            }
+            if (client->response_length == 0)
+            {
+                read_request(server, client);
+            }
+            if (client->fd != -1 && client->response_length > 0)
+            {
+                send_response(client);
+            }
+            break;
+        }
+    }
+}
+
+void metrics_server_close(MetricsServer* server)
+{
+    for (int i = 0; i < METRICS_MAX_CLIENTS; i++)
+    {
+        if (server->clients[i].fd != -1)
+        {
+            close_client(&server->clients[i]);
+        }
+    }
+    if (server->listen_fd != -1)
+    {
+        close(server->listen_fd);
+    }
+    server->listen_fd = -1;
+    if (server->unix_path[0] != '\0')
+    {
+        unlink(server->unix_path);
+        server->unix_path[0] = '\0';
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <poll.h> // for pollfd
+#include <stdbool.h> // for bool
+#include <stddef.h> // for size_t
+
+#include "metrics/tv_metrics.h"
+#include "state_machine/TvRemoteSm.h"
+
+// Minimal HTTP server for the metrics, run from the main loop without a thread of its own.
+//
+// Listens on a Unix socket (an address starting with '/') or a TCP port of 127.0.0.1. Every request,
+// whatever its path, gets the counters of tv_metrics_render() & the connection is closed. The sockets
+// are non-blocking: a request that arrives in pieces or a response that doesn't fit in the socket
+// buffer is continued on the next wakeup, so a slow client never stalls key handling.
+
+#define METRICS_MAX_CLIENTS 4
+#define METRICS_REQUEST_SIZE 1024
+#define METRICS_RESPONSE_SIZE 16384
+
+// File descriptors to poll: the listening socket & the clients.
+#define METRICS_MAX_FDS (1 + METRICS_MAX_CLIENTS)
+
+typedef struct MetricsClient {
+    int fd;
+    size_t request_length;
+    char request[METRICS_REQUEST_SIZE];
+    // The response once the request is complete, & how much of it was sent.
+    size_t response_length;
+    size_t response_sent;
+    char response[METRICS_RESPONSE_SIZE];
+} MetricsClient;
+
+typedef struct MetricsServer {
+    int listen_fd;
+    // Removed when the socket is closed.
+    char unix_path[108];
+    const TvMetrics* metrics;
+    const TvRemoteSm* sm;
+    MetricsClient clients[METRICS_MAX_CLIENTS];
+    unsigned long long scrapes;
+} MetricsServer;
+
+// Listen on `address`: "/path/to/socket" or "PORT" (127.0.0.1). Errors are printed to stderr.
+bool metrics_server_open(MetricsServer* server, const char* address, const TvMetrics* metrics, const TvRemoteSm* sm);
+
+// Fill `fds` with what to poll. Returns the number of entries (at most METRICS_MAX_FDS).
+int metrics_server_poll_fds(const MetricsServer* server, struct pollfd* fds);
+
+// Accept, read & answer after poll() filled in the `revents` of the `count` entries of `fds`.
+void metrics_server_handle(MetricsServer* server, const struct pollfd* fds, const int count);
+
+void metrics_server_close(MetricsServer* server);
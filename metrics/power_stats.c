@@ -0,0 +1,83 @@
+#include "metrics/power_stats.h"
+
+#include <stdio.h> // for fprintf
+#include <string.h> // for memset
+#include <sys/resource.h> // for getrusage
+#include <time.h> // for clock_gettime
+
+#define SECONDS_TO_MICROSEC 1000000ULL
+
+static uint64_t wall_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * SECONDS_TO_MICROSEC + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static uint64_t timeval_us(const struct timeval* tv)
+{
+    return (uint64_t)tv->tv_sec * SECONDS_TO_MICROSEC + (uint64_t)tv->tv_usec;
+}
+
+// CPU time & voluntary context switches of the process so far.
+static void usage_now(uint64_t* cpu_us, uint64_t* wakeups)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    *cpu_us = timeval_us(&usage.ru_utime) + timeval_us(&usage.ru_stime);
+    *wakeups = (uint64_t)usage.ru_nvcsw;
+}
+
+void power_stats_init(PowerStats* stats, const int state_id)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->state_id = state_id;
+    stats->last_wall_us = wall_now_us();
+    usage_now(&stats->last_cpu_us, &stats->last_wakeups);
+}
+
+void power_stats_sample(PowerStats* stats, const int state_id)
+{
+    const uint64_t wall_us = wall_now_us();
+    uint64_t cpu_us;
+    uint64_t wakeups;
+    usage_now(&cpu_us, &wakeups);
+    if (stats->state_id >= 0 && stats->state_id < TvRemoteSm_StateIdCount)
+    {
+        stats->wall_us[stats->state_id] += wall_us - stats->last_wall_us;
+        stats->cpu_us[stats->state_id] += cpu_us - stats->last_cpu_us;
+        stats->wakeups[stats->state_id] += wakeups - stats->last_wakeups;
+    }
+    stats->state_id = state_id;
+    stats->last_wall_us = wall_us;
+    stats->last_cpu_us = cpu_us;
+    stats->last_wakeups = wakeups;
+}
+
+void power_stats_report(const PowerStats* stats)
+{
+    fprintf(stderr, "%-24s %10s %10s %11s %10s %7s\n", "state", "seconds", "wakeups", "wakeups/s", "CPU ms", "CPU %");
+    uint64_t total_wall = 0;
+    uint64_t total_cpu = 0;
+    uint64_t total_wakeups = 0;
+    for (int i = 0; i < TvRemoteSm_StateIdCount; i++)
+    {
+        if (stats->wall_us[i] == 0)
+        {
+            continue;
+        }
+        const double seconds = (double)stats->wall_us[i] / SECONDS_TO_MICROSEC;
+        fprintf(stderr, "%-24s %10.3f %10llu %11.2f %10.3f %7.3f\n", TvRemoteSm_state_id_to_string((TvRemoteSm_StateId)i),
+            seconds, (unsigned long long)stats->wakeups[i], (double)stats->wakeups[i] / seconds,
+            (double)stats->cpu_us[i] / 1000.0, 100.0 * (double)stats->cpu_us[i] / (double)stats->wall_us[i]);
+        total_wall += stats->wall_us[i];
+        total_cpu += stats->cpu_us[i];
+        total_wakeups += stats->wakeups[i];
+    }
+    if (total_wall > 0)
+    {
+        const double seconds = (double)total_wall / SECONDS_TO_MICROSEC;
+        fprintf(stderr, "%-24s %10.3f %10llu %11.2f %10.3f %7.3f\n", "total", seconds, (unsigned long long)total_wakeups,
+            (double)total_wakeups / seconds, (double)total_cpu / 1000.0, 100.0 * (double)total_cpu / (double)total_wall);
+    }
+}
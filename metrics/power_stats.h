@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h> // for uint64_t
+
+#include "state_machine/TvRemoteSm.h"
+
+// Wakeups & CPU time per state, to compare input policies.
+//
+// A wakeup is a voluntary context switch of the process: it blocked (in poll() or read()) & was woken
+// up. The wall time, CPU time (user + system) & wakeups between two samples are charged to the state
+// that was active since the first one.
+
+typedef struct PowerStats {
+    uint64_t wall_us[TvRemoteSm_StateIdCount];
+    uint64_t cpu_us[TvRemoteSm_StateIdCount];
+    uint64_t wakeups[TvRemoteSm_StateIdCount];
+    // The previous sample.
+    int state_id;
+    uint64_t last_wall_us;
+    uint64_t last_cpu_us;
+    uint64_t last_wakeups;
+} PowerStats;
+
+// Start counting in `state_id`.
+void power_stats_init(PowerStats* stats, const int state_id);
+
+// Charge everything since the previous sample to the state that was active, then switch to `state_id`.
+void power_stats_sample(PowerStats* stats, const int state_id);
+
+// Print the time, wakeups/s & CPU share per state to stderr.
+void power_stats_report(const PowerStats* stats);
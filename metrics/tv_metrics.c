@@ -0,0 +1,129 @@
+#include "metrics/tv_metrics.h"
+
+#include <stdarg.h> // for va_list
+#include <stdio.h> // for vsnprintf
+#include <string.h> // for memset
+
+// Histogram buckets exported: le = 2^k - 1 us from 15 us to 16.8 s, which are bucket bounds of the
+// log-linear histogram so the cumulative counts are exact.
+#define EXPORT_FIRST_EXPONENT 4
+#define EXPORT_LAST_EXPONENT 24
+
+void tv_metrics_init(TvMetrics* metrics, const TvRemoteSm* sm)
+{
+    memset(metrics, 0, sizeof(*metrics));
+    metrics->counters.last_state_id = sm->state_id;
+    histogram_reset(&metrics->dispatch_latency);
+}
+
+void tv_metrics_dispatched(TvMetrics* metrics, const TvRemoteSm* sm, const int event_id, const uint64_t latency_us)
+{
+    TvMetricsCounters* counters = &metrics->counters;
+    if (event_id < 0 || event_id >= TvRemoteSm_EventIdCount)
+    {
+        return;
+    }
+    counters->events[event_id]++;
+    if (event_id == TvRemoteSm_EventId_B1_LONG_PRESS || event_id == TvRemoteSm_EventId_B2_LONG_PRESS)
+    {
+        counters->long_presses++;
+    }
+    else if (event_id == TvRemoteSm_EventId_B1_PRESS || event_id == TvRemoteSm_EventId_B2_PRESS)
+    {
+        counters->short_presses++;
+    }
+    if (sm->state_id != counters->last_state_id)
+    {
+        counters->state_changes[sm->state_id]++;
+        counters->last_state_id = sm->state_id;
+    }
+    histogram_record(&metrics->dispatch_latency, latency_us);
+}
+
+void tv_metrics_input_dropped(TvMetrics* metrics)
+{
+    metrics->counters.dropped_inputs++;
+}
+
+typedef struct Writer {
+    char* buffer;
+    size_t size;
+    size_t length;
+} Writer;
+
+__attribute__((format(printf, 2, 3)))
+static void append(Writer* writer, const char* format, ...)
+{
+    if (writer->length >= writer->size)
+    {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    const int n = vsnprintf(writer->buffer + writer->length, writer->size - writer->length, format, args);
+    va_end(args);
+    writer->length = (n < 0) ? writer->size : writer->length + (size_t)n;
+}
+
+static void header(Writer* writer, const char* name, const char* type, const char* help)
+{
+    append(writer, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+size_t tv_metrics_render(const TvMetrics* metrics, const TvRemoteSm* sm, char* buffer, const size_t size)
+{
+    const TvMetricsCounters* counters = &metrics->counters;
+    Writer writer = { .buffer = buffer, .size = size, .length = 0 };
+
+    header(&writer, "tvremote_events_total", "counter", "State machine events dispatched.");
+    for (int i = 0; i < TvRemoteSm_EventIdCount; i++)
+    {
+        append(&writer, "tvremote_events_total{event=\"%s\"} %llu\n", TvRemoteSm_event_id_to_string((TvRemoteSm_EventId)i),
+            (unsigned long long)counters->events[i]);
+    }
+    header(&writer, "tvremote_state_changes_total", "counter", "Dispatches that changed the active state, per state entered (not self-transitions).");
+    for (int i = 0; i < TvRemoteSm_StateIdCount; i++)
+    {
+        append(&writer, "tvremote_state_changes_total{state=\"%s\"} %llu\n", TvRemoteSm_state_id_to_string((TvRemoteSm_StateId)i),
+            (unsigned long long)counters->state_changes[i]);
+    }
+    header(&writer, "tvremote_presses_total", "counter", "Single presses & long-presses of B1 & B2 dispatched.");
+    append(&writer, "tvremote_presses_total{kind=\"short\"} %llu\n", (unsigned long long)counters->short_presses);
+    append(&writer, "tvremote_presses_total{kind=\"long\"} %llu\n", (unsigned long long)counters->long_presses);
+    header(&writer, "tvremote_input_dropped_total", "counter", "Times the kernel dropped input events that weren't read in time.");
+    append(&writer, "tvremote_input_dropped_total %llu\n", (unsigned long long)counters->dropped_inputs);
+
+    const Histogram* latency = &metrics->dispatch_latency;
+    header(&writer, "tvremote_dispatch_latency_seconds", "histogram", "Key event timestamp to the dispatch returning.");
+    uint64_t cumulative = 0;
+    int bucket = 0;
+    for (int exponent = EXPORT_FIRST_EXPONENT; exponent <= EXPORT_LAST_EXPONENT; exponent++)
+    {
+        const uint64_t bound = (1ULL << exponent) - 1;
+        for (; bucket < HISTOGRAM_BUCKETS && histogram_bucket_upper_bound(bucket) <= bound; bucket++)
+        {
+            cumulative += latency->counts[bucket];
+        }
+        append(&writer, "tvremote_dispatch_latency_seconds_bucket{le=\"%.9g\"} %llu\n", (double)bound / 1e6,
+            (unsigned long long)cumulative);
+    }
+    append(&writer, "tvremote_dispatch_latency_seconds_bucket{le=\"+Inf\"} %llu\n", (unsigned long long)latency->total);
+    append(&writer, "tvremote_dispatch_latency_seconds_sum %g\n", (double)latency->sum / 1e6);
+    append(&writer, "tvremote_dispatch_latency_seconds_count %llu\n", (unsigned long long)latency->total);
+
+    header(&writer, "tvremote_state", "gauge", "1 for the active state.");
+    for (int i = 0; i < TvRemoteSm_StateIdCount; i++)
+    {
+        append(&writer, "tvremote_state{state=\"%s\"} %d\n", TvRemoteSm_state_id_to_string((TvRemoteSm_StateId)i),
+            sm->state_id == (TvRemoteSm_StateId)i);
+    }
+    header(&writer, "tvremote_volume", "gauge", "Current volume.");
+    append(&writer, "tvremote_volume %d\n", sm->vars.volume);
+    header(&writer, "tvremote_brightness", "gauge", "Current brightness.");
+    append(&writer, "tvremote_brightness %d\n", sm->vars.brightness);
+    header(&writer, "tvremote_channel", "gauge", "Current channel.");
+    append(&writer, "tvremote_channel %d\n", sm->vars.channel);
+    header(&writer, "tvremote_channel_entry", "gauge", "Number typed so far in channel entry.");
+    append(&writer, "tvremote_channel_entry %d\n", sm->vars.channel_entry);
+    return writer.length < size ? writer.length : size;
+}
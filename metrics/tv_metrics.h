@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stddef.h> // for size_t
+#include <stdint.h> // for uint64_t
+
+#include "metrics/histogram.h"
+#include "state_machine/TvRemoteSm.h"
+
+// Counters of the remote for the metrics endpoint (see metrics_server.h), in the Prometheus text format.
+//
+// Only the thread of the main loop updates them, so they are plain integers; they sit on their own
+// cache lines so the writes on the hot path never share a line with data of another thread (e.g. the
+// queue indexes of the async writer).
+
+#define TV_METRICS_CACHE_LINE 64
+
+typedef struct TvMetricsCounters {
+    // Events dispatched per TvRemoteSm_EventId.
+    uint64_t events[TvRemoteSm_EventIdCount];
+    // Dispatches that changed the active state, per state entered. Self-transitions & internal
+    // transitions aren't counted.
+    uint64_t state_changes[TvRemoteSm_StateIdCount];
+    uint64_t short_presses;
+    uint64_t long_presses;
+    // SYN_DROPPED reports: the kernel dropped input events because they weren't read in time.
+    uint64_t dropped_inputs;
+    // The active state after the previous dispatch.
+    int last_state_id;
+} TvMetricsCounters;
+
+typedef struct TvMetrics {
+    _Alignas(TV_METRICS_CACHE_LINE) TvMetricsCounters counters;
+    // Key event timestamp to dispatch returning, in us.
+    _Alignas(TV_METRICS_CACHE_LINE) Histogram dispatch_latency;
+} TvMetrics;
+
+void tv_metrics_init(TvMetrics* metrics, const TvRemoteSm* sm);
+
+// Count `event_id` just dispatched to `sm`, `latency_us` after the key event.
+void tv_metrics_dispatched(TvMetrics* metrics, const TvRemoteSm* sm, const int event_id, const uint64_t latency_us);
+
+// Count a SYN_DROPPED report of the input device.
+void tv_metrics_input_dropped(TvMetrics* metrics);
+
+// Write the counters & the current vars of `sm` to `buffer` in the Prometheus text format.
+// Returns the length, or `size` if it didn't fit.
+size_t tv_metrics_render(const TvMetrics* metrics, const TvRemoteSm* sm, char* buffer, const size_t size);
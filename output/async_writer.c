@@ -0,0 +1,287 @@
+#include "output/async_writer.h"
+
+#include <stdint.h> // for uint64_t
+#include <stdio.h> // for snprintf
+#include <stdlib.h> // for calloc
+#include <string.h> // for strncpy
+#include <sys/eventfd.h> // for eventfd
+#include <time.h> // for nanosleep
+#include <unistd.h> // for write
+
+#define PENDING_BIT (1u << 16)
+
+// Messages formatted into one write() by the writer thread.
+#define WRITE_BATCH 64
+#define WRITE_BUFFER_SIZE (WRITE_BATCH * (TV_ASYNC_TEXT_SIZE + 2))
+
+static bool try_enqueue(TvAsyncWriter* writer, const TvAsyncMessage* message)
+{
+    size_t position = atomic_load_explicit(&writer->enqueue_position, memory_order_relaxed);
+    for (;;)
+    {
+        TvAsyncSlot* slot = &writer->slots[position & writer->mask];
+        const size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        const intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&writer->enqueue_position, &position, position + 1, memory_order_relaxed, memory_order_relaxed))
+            {
+                slot->message = *message;
+                atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            // Full.
+            return false;
+        }
+        else
+        {
+            position = atomic_load_explicit(&writer->enqueue_position, memory_order_relaxed);
+        }
+    }
+}
+
+static bool try_dequeue(TvAsyncWriter* writer, TvAsyncMessage* message)
+{
+    size_t position = atomic_load_explicit(&writer->dequeue_position, memory_order_relaxed);
+    for (;;)
+    {
+        TvAsyncSlot* slot = &writer->slots[position & writer->mask];
+        const size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        const intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&writer->dequeue_position, &position, position + 1, memory_order_relaxed, memory_order_relaxed))
+            {
+                *message = slot->message;
+                atomic_store_explicit(&slot->sequence, position + writer->mask + 1, memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            // Empty.
+            return false;
+        }
+        else
+        {
+            position = atomic_load_explicit(&writer->dequeue_position, memory_order_relaxed);
+        }
+    }
+}
+
+static void wake_writer(TvAsyncWriter* writer)
+{
+    // Orders the publish of the message before the load of `sleeping` (StoreLoad, which x86 reorders
+    // too): either the writer sees the message when it checks again, or this sees it sleeping.
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(&writer->sleeping))
+    {
+        const uint64_t one = 1;
+        (void)!write(writer->wake_fd, &one, sizeof(one));
+    }
+}
+
+// Queue a message from the input loop. Never blocks.
+static void post(TvAsyncWriter* writer, const TvAsyncMessage* message)
+{
+    atomic_fetch_add_explicit(&writer->queued, 1, memory_order_relaxed);
+    const bool coalesce = writer->policy == TV_ASYNC_COALESCE && message->is_value;
+    while (!try_enqueue(writer, message))
+    {
+        if (coalesce)
+        {
+            // Keep only the newest value of the field; the writer prints it once the ring drains.
+            const unsigned int previous = atomic_exchange(&writer->pending_values[message->field], PENDING_BIT | message->value);
+            if (previous & PENDING_BIT)
+            {
+                atomic_fetch_add_explicit(&writer->coalesced, 1, memory_order_relaxed);
+            }
+            wake_writer(writer);
+            return;
+        }
+
+        // Make room by dropping the oldest message.
+        TvAsyncMessage oldest;
+        if (try_dequeue(writer, &oldest))
+        {
+            atomic_fetch_add_explicit(&writer->dropped, 1, memory_order_relaxed);
+        }
+    }
+    if (coalesce && (atomic_exchange(&writer->pending_values[message->field], 0) & PENDING_BIT))
+    {
+        // The pending value is older than the one just queued.
+        atomic_fetch_add_explicit(&writer->coalesced, 1, memory_order_relaxed);
+    }
+    wake_writer(writer);
+}
+
+static void async_show(void* ctx, const char* message)
+{
+    TvAsyncMessage queued = {
+        .is_value = false
+    };
+    strncpy(queued.text, message, TV_ASYNC_TEXT_SIZE - 1);
+    post(ctx, &queued);
+}
+
+static void async_value(void* ctx, TvOutputField field, unsigned short value)
+{
+    const TvAsyncMessage queued = {
+        .is_value = true,
+        .field = field,
+        .value = value
+    };
+    post(ctx, &queued);
+}
+
+static size_t format_message(char* buffer, const size_t size, const TvAsyncMessage* message)
+{
+    const int n = message->is_value
+        ? snprintf(buffer, size, "%d\n", message->value)
+        : snprintf(buffer, size, "%s\n", message->text);
+    return (n > 0 && (size_t)n < size) ? (size_t)n : 0;
+}
+
+static void write_all(TvAsyncWriter* writer, const char* buffer, const size_t length)
+{
+    size_t done = 0;
+    while (done < length)
+    {
+        const ssize_t n = write(writer->out_fd, &buffer[done], length - done);
+        if (n <= 0)
+        {
+            break;
+        }
+        done += (size_t)n;
+    }
+    if (writer->throttle_us > 0)
+    {
+        const struct timespec delay = {
+            .tv_sec = writer->throttle_us / 1000000,
+            .tv_nsec = (long)(writer->throttle_us % 1000000) * 1000
+        };
+        nanosleep(&delay, NULL);
+    }
+}
+
+// Write queued messages (then coalesced values) in batches. Returns true if anything was written.
+static bool drain(TvAsyncWriter* writer)
+{
+    char buffer[WRITE_BUFFER_SIZE];
+    bool wrote = false;
+    TvAsyncMessage message;
+
+    for (;;)
+    {
+        size_t length = 0;
+        int count = 0;
+        while (count < WRITE_BATCH && try_dequeue(writer, &message))
+        {
+            length += format_message(&buffer[length], sizeof(buffer) - length, &message);
+            count++;
+        }
+        for (int field = 0; count < WRITE_BATCH && field < TV_OUTPUT_FIELD_COUNT; field++)
+        {
+            const unsigned int pending = atomic_exchange(&writer->pending_values[field], 0);
+            if (pending & PENDING_BIT)
+            {
+                message.is_value = true;
+                message.value = (unsigned short)(pending & 0xffff);
+                length += format_message(&buffer[length], sizeof(buffer) - length, &message);
+                count++;
+            }
+        }
+        if (count == 0)
+        {
+            return wrote;
+        }
+        write_all(writer, buffer, length);
+        atomic_fetch_add_explicit(&writer->written, (unsigned long long)count, memory_order_relaxed);
+        wrote = true;
+    }
+}
+
+static void* writer_thread(void* arg)
+{
+    TvAsyncWriter* writer = arg;
+    while (!atomic_load(&writer->stopping))
+    {
+        if (drain(writer))
+        {
+            continue;
+        }
+        // Announce the sleep, then check again so a message posted in between isn't missed.
+        atomic_store(&writer->sleeping, true);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (!drain(writer) && !atomic_load(&writer->stopping))
+        {
+            uint64_t count;
+            (void)!read(writer->wake_fd, &count, sizeof(count));
+        }
+        atomic_store(&writer->sleeping, false);
+    }
+    drain(writer);
+    return NULL;
+}
+
+bool tv_async_writer_start(TvAsyncWriter* writer, const size_t capacity, const TvAsyncPolicy policy, const int out_fd, const unsigned int throttle_us)
+{
+    size_t size = 2;
+    while (size < capacity)
+    {
+        size *= 2;
+    }
+
+    memset(writer, 0, sizeof(*writer));
+    writer->sink.show = async_show;
+    writer->sink.value = async_value;
+    writer->sink.ctx = writer;
+    writer->policy = policy;
+    writer->out_fd = out_fd;
+    writer->throttle_us = throttle_us;
+    writer->mask = size - 1;
+    writer->slots = calloc(size, sizeof(TvAsyncSlot));
+    if (writer->slots == NULL)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < size; i++)
+    {
+        atomic_init(&writer->slots[i].sequence, i);
+    }
+
+    writer->wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (writer->wake_fd == -1)
+    {
+        free(writer->slots);
+        return false;
+    }
+    if (pthread_create(&writer->thread, NULL, writer_thread, writer) != 0)
+    {
+        close(writer->wake_fd);
+        free(writer->slots);
+        return false;
+    }
+    return true;
+}
+
+void tv_async_writer_stop(TvAsyncWriter* writer)
+{
+    atomic_store(&writer->stopping, true);
+    const uint64_t one = 1;
+    (void)!write(writer->wake_fd, &one, sizeof(one));
+    pthread_join(writer->thread, NULL);
+    close(writer->wake_fd);
+    free(writer->slots);
+    writer->slots = NULL;
+}
+
+void tv_async_writer_report(TvAsyncWriter* writer)
+{
+    fprintf(stderr, "Async output: %llu queued, %llu written, %llu dropped, %llu coalesced.\n",
+        atomic_load(&writer->queued), atomic_load(&writer->written),
+        atomic_load(&writer->dropped), atomic_load(&writer->coalesced));
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <pthread.h> // for pthread_t
+#include <stdatomic.h> // for atomic_size_t
+#include <stdbool.h> // for bool
+
+#include "output/tv_output.h"
+
+// Moves the state machine output off the input loop.
+//
+// The output actions are queued in a bounded lock-free ring and written by a dedicated thread,
+// so a slow terminal or blocked pipe never stalls key handling. Queueing never blocks: when the
+// ring is full the oldest message is dropped, or (coalesce policy) value updates collapse into
+// the latest value per field.
+
+typedef enum TvAsyncPolicy
+{
+    TV_ASYNC_DROP_OLDEST = 0,
+    TV_ASYNC_COALESCE = 1,
+} TvAsyncPolicy;
+
+enum
+{
+    TV_ASYNC_TEXT_SIZE = 32
+};
+
+typedef struct TvAsyncMessage {
+    bool is_value;
+    TvOutputField field;
+    unsigned short value;
+    char text[TV_ASYNC_TEXT_SIZE];
+} TvAsyncMessage;
+
+typedef struct TvAsyncSlot {
+    atomic_size_t sequence;
+    TvAsyncMessage message;
+} TvAsyncSlot;
+
+typedef struct TvAsyncWriter {
+    // Sink to put in `TvRemoteSm_Vars.output`.
+    TvOutputSink sink;
+    TvAsyncPolicy policy;
+
+    // Ring buffer (bounded MPMC queue, the input loop & the writer thread both dequeue).
+    TvAsyncSlot* slots;
+    size_t mask;
+    _Alignas(64) atomic_size_t enqueue_position;
+    _Alignas(64) atomic_size_t dequeue_position;
+
+    // Latest value per field that didn't fit in the ring (coalesce policy). Bit 16 marks it as pending.
+    atomic_uint pending_values[TV_OUTPUT_FIELD_COUNT];
+
+    // Writer thread.
+    pthread_t thread;
+    int wake_fd;
+    atomic_bool sleeping;
+    atomic_bool stopping;
+    int out_fd;
+    unsigned int throttle_us;
+
+    // Statistics.
+    atomic_ullong queued;
+    atomic_ullong written;
+    atomic_ullong dropped;
+    atomic_ullong coalesced;
+} TvAsyncWriter;
+
+// Start the writer thread. `capacity` is rounded up to a power of two. Messages are written to `out_fd`.
+// `throttle_us` sleeps after every write to simulate a slow terminal (0 for none).
+// Returns false on failure.
+bool tv_async_writer_start(TvAsyncWriter* writer, const size_t capacity, const TvAsyncPolicy policy, const int out_fd, const unsigned int throttle_us);
+
+// Write everything still queued, stop the thread & free the ring.
+void tv_async_writer_stop(TvAsyncWriter* writer);
+
+// Print the counters to stderr.
+void tv_async_writer_report(TvAsyncWriter* writer);
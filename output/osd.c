@@ -0,0 +1,241 @@
+#include "output/osd.h"
+
+#include <stdio.h> // for snprintf
+#include <string.h> // for strcmp
+#include <unistd.h> // for write
+
+// Size of the escape sequences + text of one frame.
+#define FRAME_BUFFER_SIZE 1024
+
+static const char* const LABELS[TV_OSD_FIELD_COUNT] = {
+    "Power:      ",
+    "Mode:       ",
+    "Volume:     ",
+    "Channel:    ",
+    "Brightness: ",
+};
+
+// Column where the values start (the labels all have the same width).
+#define VALUE_COLUMN 12
+
+static void set_field(TvOsd* osd, const TvOsdField field, const char* value)
+{
+    osd->updates++;
+    if (strcmp(osd->values[field], value) == 0)
+    {
+        return;
+    }
+    snprintf(osd->values[field], TV_OSD_VALUE_SIZE, "%s", value);
+    osd->dirty |= 1u << field;
+}
+
+static void set_number(TvOsd* osd, const TvOsdField field, const unsigned short value)
+{
+    char text[TV_OSD_VALUE_SIZE];
+    snprintf(text, sizeof(text), "%d", value);
+    set_field(osd, field, text);
+}
+
+// The channel number & its name from the lineup, if it has one.
+static void set_channel(TvOsd* osd, const unsigned short channel)
+{
+    const char* name = channel_table_name(osd->channels, channel);
+    char text[TV_OSD_VALUE_SIZE];
+    snprintf(text, sizeof(text), (name[0] != '\0') ? "%d %s" : "%d", channel, name);
+    set_field(osd, TV_OSD_CHANNEL, text);
+}
+
+// The number typed in channel entry goes in the mode field, so the channel keeps showing the tuned one.
+static void set_entry(TvOsd* osd, const unsigned short value)
+{
+    char text[TV_OSD_VALUE_SIZE];
+    snprintf(text, sizeof(text), "Channel Entry %d", value);
+    set_field(osd, TV_OSD_MODE, text);
+}
+
+// Output action `show()`: the state enter messages carry the power & mode.
+static void osd_show(void* ctx, const char* message)
+{
+    TvOsd* osd = ctx;
+    if (strcmp(message, "TV ON") == 0)
+    {
+        set_field(osd, TV_OSD_POWER, "ON");
+    }
+    else if (strcmp(message, "TV OFF") == 0)
+    {
+        set_field(osd, TV_OSD_POWER, "OFF");
+        set_field(osd, TV_OSD_MODE, "-");
+    }
+    else if (strcmp(message, "Volume Change") == 0)
+    {
+        set_field(osd, TV_OSD_MODE, "Volume");
+    }
+    else if (strcmp(message, "Channel Select") == 0)
+    {
+        set_field(osd, TV_OSD_MODE, "Channel");
+    }
+    else if (strcmp(message, "Channel Entry") == 0)
+    {
+        set_field(osd, TV_OSD_MODE, "Channel Entry");
+    }
+    else if (strcmp(message, "Brightness Change") == 0)
+    {
+        set_field(osd, TV_OSD_MODE, "Brightness");
+    }
+    // "Volume Up" etc. are followed by the new value.
+}
+
+// Output action `print_*()`. The volume, brightness & channel are taken from the vars instead.
+static void osd_value(void* ctx, TvOutputField field, unsigned short value)
+{
+    TvOsd* osd = ctx;
+    if (field == TV_OUTPUT_CHANNEL_ENTRY)
+    {
+        set_entry(osd, value);
+    }
+}
+
+void tv_osd_init(TvOsd* osd, const unsigned int max_fps, const int fd)
+{
+    memset(osd, 0, sizeof(*osd));
+    osd->sink.show = osd_show;
+    osd->sink.value = osd_value;
+    osd->sink.ctx = osd;
+    osd->fd = fd;
+    osd->frame_interval_ms = (max_fps > 0) ? 1000 / max_fps : 0;
+    osd->last_frame_time = -osd->frame_interval_ms;
+
+    set_field(osd, TV_OSD_POWER, "OFF");
+    set_field(osd, TV_OSD_MODE, "-");
+}
+
+void tv_osd_set_channel_table(TvOsd* osd, const ChannelTable* channels)
+{
+    osd->channels = channels;
+}
+
+void tv_osd_update(TvOsd* osd, const TvRemoteSm_Vars* vars)
+{
+    if (vars->changed & TV_CHANGED_VOLUME)
+    {
+        set_number(osd, TV_OSD_VOLUME, vars->volume);
+    }
+    if (vars->changed & TV_CHANGED_BRIGHTNESS)
+    {
+        set_number(osd, TV_OSD_BRIGHTNESS, vars->brightness);
+    }
+    if (vars->changed & TV_CHANGED_CHANNEL)
+    {
+        set_channel(osd, vars->channel);
+    }
+}
+
+// Append to the frame buffer. Returns the new length.
+static size_t append(char* buffer, size_t length, const char* text)
+{
+    const int n = snprintf(&buffer[length], FRAME_BUFFER_SIZE - length, "%s", text);
+    return (n > 0 && length + (size_t)n < FRAME_BUFFER_SIZE) ? length + (size_t)n : length;
+}
+
+static void write_frame(TvOsd* osd, const char* buffer, const size_t length)
+{
+    size_t written = 0;
+    while (written < length)
+    {
+        const ssize_t n = write(osd->fd, &buffer[written], length - written);
+        if (n <= 0)
+        {
+            break;
+        }
+        written += (size_t)n;
+    }
+    osd->bytes_written += written;
+}
+
+// Draw the changed fields. The cursor rests on the line below the display between frames.
+static void draw_frame(TvOsd* osd)
+{
+    char buffer[FRAME_BUFFER_SIZE];
+    char sequence[64];
+    size_t length = 0;
+
+    if (!osd->first_frame_drawn)
+    {
+        // Lay out every line once.
+        for (int field = 0; field < TV_OSD_FIELD_COUNT; field++)
+        {
+            length = append(buffer, length, LABELS[field]);
+            length = append(buffer, length, osd->values[field]);
+            length = append(buffer, length, "\n");
+            memcpy(osd->drawn[field], osd->values[field], TV_OSD_VALUE_SIZE);
+        }
+        osd->first_frame_drawn = true;
+    }
+    else
+    {
+        for (int field = 0; field < TV_OSD_FIELD_COUNT; field++)
+        {
+            if (!(osd->dirty & (1u << field)))
+            {
+                continue;
+            }
+
+            // Only rewrite from the first character that differs.
+            const char* old_value = osd->drawn[field];
+            const char* new_value = osd->values[field];
+            size_t same = 0;
+            while (old_value[same] != '\0' && old_value[same] == new_value[same])
+            {
+                same++;
+            }
+            if (old_value[same] == '\0' && new_value[same] == '\0')
+            {
+                continue;
+            }
+
+            // Up to the field's line, to the first changed column, the new text, clear the rest, back down.
+            const int lines_up = TV_OSD_FIELD_COUNT - field;
+            snprintf(sequence, sizeof(sequence), "\x1b[%dA\x1b[%zuG", lines_up, VALUE_COLUMN + same + 1);
+            length = append(buffer, length, sequence);
+            length = append(buffer, length, &new_value[same]);
+            if (strlen(new_value) < strlen(old_value))
+            {
+                length = append(buffer, length, "\x1b[K");
+            }
+            snprintf(sequence, sizeof(sequence), "\x1b[%dB\r", lines_up);
+            length = append(buffer, length, sequence);
+            memcpy(osd->drawn[field], new_value, TV_OSD_VALUE_SIZE);
+        }
+    }
+    osd->dirty = 0;
+
+    if (length > 0)
+    {
+        write_frame(osd, buffer, length);
+        osd->frames++;
+    }
+}
+
+int tv_osd_flush(TvOsd* osd, const long long now)
+{
+    if (osd->dirty == 0 && osd->first_frame_drawn)
+    {
+        return -1;
+    }
+    const long long wait = osd->last_frame_time + osd->frame_interval_ms - now;
+    if (wait > 0)
+    {
+        return (int)wait;
+    }
+    draw_frame(osd);
+    osd->last_frame_time = now;
+    return -1;
+}
+
+void tv_osd_finish(TvOsd* osd)
+{
+    if (osd->dirty != 0 || !osd->first_frame_drawn)
+    {
+        draw_frame(osd);
+    }
+}
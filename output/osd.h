@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdbool.h> // for bool
+
+#include "channels/channel_table.h"
+#include "output/tv_output.h"
+#include "state_machine/TvRemoteSm.h"
+
+// Terminal on-screen display: one status line per field, redrawn in place.
+//
+// Installed as the state machine's output sink. The output actions only update the power & mode of
+// the model, the volume, brightness & channel come from the vars the dispatches changed
+// (`tv_osd_update()`), so a dispatch that leaves them as they were costs nothing.
+// `tv_osd_flush()` draws at most one frame per interval and only rewrites the characters of the
+// fields that changed since the last frame, so bursts of key presses are coalesced.
+
+typedef enum TvOsdField
+{
+    TV_OSD_POWER = 0,
+    TV_OSD_MODE = 1,
+    TV_OSD_VOLUME = 2,
+    TV_OSD_CHANNEL = 3,
+    TV_OSD_BRIGHTNESS = 4,
+} TvOsdField;
+
+enum
+{
+    TV_OSD_FIELD_COUNT = 5,
+    TV_OSD_VALUE_SIZE = 24
+};
+
+typedef struct TvOsd {
+    // Sink to put in `TvRemoteSm_Vars.output`.
+    TvOutputSink sink;
+    // Field values of the model & what is on screen.
+    char values[TV_OSD_FIELD_COUNT][TV_OSD_VALUE_SIZE];
+    char drawn[TV_OSD_FIELD_COUNT][TV_OSD_VALUE_SIZE];
+    // Fields changed since the last frame.
+    unsigned int dirty;
+    bool first_frame_drawn;
+    // Minimum time between frames.
+    long long frame_interval_ms;
+    long long last_frame_time;
+    // Where frames are written.
+    int fd;
+    // Shows the channel names next to the numbers. NULL shows the numbers only.
+    const ChannelTable* channels;
+    // Statistics.
+    unsigned long long updates;
+    unsigned long long frames;
+    unsigned long long bytes_written;
+} TvOsd;
+
+// Set up the display. `max_fps` caps the frame rate. Frames are written to `fd`.
+void tv_osd_init(TvOsd* osd, const unsigned int max_fps, const int fd);
+
+// Show the names of `channels` next to the channel numbers.
+void tv_osd_set_channel_table(TvOsd* osd, const ChannelTable* channels);
+
+// Set the volume, brightness & channel fields whose TV_CHANGED_* bit is set in `vars->changed`.
+// Call after the dispatches & before the mask is cleared (and once after `TvRemoteSm_start()`).
+void tv_osd_update(TvOsd* osd, const TvRemoteSm_Vars* vars);
+
+// Draw a frame if fields changed and the frame interval has passed. `now` is in ms.
+// Returns the ms to wait before a pending frame can be drawn, or -1 if nothing is pending.
+int tv_osd_flush(TvOsd* osd, const long long now);
+
+// Draw any pending changes immediately and leave the cursor below the display.
+void tv_osd_finish(TvOsd* osd);
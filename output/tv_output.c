@@ -0,0 +1,122 @@
+#include "output/tv_output.h"
+
+#ifdef TVREMOTE_EMBEDDED
+#include <string.h> // for strlen
+#include <sys/uio.h> // for writev
+#include <unistd.h> // for STDOUT_FILENO
+#else
+#include <stdio.h> // for printf
+#endif
+
+#ifdef TVREMOTE_EMBEDDED
+static void write_line(const char* text, const size_t length)
+{
+    struct iovec parts[2] = {
+        { .iov_base = (void*)text, .iov_len = length },
+        { .iov_base = "\n", .iov_len = 1 },
+    };
+    // Nothing to do about a failed write, as with printf().
+    (void)writev(STDOUT_FILENO, parts, 2);
+}
+
+static void stdout_show(void* ctx, const char* message)
+{
+    (void)ctx;
+    write_line(message, strlen(message));
+}
+
+static void stdout_value(void* ctx, TvOutputField field, unsigned short value)
+{
+    (void)ctx;
+    (void)field;
+    char text[TV_OUTPUT_VALUE_SIZE];
+    write_line(text, (size_t)tv_output_format_value(text, value));
+}
+#else
+static void stdout_show(void* ctx, const char* message)
+{
+    (void)ctx;
+    printf("%s\n", message);
+}
+
+static void stdout_value(void* ctx, TvOutputField field, unsigned short value)
+{
+    (void)ctx;
+    (void)field;
+    printf("%d\n", value);
+}
+#endif
+
+static void null_show(void* ctx, const char* message)
+{
+    (void)ctx;
+    (void)message;
+}
+
+static void null_value(void* ctx, TvOutputField field, unsigned short value)
+{
+    (void)ctx;
+    (void)field;
+    (void)value;
+}
+
+const TvOutputSink tv_output_null_sink = {
+    .show = null_show,
+    .value = null_value,
+    .ctx = NULL
+};
+
+const TvOutputSink tv_output_stdout_sink = {
+    .show = stdout_show,
+    .value = stdout_value,
+    .ctx = NULL
+};
+
+void tv_output_show(const TvOutputSink* sink, const char* message)
+{
+    if (sink == NULL)
+    {
+        sink = &tv_output_stdout_sink;
+    }
+    sink->show(sink->ctx, message);
+}
+
+void tv_output_value(const TvOutputSink* sink, TvOutputField field, unsigned short value)
+{
+    if (sink == NULL)
+    {
+        sink = &tv_output_stdout_sink;
+    }
+    sink->value(sink->ctx, field, value);
+}
+
+int tv_output_format_value(char buffer[TV_OUTPUT_VALUE_SIZE], unsigned short value)
+{
+    // Digits backwards, then reversed in place.
+    int length = 0;
+    do
+    {
+        buffer[length++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    for (int i = 0; i < length / 2; i++)
+    {
+        const char digit = buffer[i];
+        buffer[i] = buffer[length - 1 - i];
+        buffer[length - 1 - i] = digit;
+    }
+    buffer[length] = '\0';
+    return length;
+}
+
+char const * tv_output_field_to_string(TvOutputField field)
+{
+    switch (field)
+    {
+        case TV_OUTPUT_VOLUME: return "volume";
+        case TV_OUTPUT_BRIGHTNESS: return "brightness";
+        case TV_OUTPUT_CHANNEL: return "channel";
+        case TV_OUTPUT_CHANNEL_ENTRY: return "channel_entry";
+        default: return "?";
+    }
+}
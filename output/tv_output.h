@@ -0,0 +1,53 @@
+#pragma once
+
+// Output actions of the TV remote state machine.
+// The generated code never prints directly; the `show()` and `print_*()` expansions in
+// code_gen.csx call into these functions so the output can be redirected (or discarded).
+
+// The variable that a `print_*()` action reports.
+typedef enum TvOutputField
+{
+    TV_OUTPUT_VOLUME = 0,
+    TV_OUTPUT_BRIGHTNESS = 1,
+    TV_OUTPUT_CHANNEL = 2,
+    // The number typed so far in channel entry.
+    TV_OUTPUT_CHANNEL_ENTRY = 3,
+} TvOutputField;
+
+enum
+{
+    TV_OUTPUT_FIELD_COUNT = 4
+};
+
+// Destination for the state machine output actions.
+typedef struct TvOutputSink
+{
+    // Called for `show("message")`.
+    void (*show)(void* ctx, const char* message);
+    // Called for `print_volume()`, `print_brightness()`, `print_channel()` & `print_channel_entry()`.
+    void (*value)(void* ctx, TvOutputField field, unsigned short value);
+    // Passed back to the callbacks.
+    void* ctx;
+} TvOutputSink;
+
+// Sink that discards everything. Used by tools that dispatch millions of events.
+extern const TvOutputSink tv_output_null_sink;
+
+// Sink that prints to stdout. Used when no sink is set.
+// With TVREMOTE_EMBEDDED it writes to STDOUT_FILENO directly (no stdio buffer, one write per line).
+extern const TvOutputSink tv_output_stdout_sink;
+
+// Forward a `show()` action to the sink (stdout if `sink` is NULL).
+void tv_output_show(const TvOutputSink* sink, const char* message);
+
+// Forward a `print_*()` action to the sink (stdout if `sink` is NULL).
+void tv_output_value(const TvOutputSink* sink, TvOutputField field, unsigned short value);
+
+// Characters written by tv_output_format_value() at most, including the NUL ("65535").
+#define TV_OUTPUT_VALUE_SIZE 6
+
+// Write `value` in decimal to `buffer` without stdio (for TVREMOTE_EMBEDDED sinks). Returns the length.
+int tv_output_format_value(char buffer[TV_OUTPUT_VALUE_SIZE], unsigned short value);
+
+// Thread safe.
+char const * tv_output_field_to_string(TvOutputField field);
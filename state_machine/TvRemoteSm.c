@@ -10,9 +10,10 @@ const unsigned short MAX_VOLUME = 100;
 const unsigned short MIN_VOLUME = 0;
 const unsigned short MAX_CHANNEL = 256;
 const unsigned short MIN_CHANNEL = 1;
+const unsigned short DEFAULT_VOLUME = 50;
+const unsigned short DEFAULT_BRIGHTNESS = 50;
 
 #include "TvRemoteSm.h"
-#include <stdio.h> // For fprint.
 #include <stdbool.h> // required for `consume_event` flag
 #include <string.h> // for memset
 
@@ -36,12 +37,20 @@ static void TV_ON_exit(TvRemoteSm* sm);
 
 static void TV_ON_b1_long_press(TvRemoteSm* sm);
 
+static void TV_ON_b2_double_press(TvRemoteSm* sm);
+
+static void TV_ON_b2_triple_press(TvRemoteSm* sm);
+
+static void TV_ON_chord_press(TvRemoteSm* sm);
+
 static void BRIGHTNESS_CHANGE_enter(TvRemoteSm* sm);
 
 static void BRIGHTNESS_CHANGE_exit(TvRemoteSm* sm);
 
 static void BRIGHTNESS_CHANGE_b2_long_press(TvRemoteSm* sm);
 
+static void BRIGHTNESS_CHANGE_InitialState_transition(TvRemoteSm* sm);
+
 static void BRIGHTNESS_CHANGE__INITIAL_enter(TvRemoteSm* sm);
 
 static void BRIGHTNESS_CHANGE__INITIAL_exit(TvRemoteSm* sm);
@@ -70,8 +79,14 @@ static void CHANNEL_SELECT_enter(TvRemoteSm* sm);
 
 static void CHANNEL_SELECT_exit(TvRemoteSm* sm);
 
+static void CHANNEL_SELECT_b1_double_press(TvRemoteSm* sm);
+
+static void CHANNEL_SELECT_b2_double_press(TvRemoteSm* sm);
+
 static void CHANNEL_SELECT_b2_long_press(TvRemoteSm* sm);
 
+static void CHANNEL_SELECT_InitialState_transition(TvRemoteSm* sm);
+
 static void CHANNEL_DOWN_enter(TvRemoteSm* sm);
 
 static void CHANNEL_DOWN_exit(TvRemoteSm* sm);
@@ -80,6 +95,18 @@ static void CHANNEL_DOWN_b1_press(TvRemoteSm* sm);
 
 static void CHANNEL_DOWN_b2_press(TvRemoteSm* sm);
 
+static void CHANNEL_ENTRY_enter(TvRemoteSm* sm);
+
+static void CHANNEL_ENTRY_exit(TvRemoteSm* sm);
+
+static void CHANNEL_ENTRY_b1_double_press(TvRemoteSm* sm);
+
+static void CHANNEL_ENTRY_b1_press(TvRemoteSm* sm);
+
+static void CHANNEL_ENTRY_b2_double_press(TvRemoteSm* sm);
+
+static void CHANNEL_ENTRY_b2_press(TvRemoteSm* sm);
+
 static void CHANNEL_SELECT__INITIAL_enter(TvRemoteSm* sm);
 
 static void CHANNEL_SELECT__INITIAL_exit(TvRemoteSm* sm);
@@ -150,11 +177,12 @@ void TvRemoteSm_start(TvRemoteSm* sm)
         // ROOT.<InitialState> is a pseudo state and cannot have an `enter` trigger.
         
         // ROOT.<InitialState> behavior
-        // uml: TransitionTo(TV_OFF)
+        // uml: / { init_vars(); } TransitionTo(TV_OFF)
         {
             // Step 1: Exit states until we reach `ROOT` state (Least Common Ancestor for transition). Already at LCA, no exiting required.
             
-            // Step 2: Transition action: ``.
+            // Step 2: Transition action: `init_vars();`.
+            sm->vars.volume = DEFAULT_VOLUME; sm->vars.brightness = DEFAULT_BRIGHTNESS; sm->vars.channel = channel_table_first(sm->vars.channels); sm->vars.changed |= TV_CHANGED_VOLUME | TV_CHANGED_BRIGHTNESS | TV_CHANGED_CHANNEL;
             
             // Step 3: Enter/move towards transition target `TV_OFF`.
             TV_OFF_enter(sm);
@@ -222,7 +250,14 @@ static void TV_OFF_enter(TvRemoteSm* sm)
     // uml: enter / { show("TV OFF"); }
     {
         // Step 1: execute action `show("TV OFF");`
-        printf("TV OFF" "\n");
+        tv_output_show(sm->vars.output, "TV OFF");
+    } // end of behavior for TV_OFF
+    
+    // TV_OFF behavior
+    // uml: enter / { mark_changed(TV_CHANGED_STATE | TV_CHANGED_POWER); }
+    {
+        // Step 1: execute action `mark_changed(TV_CHANGED_STATE | TV_CHANGED_POWER);`
+        sm->vars.changed |= TV_CHANGED_STATE | TV_CHANGED_POWER;
     } // end of behavior for TV_OFF
 }
 
@@ -275,12 +310,22 @@ static void TV_ON_enter(TvRemoteSm* sm)
     // setup trigger/event handlers
     sm->current_state_exit_handler = TV_ON_exit;
     sm->current_event_handlers[TvRemoteSm_EventId_B1_LONG_PRESS] = TV_ON_b1_long_press;
+    sm->current_event_handlers[TvRemoteSm_EventId_B2_DOUBLE_PRESS] = TV_ON_b2_double_press;
+    sm->current_event_handlers[TvRemoteSm_EventId_B2_TRIPLE_PRESS] = TV_ON_b2_triple_press;
+    sm->current_event_handlers[TvRemoteSm_EventId_CHORD_PRESS] = TV_ON_chord_press;
     
     // TV_ON behavior
     // uml: enter / { show("TV ON"); }
     {
         // Step 1: execute action `show("TV ON");`
-        printf("TV ON" "\n");
+        tv_output_show(sm->vars.output, "TV ON");
+    } // end of behavior for TV_ON
+    
+    // TV_ON behavior
+    // uml: enter / { mark_changed(TV_CHANGED_POWER); }
+    {
+        // Step 1: execute action `mark_changed(TV_CHANGED_POWER);`
+        sm->vars.changed |= TV_CHANGED_POWER;
     } // end of behavior for TV_ON
 }
 
@@ -289,6 +334,9 @@ static void TV_ON_exit(TvRemoteSm* sm)
     // adjust function pointers for this state's exit
     sm->current_state_exit_handler = ROOT_exit;
     sm->current_event_handlers[TvRemoteSm_EventId_B1_LONG_PRESS] = NULL;  // no ancestor listens to this event
+    sm->current_event_handlers[TvRemoteSm_EventId_B2_DOUBLE_PRESS] = NULL;  // no ancestor listens to this event
+    sm->current_event_handlers[TvRemoteSm_EventId_B2_TRIPLE_PRESS] = NULL;  // no ancestor listens to this event
+    sm->current_event_handlers[TvRemoteSm_EventId_CHORD_PRESS] = NULL;  // no ancestor listens to this event
 }
 
 static void TV_ON_b1_long_press(TvRemoteSm* sm)
@@ -313,6 +361,69 @@ static void TV_ON_b1_long_press(TvRemoteSm* sm)
     } // end of behavior for TV_ON
 }
 
+static void TV_ON_b2_double_press(TvRemoteSm* sm)
+{
+    // No ancestor state handles `b2_double_press` event.
+    
+    // TV_ON behavior
+    // uml: B2_DOUBLE_PRESS TransitionTo(CHANNEL_SELECT)
+    {
+        // Step 1: Exit states until we reach `TV_ON` state (Least Common Ancestor for transition).
+        exit_up_to_state_handler(sm, TV_ON_exit);
+        
+        // Step 2: Transition action: ``.
+        
+        // Step 3: Enter/move towards transition target `CHANNEL_SELECT`.
+        CHANNEL_SELECT_enter(sm);
+        
+        // Finish transition by calling pseudo state transition function.
+        CHANNEL_SELECT_InitialState_transition(sm);
+        return; // event processing immediately stops when a transition finishes. No other behaviors for this state are checked.
+    } // end of behavior for TV_ON
+}
+
+static void TV_ON_b2_triple_press(TvRemoteSm* sm)
+{
+    // No ancestor state handles `b2_triple_press` event.
+    
+    // TV_ON behavior
+    // uml: B2_TRIPLE_PRESS TransitionTo(BRIGHTNESS_CHANGE)
+    {
+        // Step 1: Exit states until we reach `TV_ON` state (Least Common Ancestor for transition).
+        exit_up_to_state_handler(sm, TV_ON_exit);
+        
+        // Step 2: Transition action: ``.
+        
+        // Step 3: Enter/move towards transition target `BRIGHTNESS_CHANGE`.
+        BRIGHTNESS_CHANGE_enter(sm);
+        
+        // Finish transition by calling pseudo state transition function.
+        BRIGHTNESS_CHANGE_InitialState_transition(sm);
+        return; // event processing immediately stops when a transition finishes. No other behaviors for this state are checked.
+    } // end of behavior for TV_ON
+}
+
+static void TV_ON_chord_press(TvRemoteSm* sm)
+{
+    // No ancestor state handles `chord_press` event.
+    
+    // TV_ON behavior
+    // uml: CHORD_PRESS TransitionTo(VOLUME_CHANGE)
+    {
+        // Step 1: Exit states until we reach `TV_ON` state (Least Common Ancestor for transition).
+        exit_up_to_state_handler(sm, TV_ON_exit);
+        
+        // Step 2: Transition action: ``.
+        
+        // Step 3: Enter/move towards transition target `VOLUME_CHANGE`.
+        VOLUME_CHANGE_enter(sm);
+        
+        // Finish transition by calling pseudo state transition function.
+        VOLUME_CHANGE_InitialState_transition(sm);
+        return; // event processing immediately stops when a transition finishes. No other behaviors for this state are checked.
+    } // end of behavior for TV_ON
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // event handlers for state BRIGHTNESS_CHANGE
@@ -328,7 +439,7 @@ static void BRIGHTNESS_CHANGE_enter(TvRemoteSm* sm)
     // uml: enter / { show("Brightness Change"); }
     {
         // Step 1: execute action `show("Brightness Change");`
-        printf("Brightness Change" "\n");
+        tv_output_show(sm->vars.output, "Brightness Change");
     } // end of behavior for BRIGHTNESS_CHANGE
 }
 
@@ -360,6 +471,25 @@ static void BRIGHTNESS_CHANGE_b2_long_press(TvRemoteSm* sm)
     } // end of behavior for BRIGHTNESS_CHANGE
 }
 
+static void BRIGHTNESS_CHANGE_InitialState_transition(TvRemoteSm* sm)
+{
+    // BRIGHTNESS_CHANGE.<InitialState> behavior
+    // uml: TransitionTo(BRIGHTNESS_CHANGE__INITIAL)
+    {
+        // Step 1: Exit states until we reach `BRIGHTNESS_CHANGE` state (Least Common Ancestor for transition). Already at LCA, no exiting required.
+        
+        // Step 2: Transition action: ``.
+        
+        // Step 3: Enter/move towards transition target `BRIGHTNESS_CHANGE__INITIAL`.
+        BRIGHTNESS_CHANGE__INITIAL_enter(sm);
+        
+        // Step 4: complete transition. Ends event dispatch. No other behaviors are checked.
+        sm->state_id = TvRemoteSm_StateId_BRIGHTNESS_CHANGE__INITIAL;
+        sm->ancestor_event_handler = NULL;
+        return;
+    } // end of behavior for BRIGHTNESS_CHANGE.<InitialState>
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // event handlers for state BRIGHTNESS_CHANGE__INITIAL
@@ -371,6 +501,13 @@ static void BRIGHTNESS_CHANGE__INITIAL_enter(TvRemoteSm* sm)
     sm->current_state_exit_handler = BRIGHTNESS_CHANGE__INITIAL_exit;
     sm->current_event_handlers[TvRemoteSm_EventId_B1_PRESS] = BRIGHTNESS_CHANGE__INITIAL_b1_press;
     sm->current_event_handlers[TvRemoteSm_EventId_B2_PRESS] = BRIGHTNESS_CHANGE__INITIAL_b2_press;
+    
+    // BRIGHTNESS_CHANGE__INITIAL behavior
+    // uml: enter / { mark_changed(TV_CHANGED_STATE); }
+    {
+        // Step 1: execute action `mark_changed(TV_CHANGED_STATE);`
+        sm->vars.changed |= TV_CHANGED_STATE;
+    } // end of behavior for BRIGHTNESS_CHANGE__INITIAL
 }
 
 static void BRIGHTNESS_CHANGE__INITIAL_exit(TvRemoteSm* sm)
@@ -441,9 +578,16 @@ static void BRIGHTNESS_DOWN_enter(TvRemoteSm* sm)
     // uml: enter / { show("Brightness Down");\nbrightness_decrement();\nprint_brightness(); }
     {
         // Step 1: execute action `show("Brightness Down");\nbrightness_decrement();\nprint_brightness();`
-        printf("Brightness Down" "\n");
-        if (sm->vars.brightness > MIN_BRIGHTNESS) { sm->vars.brightness--; };
-        printf("%d\n", sm->vars.brightness);
+        tv_output_show(sm->vars.output, "Brightness Down");
+        if (sm->vars.brightness > MIN_BRIGHTNESS) { sm->vars.brightness--; sm->vars.changed |= TV_CHANGED_BRIGHTNESS; };
+        tv_output_value(sm->vars.output, TV_OUTPUT_BRIGHTNESS, sm->vars.brightness);
+    } // end of behavior for BRIGHTNESS_DOWN
+    
+    // BRIGHTNESS_DOWN behavior
+    // uml: enter / { mark_changed(TV_CHANGED_STATE); }
+    {
+        // Step 1: execute action `mark_changed(TV_CHANGED_STATE);`
+        sm->vars.changed |= TV_CHANGED_STATE;
     } // end of behavior for BRIGHTNESS_DOWN
 }
 
@@ -515,9 +659,16 @@ static void BRIGHTNESS_UP_enter(TvRemoteSm* sm)
     // uml: enter / { show("Brightness Up");\nbrightness_increment();\nprint_brightness(); }
     {
         // Step 1: execute action `show("Brightness Up");\nbrightness_increment();\nprint_brightness();`
-        printf("Brightness Up" "\n");
-        if (sm->vars.brightness < MAX_BRIGHTNESS) { sm->vars.brightness++; };
-        printf("%d\n", sm->vars.brightness);
+        tv_output_show(sm->vars.output, "Brightness Up");
+        if (sm->vars.brightness < MAX_BRIGHTNESS) { sm->vars.brightness++; sm->vars.changed |= TV_CHANGED_BRIGHTNESS; };
+        tv_output_value(sm->vars.output, TV_OUTPUT_BRIGHTNESS, sm->vars.brightness);
+    } // end of behavior for BRIGHTNESS_UP
+    
+    // BRIGHTNESS_UP behavior
+    // uml: enter / { mark_changed(TV_CHANGED_STATE); }
+    {
+        // Step 1: execute action `mark_changed(TV_CHANGED_STATE);`
+        sm->vars.changed |= TV_CHANGED_STATE;
     } // end of behavior for BRIGHTNESS_UP
 }
 
@@ -582,23 +733,75 @@ static void CHANNEL_SELECT_enter(TvRemoteSm* sm)
 {
     // setup trigger/event handlers
     sm->current_state_exit_handler = CHANNEL_SELECT_exit;
+    sm->current_event_handlers[TvRemoteSm_EventId_B1_DOUBLE_PRESS] = CHANNEL_SELECT_b1_double_press;
+    sm->current_event_handlers[TvRemoteSm_EventId_B2_DOUBLE_PRESS] = CHANNEL_SELECT_b2_double_press;
     sm->current_event_handlers[TvRemoteSm_EventId_B2_LONG_PRESS] = CHANNEL_SELECT_b2_long_press;
     
     // CHANNEL_SELECT behavior
     // uml: enter / { show("Channel Select"); }
     {
         // Step 1: execute action `show("Channel Select");`
-        printf("Channel Select" "\n");
+        tv_output_show(sm->vars.output, "Channel Select");
     } // end of behavior for CHANNEL_SELECT
 }
 
 static void CHANNEL_SELECT_exit(TvRemoteSm* sm)
 {
+    // CHANNEL_SELECT behavior
+    // uml: exit / { channel_entry_clear(); }
+    {
+        // Step 1: execute action `channel_entry_clear();`
+        sm->vars.channel_entry = 0;
+    } // end of behavior for CHANNEL_SELECT
+    
     // adjust function pointers for this state's exit
     sm->current_state_exit_handler = TV_ON_exit;
+    sm->current_event_handlers[TvRemoteSm_EventId_B1_DOUBLE_PRESS] = NULL;  // no ancestor listens to this event
+    sm->current_event_handlers[TvRemoteSm_EventId_B2_DOUBLE_PRESS] = TV_ON_b2_double_press;  // the next ancestor that handles this event is TV_ON
     sm->current_event_handlers[TvRemoteSm_EventId_B2_LONG_PRESS] = NULL;  // no ancestor listens to this event
 }
 
+static void CHANNEL_SELECT_b1_double_press(TvRemoteSm* sm)
+{
+    // No ancestor state handles `b1_double_press` event.
+    
+    // CHANNEL_SELECT behavior
+    // uml: B1_DOUBLE_PRESS / { show("Favorite Channel");\nchannel_next_favorite();\nprint_channel(); }
+    {
+        // Step 1: execute action `show("Favorite Channel");\nchannel_next_favorite();\nprint_channel();`
+        tv_output_show(sm->vars.output, "Favorite Channel");
+        sm->vars.channel = channel_table_next_favorite(sm->vars.channels, sm->vars.channel); sm->vars.changed |= TV_CHANGED_CHANNEL;
+        tv_output_value(sm->vars.output, TV_OUTPUT_CHANNEL, sm->vars.channel);
+        
+        // Step 2: determine if ancestor gets to handle event next.
+        // Consume event.
+        // No ancestor handles event. Can skip nulling `ancestor_event_handler`.
+    } // end of behavior for CHANNEL_SELECT
+}
+
+static void CHANNEL_SELECT_b2_double_press(TvRemoteSm* sm)
+{
+    // Setup handler for next ancestor that listens to `b2_double_press` event.
+    sm->ancestor_event_handler = TV_ON_b2_double_press;
+    
+    // CHANNEL_SELECT behavior
+    // uml: B2_DOUBLE_PRESS TransitionTo(CHANNEL_ENTRY)
+    {
+        // Step 1: Exit states until we reach `CHANNEL_SELECT` state (Least Common Ancestor for transition).
+        exit_up_to_state_handler(sm, CHANNEL_SELECT_exit);
+        
+        // Step 2: Transition action: ``.
+        
+        // Step 3: Enter/move towards transition target `CHANNEL_ENTRY`.
+        CHANNEL_ENTRY_enter(sm);
+        
+        // Step 4: complete transition. Ends event dispatch. No other behaviors are checked.
+        sm->state_id = TvRemoteSm_StateId_CHANNEL_ENTRY;
+        sm->ancestor_event_handler = NULL;
+        return;
+    } // end of behavior for CHANNEL_SELECT
+}
+
 static void CHANNEL_SELECT_b2_long_press(TvRemoteSm* sm)
 {
     // No ancestor state handles `b2_long_press` event.
@@ -614,24 +817,31 @@ static void CHANNEL_SELECT_b2_long_press(TvRemoteSm* sm)
         // Step 3: Enter/move towards transition target `BRIGHTNESS_CHANGE`.
         BRIGHTNESS_CHANGE_enter(sm);
         
-        // BRIGHTNESS_CHANGE.<InitialState> behavior
-        // uml: TransitionTo(BRIGHTNESS_CHANGE__INITIAL)
-        {
-            // Step 1: Exit states until we reach `BRIGHTNESS_CHANGE` state (Least Common Ancestor for transition). Already at LCA, no exiting required.
-            
-            // Step 2: Transition action: ``.
-            
-            // Step 3: Enter/move towards transition target `BRIGHTNESS_CHANGE__INITIAL`.
-            BRIGHTNESS_CHANGE__INITIAL_enter(sm);
-            
-            // Step 4: complete transition. Ends event dispatch. No other behaviors are checked.
-            sm->state_id = TvRemoteSm_StateId_BRIGHTNESS_CHANGE__INITIAL;
-            // No ancestor handles event. Can skip nulling `ancestor_event_handler`.
-            return;
-        } // end of behavior for BRIGHTNESS_CHANGE.<InitialState>
+        // Finish transition by calling pseudo state transition function.
+        BRIGHTNESS_CHANGE_InitialState_transition(sm);
+        return; // event processing immediately stops when a transition finishes. No other behaviors for this state are checked.
     } // end of behavior for CHANNEL_SELECT
 }
 
+static void CHANNEL_SELECT_InitialState_transition(TvRemoteSm* sm)
+{
+    // CHANNEL_SELECT.<InitialState> behavior
+    // uml: TransitionTo(CHANNEL_SELECT__INITIAL)
+    {
+        // Step 1: Exit states until we reach `CHANNEL_SELECT` state (Least Common Ancestor for transition). Already at LCA, no exiting required.
+        
+        // Step 2: Transition action: ``.
+        
+        // Step 3: Enter/move towards transition target `CHANNEL_SELECT__INITIAL`.
+        CHANNEL_SELECT__INITIAL_enter(sm);
+        
+        // Step 4: complete transition. Ends event dispatch. No other behaviors are checked.
+        sm->state_id = TvRemoteSm_StateId_CHANNEL_SELECT__INITIAL;
+        sm->ancestor_event_handler = NULL;
+        return;
+    } // end of behavior for CHANNEL_SELECT.<InitialState>
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // event handlers for state CHANNEL_DOWN
@@ -648,9 +858,16 @@ static void CHANNEL_DOWN_enter(TvRemoteSm* sm)
     // uml: enter / { show("Channel Down");\nchannel_decrement();\nprint_channel(); }
     {
         // Step 1: execute action `show("Channel Down");\nchannel_decrement();\nprint_channel();`
-        printf("Channel Down" "\n");
-        if (sm->vars.channel <= MIN_CHANNEL) { sm->vars.channel = MAX_CHANNEL; } else { sm->vars.channel--; };
-        printf("%d\n", sm->vars.channel);
+        tv_output_show(sm->vars.output, "Channel Down");
+        sm->vars.channel = channel_table_prev(sm->vars.channels, sm->vars.channel); sm->vars.changed |= TV_CHANGED_CHANNEL;
+        tv_output_value(sm->vars.output, TV_OUTPUT_CHANNEL, sm->vars.channel);
+    } // end of behavior for CHANNEL_DOWN
+    
+    // CHANNEL_DOWN behavior
+    // uml: enter / { mark_changed(TV_CHANGED_STATE); }
+    {
+        // Step 1: execute action `mark_changed(TV_CHANGED_STATE);`
+        sm->vars.changed |= TV_CHANGED_STATE;
     } // end of behavior for CHANNEL_DOWN
 }
 
@@ -707,6 +924,146 @@ static void CHANNEL_DOWN_b2_press(TvRemoteSm* sm)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+// event handlers for state CHANNEL_ENTRY
+////////////////////////////////////////////////////////////////////////////////
+
+static void CHANNEL_ENTRY_enter(TvRemoteSm* sm)
+{
+    // setup trigger/event handlers
+    sm->current_state_exit_handler = CHANNEL_ENTRY_exit;
+    sm->current_event_handlers[TvRemoteSm_EventId_B1_DOUBLE_PRESS] = CHANNEL_ENTRY_b1_double_press;
+    sm->current_event_handlers[TvRemoteSm_EventId_B1_PRESS] = CHANNEL_ENTRY_b1_press;
+    sm->current_event_handlers[TvRemoteSm_EventId_B2_DOUBLE_PRESS] = CHANNEL_ENTRY_b2_double_press;
+    sm->current_event_handlers[TvRemoteSm_EventId_B2_PRESS] = CHANNEL_ENTRY_b2_press;
+    
+    // CHANNEL_ENTRY behavior
+    // uml: enter / { show("Channel Entry");\nchannel_entry_start();\nprint_channel_entry(); }
+    {
+        // Step 1: execute action `show("Channel Entry");\nchannel_entry_start();\nprint_channel_entry();`
+        tv_output_show(sm->vars.output, "Channel Entry");
+        sm->vars.channel_entry = 0;
+        tv_output_value(sm->vars.output, TV_OUTPUT_CHANNEL_ENTRY, sm->vars.channel_entry);
+    } // end of behavior for CHANNEL_ENTRY
+    
+    // CHANNEL_ENTRY behavior
+    // uml: enter / { mark_changed(TV_CHANGED_STATE); }
+    {
+        // Step 1: execute action `mark_changed(TV_CHANGED_STATE);`
+        sm->vars.changed |= TV_CHANGED_STATE;
+    } // end of behavior for CHANNEL_ENTRY
+}
+
+static void CHANNEL_ENTRY_exit(TvRemoteSm* sm)
+{
+    // adjust function pointers for this state's exit
+    sm->current_state_exit_handler = CHANNEL_SELECT_exit;
+    sm->current_event_handlers[TvRemoteSm_EventId_B1_DOUBLE_PRESS] = CHANNEL_SELECT_b1_double_press;  // the next ancestor that handles this event is CHANNEL_SELECT
+    sm->current_event_handlers[TvRemoteSm_EventId_B1_PRESS] = NULL;  // no ancestor listens to this event
+    sm->current_event_handlers[TvRemoteSm_EventId_B2_DOUBLE_PRESS] = CHANNEL_SELECT_b2_double_press;  // the next ancestor that handles this event is CHANNEL_SELECT
+    sm->current_event_handlers[TvRemoteSm_EventId_B2_PRESS] = NULL;  // no ancestor listens to this event
+}
+
+static void CHANNEL_ENTRY_b1_double_press(TvRemoteSm* sm)
+{
+    // Setup handler for next ancestor that listens to `b1_double_press` event.
+    sm->ancestor_event_handler = CHANNEL_SELECT_b1_double_press;
+    
+    // CHANNEL_ENTRY behavior
+    // uml: B1_DOUBLE_PRESS / { channel_entry_count(2);\nprint_channel_entry(); }
+    {
+        // Step 1: execute action `channel_entry_count(2);\nprint_channel_entry();`
+        sm->vars.channel_entry = sm->vars.channel_entry - sm->vars.channel_entry % 10 + (sm->vars.channel_entry % 10 + 2) % 10;
+        tv_output_value(sm->vars.output, TV_OUTPUT_CHANNEL_ENTRY, sm->vars.channel_entry);
+        
+        // Step 2: determine if ancestor gets to handle event next.
+        // Consume event.
+        sm->ancestor_event_handler = NULL;
+    } // end of behavior for CHANNEL_ENTRY
+}
+
+static void CHANNEL_ENTRY_b1_press(TvRemoteSm* sm)
+{
+    // No ancestor state handles `b1_press` event.
+    
+    // CHANNEL_ENTRY behavior
+    // uml: B1_PRESS / { channel_entry_count(1);\nprint_channel_entry(); }
+    {
+        // Step 1: execute action `channel_entry_count(1);\nprint_channel_entry();`
+        sm->vars.channel_entry = sm->vars.channel_entry - sm->vars.channel_entry % 10 + (sm->vars.channel_entry % 10 + 1) % 10;
+        tv_output_value(sm->vars.output, TV_OUTPUT_CHANNEL_ENTRY, sm->vars.channel_entry);
+        
+        // Step 2: determine if ancestor gets to handle event next.
+        // Consume event.
+        // No ancestor handles event. Can skip nulling `ancestor_event_handler`.
+    } // end of behavior for CHANNEL_ENTRY
+}
+
+static void CHANNEL_ENTRY_b2_double_press(TvRemoteSm* sm)
+{
+    // Setup handler for next ancestor that listens to `b2_double_press` event.
+    sm->ancestor_event_handler = CHANNEL_SELECT_b2_double_press;
+    
+    // CHANNEL_ENTRY behavior
+    // uml: B2_DOUBLE_PRESS / { show("Channel Select");\nchannel_entry_apply();\nprint_channel(); } TransitionTo(CHANNEL_SELECT__INITIAL)
+    {
+        // Step 1: Exit states until we reach `CHANNEL_SELECT` state (Least Common Ancestor for transition).
+        CHANNEL_ENTRY_exit(sm);
+        
+        // Step 2: Transition action: `show("Channel Select");\nchannel_entry_apply();\nprint_channel();`.
+        tv_output_show(sm->vars.output, "Channel Select");
+        if (channel_table_is_enabled(sm->vars.channels, sm->vars.channel_entry)) { sm->vars.channel = sm->vars.channel_entry; sm->vars.changed |= TV_CHANGED_CHANNEL; } sm->vars.channel_entry = 0;
+        tv_output_value(sm->vars.output, TV_OUTPUT_CHANNEL, sm->vars.channel);
+        
+        // Step 3: Enter/move towards transition target `CHANNEL_SELECT__INITIAL`.
+        CHANNEL_SELECT__INITIAL_enter(sm);
+        
+        // Step 4: complete transition. Ends event dispatch. No other behaviors are checked.
+        sm->state_id = TvRemoteSm_StateId_CHANNEL_SELECT__INITIAL;
+        sm->ancestor_event_handler = NULL;
+        return;
+    } // end of behavior for CHANNEL_ENTRY
+}
+
+static void CHANNEL_ENTRY_b2_press(TvRemoteSm* sm)
+{
+    // No ancestor state handles `b2_press` event.
+    
+    // CHANNEL_ENTRY behavior
+    // uml: 1. B2_PRESS [channel_entry_full()] / { show("Channel Select");\nchannel_entry_apply();\nprint_channel(); } TransitionTo(CHANNEL_SELECT__INITIAL)
+    if (sm->vars.channel_entry * 10 > MAX_CHANNEL)
+    {
+        // Step 1: Exit states until we reach `CHANNEL_SELECT` state (Least Common Ancestor for transition).
+        CHANNEL_ENTRY_exit(sm);
+        
+        // Step 2: Transition action: `show("Channel Select");\nchannel_entry_apply();\nprint_channel();`.
+        tv_output_show(sm->vars.output, "Channel Select");
+        if (channel_table_is_enabled(sm->vars.channels, sm->vars.channel_entry)) { sm->vars.channel = sm->vars.channel_entry; sm->vars.changed |= TV_CHANGED_CHANNEL; } sm->vars.channel_entry = 0;
+        tv_output_value(sm->vars.output, TV_OUTPUT_CHANNEL, sm->vars.channel);
+        
+        // Step 3: Enter/move towards transition target `CHANNEL_SELECT__INITIAL`.
+        CHANNEL_SELECT__INITIAL_enter(sm);
+        
+        // Step 4: complete transition. Ends event dispatch. No other behaviors are checked.
+        sm->state_id = TvRemoteSm_StateId_CHANNEL_SELECT__INITIAL;
+        // No ancestor handles event. Can skip nulling `ancestor_event_handler`.
+        return;
+    } // end of behavior for CHANNEL_ENTRY
+    
+    // CHANNEL_ENTRY behavior
+    // uml: 2. B2_PRESS / { channel_entry_next_digit();\nprint_channel_entry(); }
+    {
+        // Step 1: execute action `channel_entry_next_digit();\nprint_channel_entry();`
+        sm->vars.channel_entry *= 10;
+        tv_output_value(sm->vars.output, TV_OUTPUT_CHANNEL_ENTRY, sm->vars.channel_entry);
+        
+        // Step 2: determine if ancestor gets to handle event next.
+        // Consume event.
+        // No ancestor handles event. Can skip nulling `ancestor_event_handler`.
+    } // end of behavior for CHANNEL_ENTRY
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // event handlers for state CHANNEL_SELECT__INITIAL
 ////////////////////////////////////////////////////////////////////////////////
@@ -717,6 +1074,13 @@ static void CHANNEL_SELECT__INITIAL_enter(TvRemoteSm* sm)
     sm->current_state_exit_handler = CHANNEL_SELECT__INITIAL_exit;
     sm->current_event_handlers[TvRemoteSm_EventId_B1_PRESS] = CHANNEL_SELECT__INITIAL_b1_press;
     sm->current_event_handlers[TvRemoteSm_EventId_B2_PRESS] = CHANNEL_SELECT__INITIAL_b2_press;
+    
+    // CHANNEL_SELECT__INITIAL behavior
+    // uml: enter / { mark_changed(TV_CHANGED_STATE); }
+    {
+        // Step 1: execute action `mark_changed(TV_CHANGED_STATE);`
+        sm->vars.changed |= TV_CHANGED_STATE;
+    } // end of behavior for CHANNEL_SELECT__INITIAL
 }
 
 static void CHANNEL_SELECT__INITIAL_exit(TvRemoteSm* sm)
@@ -787,9 +1151,16 @@ static void CHANNEL_UP_enter(TvRemoteSm* sm)
     // uml: enter / { show("Channel Up");\nchannel_increment();\nprint_channel(); }
     {
         // Step 1: execute action `show("Channel Up");\nchannel_increment();\nprint_channel();`
-        printf("Channel Up" "\n");
-        if (sm->vars.channel >= MAX_CHANNEL) { sm->vars.channel = MIN_CHANNEL; } else { sm->vars.channel++; };
-        printf("%d\n", sm->vars.channel);
+        tv_output_show(sm->vars.output, "Channel Up");
+        sm->vars.channel = channel_table_next(sm->vars.channels, sm->vars.channel); sm->vars.changed |= TV_CHANGED_CHANNEL;
+        tv_output_value(sm->vars.output, TV_OUTPUT_CHANNEL, sm->vars.channel);
+    } // end of behavior for CHANNEL_UP
+    
+    // CHANNEL_UP behavior
+    // uml: enter / { mark_changed(TV_CHANGED_STATE); }
+    {
+        // Step 1: execute action `mark_changed(TV_CHANGED_STATE);`
+        sm->vars.changed |= TV_CHANGED_STATE;
     } // end of behavior for CHANNEL_UP
 }
 
@@ -860,7 +1231,7 @@ static void VOLUME_CHANGE_enter(TvRemoteSm* sm)
     // uml: enter / { show("Volume Change"); }
     {
         // Step 1: execute action `show("Volume Change");`
-        printf("Volume Change" "\n");
+        tv_output_show(sm->vars.output, "Volume Change");
     } // end of behavior for VOLUME_CHANGE
 }
 
@@ -886,21 +1257,9 @@ static void VOLUME_CHANGE_b2_long_press(TvRemoteSm* sm)
         // Step 3: Enter/move towards transition target `CHANNEL_SELECT`.
         CHANNEL_SELECT_enter(sm);
         
-        // CHANNEL_SELECT.<InitialState> behavior
-        // uml: TransitionTo(CHANNEL_SELECT__INITIAL)
-        {
-            // Step 1: Exit states until we reach `CHANNEL_SELECT` state (Least Common Ancestor for transition). Already at LCA, no exiting required.
-            
-            // Step 2: Transition action: ``.
-            
-            // Step 3: Enter/move towards transition target `CHANNEL_SELECT__INITIAL`.
-            CHANNEL_SELECT__INITIAL_enter(sm);
-            
-            // Step 4: complete transition. Ends event dispatch. No other behaviors are checked.
-            sm->state_id = TvRemoteSm_StateId_CHANNEL_SELECT__INITIAL;
-            // No ancestor handles event. Can skip nulling `ancestor_event_handler`.
-            return;
-        } // end of behavior for CHANNEL_SELECT.<InitialState>
+        // Finish transition by calling pseudo state transition function.
+        CHANNEL_SELECT_InitialState_transition(sm);
+        return; // event processing immediately stops when a transition finishes. No other behaviors for this state are checked.
     } // end of behavior for VOLUME_CHANGE
 }
 
@@ -934,6 +1293,13 @@ static void VOLUME_CHANGE__INITIAL_enter(TvRemoteSm* sm)
     sm->current_state_exit_handler = VOLUME_CHANGE__INITIAL_exit;
     sm->current_event_handlers[TvRemoteSm_EventId_B1_PRESS] = VOLUME_CHANGE__INITIAL_b1_press;
     sm->current_event_handlers[TvRemoteSm_EventId_B2_PRESS] = VOLUME_CHANGE__INITIAL_b2_press;
+    
+    // VOLUME_CHANGE__INITIAL behavior
+    // uml: enter / { mark_changed(TV_CHANGED_STATE); }
+    {
+        // Step 1: execute action `mark_changed(TV_CHANGED_STATE);`
+        sm->vars.changed |= TV_CHANGED_STATE;
+    } // end of behavior for VOLUME_CHANGE__INITIAL
 }
 
 static void VOLUME_CHANGE__INITIAL_exit(TvRemoteSm* sm)
@@ -1004,9 +1370,16 @@ static void VOLUME_DOWN_enter(TvRemoteSm* sm)
     // uml: enter / { show("Volume Down");\nvolume_decrement();\nprint_volume(); }
     {
         // Step 1: execute action `show("Volume Down");\nvolume_decrement();\nprint_volume();`
-        printf("Volume Down" "\n");
-        if (sm->vars.volume > MIN_VOLUME) { sm->vars.volume--; };
-        printf("%d\n", sm->vars.volume);
+        tv_output_show(sm->vars.output, "Volume Down");
+        if (sm->vars.volume > MIN_VOLUME) { sm->vars.volume--; sm->vars.changed |= TV_CHANGED_VOLUME; };
+        tv_output_value(sm->vars.output, TV_OUTPUT_VOLUME, sm->vars.volume);
+    } // end of behavior for VOLUME_DOWN
+    
+    // VOLUME_DOWN behavior
+    // uml: enter / { mark_changed(TV_CHANGED_STATE); }
+    {
+        // Step 1: execute action `mark_changed(TV_CHANGED_STATE);`
+        sm->vars.changed |= TV_CHANGED_STATE;
     } // end of behavior for VOLUME_DOWN
 }
 
@@ -1078,9 +1451,16 @@ static void VOLUME_UP_enter(TvRemoteSm* sm)
     // uml: enter / { show("Volume Up");\nvolume_increment();\nprint_volume(); }
     {
         // Step 1: execute action `show("Volume Up");\nvolume_increment();\nprint_volume();`
-        printf("Volume Up" "\n");
-        if (sm->vars.volume < MAX_VOLUME) { sm->vars.volume++; };
-        printf("%d\n", sm->vars.volume);
+        tv_output_show(sm->vars.output, "Volume Up");
+        if (sm->vars.volume < MAX_VOLUME) { sm->vars.volume++; sm->vars.changed |= TV_CHANGED_VOLUME; };
+        tv_output_value(sm->vars.output, TV_OUTPUT_VOLUME, sm->vars.volume);
+    } // end of behavior for VOLUME_UP
+    
+    // VOLUME_UP behavior
+    // uml: enter / { mark_changed(TV_CHANGED_STATE); }
+    {
+        // Step 1: execute action `mark_changed(TV_CHANGED_STATE);`
+        sm->vars.changed |= TV_CHANGED_STATE;
     } // end of behavior for VOLUME_UP
 }
 
@@ -1150,6 +1530,7 @@ char const * TvRemoteSm_state_id_to_string(TvRemoteSm_StateId id)
         case TvRemoteSm_StateId_BRIGHTNESS_UP: return "BRIGHTNESS_UP";
         case TvRemoteSm_StateId_CHANNEL_SELECT: return "CHANNEL_SELECT";
         case TvRemoteSm_StateId_CHANNEL_DOWN: return "CHANNEL_DOWN";
+        case TvRemoteSm_StateId_CHANNEL_ENTRY: return "CHANNEL_ENTRY";
         case TvRemoteSm_StateId_CHANNEL_SELECT__INITIAL: return "CHANNEL_SELECT__INITIAL";
         case TvRemoteSm_StateId_CHANNEL_UP: return "CHANNEL_UP";
         case TvRemoteSm_StateId_VOLUME_CHANGE: return "VOLUME_CHANGE";
@@ -1165,10 +1546,14 @@ char const * TvRemoteSm_event_id_to_string(TvRemoteSm_EventId id)
 {
     switch (id)
     {
+        case TvRemoteSm_EventId_B1_DOUBLE_PRESS: return "B1_DOUBLE_PRESS";
         case TvRemoteSm_EventId_B1_LONG_PRESS: return "B1_LONG_PRESS";
         case TvRemoteSm_EventId_B1_PRESS: return "B1_PRESS";
+        case TvRemoteSm_EventId_B2_DOUBLE_PRESS: return "B2_DOUBLE_PRESS";
         case TvRemoteSm_EventId_B2_LONG_PRESS: return "B2_LONG_PRESS";
         case TvRemoteSm_EventId_B2_PRESS: return "B2_PRESS";
+        case TvRemoteSm_EventId_B2_TRIPLE_PRESS: return "B2_TRIPLE_PRESS";
+        case TvRemoteSm_EventId_CHORD_PRESS: return "CHORD_PRESS";
         default: return "?";
     }
 }
@@ -3,18 +3,36 @@
 
 #pragma once
 #include <stdint.h>
+#include "../output/tv_output.h" // For TvOutputSink.
+#include "../channels/channel_table.h" // For ChannelTable.
+
+// Bits of `vars.changed`. The actions set the bit of what they change & the consumer clears them,
+// so it only has to look at what changed since it last did.
+enum
+{
+    TV_CHANGED_STATE = 1 << 0, // A leaf state was entered (a transition, possibly back to the same state).
+    TV_CHANGED_POWER = 1 << 1, // The TV was turned on or off.
+    TV_CHANGED_VOLUME = 1 << 2,
+    TV_CHANGED_BRIGHTNESS = 1 << 3,
+    TV_CHANGED_CHANNEL = 1 << 4, // The channel was tuned (possibly to the same one, e.g. in a lineup of one channel).
+    TV_CHANGED_ALL = 0x1f
+};
 
 typedef enum __attribute__((packed)) TvRemoteSm_EventId
 {
-    TvRemoteSm_EventId_B1_LONG_PRESS = 0,
-    TvRemoteSm_EventId_B1_PRESS = 1,
-    TvRemoteSm_EventId_B2_LONG_PRESS = 2,
-    TvRemoteSm_EventId_B2_PRESS = 3,
+    TvRemoteSm_EventId_B1_DOUBLE_PRESS = 0,
+    TvRemoteSm_EventId_B1_LONG_PRESS = 1,
+    TvRemoteSm_EventId_B1_PRESS = 2,
+    TvRemoteSm_EventId_B2_DOUBLE_PRESS = 3,
+    TvRemoteSm_EventId_B2_LONG_PRESS = 4,
+    TvRemoteSm_EventId_B2_PRESS = 5,
+    TvRemoteSm_EventId_B2_TRIPLE_PRESS = 6,
+    TvRemoteSm_EventId_CHORD_PRESS = 7,
 } TvRemoteSm_EventId;
 
 enum
 {
-    TvRemoteSm_EventIdCount = 4
+    TvRemoteSm_EventIdCount = 8
 };
 
 typedef enum __attribute__((packed)) TvRemoteSm_StateId
@@ -28,17 +46,18 @@ typedef enum __attribute__((packed)) TvRemoteSm_StateId
     TvRemoteSm_StateId_BRIGHTNESS_UP = 6,
     TvRemoteSm_StateId_CHANNEL_SELECT = 7,
     TvRemoteSm_StateId_CHANNEL_DOWN = 8,
-    TvRemoteSm_StateId_CHANNEL_SELECT__INITIAL = 9,
-    TvRemoteSm_StateId_CHANNEL_UP = 10,
-    TvRemoteSm_StateId_VOLUME_CHANGE = 11,
-    TvRemoteSm_StateId_VOLUME_CHANGE__INITIAL = 12,
-    TvRemoteSm_StateId_VOLUME_DOWN = 13,
-    TvRemoteSm_StateId_VOLUME_UP = 14,
+    TvRemoteSm_StateId_CHANNEL_ENTRY = 9,
+    TvRemoteSm_StateId_CHANNEL_SELECT__INITIAL = 10,
+    TvRemoteSm_StateId_CHANNEL_UP = 11,
+    TvRemoteSm_StateId_VOLUME_CHANGE = 12,
+    TvRemoteSm_StateId_VOLUME_CHANGE__INITIAL = 13,
+    TvRemoteSm_StateId_VOLUME_DOWN = 14,
+    TvRemoteSm_StateId_VOLUME_UP = 15,
 } TvRemoteSm_StateId;
 
 enum
 {
-    TvRemoteSm_StateIdCount = 15
+    TvRemoteSm_StateIdCount = 16
 };
 
 
@@ -52,6 +71,10 @@ typedef struct TvRemoteSm_Vars
     unsigned short volume;     
     unsigned short brightness;   
     unsigned short channel;
+    unsigned short channel_entry; // Digits typed in channel entry, the last one still counting. 0 outside of it.
+    unsigned char changed; // TV_CHANGED_* bits, cleared by the consumer.
+    const TvOutputSink* output; // Where the output actions go. NULL prints to stdout.
+    const ChannelTable* channels; // The channel lineup. NULL enables every channel in [MIN_CHANNEL, MAX_CHANNEL].
 } TvRemoteSm_Vars;
 
 
@@ -0,0 +1,205 @@
+#pragma once
+
+// Not generated. A C++17 wrapper of the generated C machine for host tools.
+//
+// Events & states are enum classes, their names are constexpr tables (the same strings as
+// TvRemoteSm_event_id_to_string() & TvRemoteSm_state_id_to_string()) and `dispatch<Event>()` runs the
+// dispatch loop of the generated code inline with the event as a constant: the handler of the active
+// state is still called through `current_event_handlers` (that's how the generated machine keeps its
+// state), but the call to TvRemoteSm_dispatch_event() & the lookup of the event disappear.
+//
+// The machine is only changed by dispatching: the vars & the state are read-only from the outside.
+// An observer is a template parameter whose `on_dispatch()` is called after each dispatch without a
+// virtual call; the default one is empty & compiles to nothing.
+
+#include <array> // for std::array
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint8_t
+#include <string_view> // for std::string_view
+
+extern "C" {
+#include "state_machine/TvRemoteSm.h"
+}
+
+namespace tv_remote
+{
+
+enum class Event : std::uint8_t
+{
+    B1DoublePress = TvRemoteSm_EventId_B1_DOUBLE_PRESS,
+    B1LongPress = TvRemoteSm_EventId_B1_LONG_PRESS,
+    B1Press = TvRemoteSm_EventId_B1_PRESS,
+    B2DoublePress = TvRemoteSm_EventId_B2_DOUBLE_PRESS,
+    B2LongPress = TvRemoteSm_EventId_B2_LONG_PRESS,
+    B2Press = TvRemoteSm_EventId_B2_PRESS,
+    B2TriplePress = TvRemoteSm_EventId_B2_TRIPLE_PRESS,
+    ChordPress = TvRemoteSm_EventId_CHORD_PRESS,
+};
+
+enum class State : std::uint8_t
+{
+    Root = TvRemoteSm_StateId_ROOT,
+    TvOff = TvRemoteSm_StateId_TV_OFF,
+    TvOn = TvRemoteSm_StateId_TV_ON,
+    BrightnessChange = TvRemoteSm_StateId_BRIGHTNESS_CHANGE,
+    BrightnessChangeInitial = TvRemoteSm_StateId_BRIGHTNESS_CHANGE__INITIAL,
+    BrightnessDown = TvRemoteSm_StateId_BRIGHTNESS_DOWN,
+    BrightnessUp = TvRemoteSm_StateId_BRIGHTNESS_UP,
+    ChannelSelect = TvRemoteSm_StateId_CHANNEL_SELECT,
+    ChannelDown = TvRemoteSm_StateId_CHANNEL_DOWN,
+    ChannelEntry = TvRemoteSm_StateId_CHANNEL_ENTRY,
+    ChannelSelectInitial = TvRemoteSm_StateId_CHANNEL_SELECT__INITIAL,
+    ChannelUp = TvRemoteSm_StateId_CHANNEL_UP,
+    VolumeChange = TvRemoteSm_StateId_VOLUME_CHANGE,
+    VolumeChangeInitial = TvRemoteSm_StateId_VOLUME_CHANGE__INITIAL,
+    VolumeDown = TvRemoteSm_StateId_VOLUME_DOWN,
+    VolumeUp = TvRemoteSm_StateId_VOLUME_UP,
+};
+
+inline constexpr std::size_t event_count = TvRemoteSm_EventIdCount;
+inline constexpr std::size_t state_count = TvRemoteSm_StateIdCount;
+
+// Indexed by the generated ids. Update together with the diagram: a missing name is left empty by
+// std::array, which is checked below, as is the order of the last names.
+inline constexpr std::array<std::string_view, event_count> event_names = {
+    "B1_DOUBLE_PRESS", "B1_LONG_PRESS", "B1_PRESS", "B2_DOUBLE_PRESS",
+    "B2_LONG_PRESS", "B2_PRESS", "B2_TRIPLE_PRESS", "CHORD_PRESS",
+};
+
+inline constexpr std::array<std::string_view, state_count> state_names = {
+    "ROOT", "TV_OFF", "TV_ON", "BRIGHTNESS_CHANGE",
+    "BRIGHTNESS_CHANGE__INITIAL", "BRIGHTNESS_DOWN", "BRIGHTNESS_UP", "CHANNEL_SELECT",
+    "CHANNEL_DOWN", "CHANNEL_ENTRY", "CHANNEL_SELECT__INITIAL", "CHANNEL_UP",
+    "VOLUME_CHANGE", "VOLUME_CHANGE__INITIAL", "VOLUME_DOWN", "VOLUME_UP",
+};
+
+constexpr std::size_t index(const Event event)
+{
+    return static_cast<std::size_t>(event);
+}
+
+constexpr std::size_t index(const State state)
+{
+    return static_cast<std::size_t>(state);
+}
+
+constexpr std::string_view name(const Event event)
+{
+    return event_names[index(event)];
+}
+
+constexpr std::string_view name(const State state)
+{
+    return state_names[index(state)];
+}
+
+template <std::size_t N>
+constexpr bool all_named(const std::array<std::string_view, N>& names)
+{
+    for (const std::string_view entry : names)
+    {
+        if (entry.empty())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(all_named(event_names), "an event has no name");
+static_assert(all_named(state_names), "a state has no name");
+static_assert(name(Event::ChordPress) == "CHORD_PRESS" && name(State::VolumeUp) == "VOLUME_UP",
+    "the name tables are out of order");
+
+// The default observer.
+struct NoObserver
+{
+    constexpr void on_dispatch(Event, State, State) const
+    {
+    }
+};
+
+// `Observer` needs `on_dispatch(Event event, State from, State to)`, called after every dispatch
+// (`from` == `to` when the event didn't change the state).
+template <typename Observer = NoObserver>
+class Machine : private Observer
+{
+public:
+    // A started machine. `output` & `channels` as in TvRemoteSm_Vars (NULL for stdout & every channel).
+    explicit Machine(const TvOutputSink* output = nullptr, const ChannelTable* channels = nullptr,
+        Observer observer = Observer())
+        : Observer(observer)
+    {
+        TvRemoteSm_ctor(&sm_);
+        sm_.vars.output = output;
+        sm_.vars.channels = channels;
+        TvRemoteSm_start(&sm_);
+    }
+
+    template <Event event>
+    void dispatch()
+    {
+        static_assert(index(event) < event_count, "not an event of the machine");
+        const State from = state();
+        run_handlers(sm_.current_event_handlers[index(event)]);
+        observer().on_dispatch(event, from, state());
+    }
+
+    // For events only known at run time.
+    void dispatch(const Event event)
+    {
+        const State from = state();
+        run_handlers(sm_.current_event_handlers[index(event)]);
+        observer().on_dispatch(event, from, state());
+    }
+
+    // Whether the active state (or one of its ancestors) handles `event`.
+    template <Event event>
+    bool handles() const
+    {
+        return sm_.current_event_handlers[index(event)] != nullptr;
+    }
+
+    State state() const
+    {
+        return static_cast<State>(sm_.state_id);
+    }
+
+    const TvRemoteSm_Vars& vars() const
+    {
+        return sm_.vars;
+    }
+
+    // For the C functions that take the machine, e.g. TvRemoteSm_restore.h.
+    const TvRemoteSm& c_machine() const
+    {
+        return sm_;
+    }
+
+    Observer& observer()
+    {
+        return *this;
+    }
+
+    const Observer& observer() const
+    {
+        return *this;
+    }
+
+private:
+    // The loop of TvRemoteSm_dispatch_event() (StateSmith's Balanced1 algorithm): a handler that
+    // doesn't consume the event leaves the handler of its parent in `ancestor_event_handler`.
+    void run_handlers(TvRemoteSm_Func handler)
+    {
+        while (handler != nullptr)
+        {
+            sm_.ancestor_event_handler = nullptr;
+            handler(&sm_);
+            handler = sm_.ancestor_event_handler;
+        }
+    }
+
+    TvRemoteSm sm_;
+};
+
+} // namespace tv_remote
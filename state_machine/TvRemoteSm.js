@@ -8,6 +8,25 @@ const MAX_VOLUME = 100;
 const MIN_VOLUME = 0;
 const MAX_CHANNEL = 256;
 const MIN_CHANNEL = 1;
+const DEFAULT_VOLUME = 50;
+const DEFAULT_BRIGHTNESS = 50;
+
+// Favorite channels in ascending order. B1_DOUBLE_PRESS in channel select jumps to the next one.
+const FAVORITE_CHANNELS = [1, 7, 42, 101, 200];
+
+// The first favorite above `channel`, wrapping around to the first one.
+function nextFavoriteChannel(channel)
+{
+    return FAVORITE_CHANNELS.find(favorite => favorite > channel) ?? FAVORITE_CHANNELS[0];
+}
+
+// Where the output actions go, like TvOutputSink of the C machine: `show(message)` for `show()`,
+// `value(field, value)` for `print_*()` with `field` "volume", "brightness", "channel" or "channel_entry".
+// Replace `vars.output` to redirect or discard them (see TvRemoteSm_node.js).
+const CONSOLE_OUTPUT = {
+    show(message) { console.log(message); },
+    value(field, value) { console.log(value); },
+};
 
 
 // Generated state machine
@@ -15,14 +34,18 @@ class TvRemoteSm
 {
     static EventId = 
     {
-        B1_LONG_PRESS : 0,
-        B1_PRESS : 1,
-        B2_LONG_PRESS : 2,
-        B2_PRESS : 3,
+        B1_DOUBLE_PRESS : 0,
+        B1_LONG_PRESS : 1,
+        B1_PRESS : 2,
+        B2_DOUBLE_PRESS : 3,
+        B2_LONG_PRESS : 4,
+        B2_PRESS : 5,
+        B2_TRIPLE_PRESS : 6,
+        CHORD_PRESS : 7,
     }
     static { Object.freeze(this.EventId); }
     
-    static EventIdCount = 4;
+    static EventIdCount = 8;
     static { Object.freeze(this.EventIdCount); }
     
     static StateId = 
@@ -36,16 +59,17 @@ class TvRemoteSm
         BRIGHTNESS_UP : 6,
         CHANNEL_SELECT : 7,
         CHANNEL_DOWN : 8,
-        CHANNEL_SELECT__INITIAL : 9,
-        CHANNEL_UP : 10,
-        VOLUME_CHANGE : 11,
-        VOLUME_CHANGE__INITIAL : 12,
-        VOLUME_DOWN : 13,
-        VOLUME_UP : 14,
+        CHANNEL_ENTRY : 9,
+        CHANNEL_SELECT__INITIAL : 10,
+        CHANNEL_UP : 11,
+        VOLUME_CHANGE : 12,
+        VOLUME_CHANGE__INITIAL : 13,
+        VOLUME_DOWN : 14,
+        VOLUME_UP : 15,
     }
     static { Object.freeze(this.StateId); }
     
-    static StateIdCount = 15;
+    static StateIdCount = 16;
     static { Object.freeze(this.StateIdCount); }
     
     // Used internally by state machine. Feel free to inspect, but don't modify.
@@ -65,6 +89,8 @@ class TvRemoteSm
         volume: 50,     
         brightness: 50,   
         channel: 1,
+        channel_entry: 0,
+        output: CONSOLE_OUTPUT,
     };
     
     // Starts the state machine. Must be called before dispatching events. Not thread safe.
@@ -82,11 +108,12 @@ class TvRemoteSm
             // ROOT.<InitialState> is a pseudo state and cannot have an `enter` trigger.
             
             // ROOT.<InitialState> behavior
-            // uml: TransitionTo(TV_OFF)
+            // uml: / { init_vars(); } TransitionTo(TV_OFF)
             {
                 // Step 1: Exit states until we reach `ROOT` state (Least Common Ancestor for transition). Already at LCA, no exiting required.
                 
-                // Step 2: Transition action: ``.
+                // Step 2: Transition action: `init_vars();`.
+                this.vars.volume = DEFAULT_VOLUME; this.vars.brightness = DEFAULT_BRIGHTNESS; this.vars.channel = MIN_CHANNEL;
                 
                 // Step 3: Enter/move towards transition target `TV_OFF`.
                 this.#TV_OFF_enter();
@@ -152,7 +179,7 @@ class TvRemoteSm
         // uml: enter / { show("TV OFF"); }
         {
             // Step 1: execute action `show("TV OFF");`
-            console.log("TV OFF");
+            this.vars.output.show("TV OFF");
         } // end of behavior for TV_OFF
     }
     
@@ -205,12 +232,15 @@ class TvRemoteSm
         // setup trigger/event handlers
         this.#currentStateExitHandler = this.#TV_ON_exit;
         this.#currentEventHandlers[TvRemoteSm.EventId.B1_LONG_PRESS] = this.#TV_ON_b1_long_press;
+        this.#currentEventHandlers[TvRemoteSm.EventId.B2_DOUBLE_PRESS] = this.#TV_ON_b2_double_press;
+        this.#currentEventHandlers[TvRemoteSm.EventId.B2_TRIPLE_PRESS] = this.#TV_ON_b2_triple_press;
+        this.#currentEventHandlers[TvRemoteSm.EventId.CHORD_PRESS] = this.#TV_ON_chord_press;
         
         // TV_ON behavior
         // uml: enter / { show("TV ON"); }
         {
             // Step 1: execute action `show("TV ON");`
-            console.log("TV ON");
+            this.vars.output.show("TV ON");
         } // end of behavior for TV_ON
     }
     
@@ -219,6 +249,9 @@ class TvRemoteSm
         // adjust function pointers for this state's exit
         this.#currentStateExitHandler = this.#ROOT_exit;
         this.#currentEventHandlers[TvRemoteSm.EventId.B1_LONG_PRESS] = null;  // no ancestor listens to this event
+        this.#currentEventHandlers[TvRemoteSm.EventId.B2_DOUBLE_PRESS] = null;  // no ancestor listens to this event
+        this.#currentEventHandlers[TvRemoteSm.EventId.B2_TRIPLE_PRESS] = null;  // no ancestor listens to this event
+        this.#currentEventHandlers[TvRemoteSm.EventId.CHORD_PRESS] = null;  // no ancestor listens to this event
     }
     
     #TV_ON_b1_long_press()
@@ -243,6 +276,69 @@ class TvRemoteSm
         } // end of behavior for TV_ON
     }
     
+    #TV_ON_b2_double_press()
+    {
+        // No ancestor state handles `b2_double_press` event.
+        
+        // TV_ON behavior
+        // uml: B2_DOUBLE_PRESS TransitionTo(CHANNEL_SELECT)
+        {
+            // Step 1: Exit states until we reach `TV_ON` state (Least Common Ancestor for transition).
+            this.#exitUpToStateHandler(this.#TV_ON_exit);
+            
+            // Step 2: Transition action: ``.
+            
+            // Step 3: Enter/move towards transition target `CHANNEL_SELECT`.
+            this.#CHANNEL_SELECT_enter();
+            
+            // Finish transition by calling pseudo state transition function.
+            this.#CHANNEL_SELECT_InitialState_transition();
+            return; // event processing immediately stops when a transition finishes. No other behaviors for this state are checked.
+        } // end of behavior for TV_ON
+    }
+    
+    #TV_ON_b2_triple_press()
+    {
+        // No ancestor state handles `b2_triple_press` event.
+        
+        // TV_ON behavior
+        // uml: B2_TRIPLE_PRESS TransitionTo(BRIGHTNESS_CHANGE)
+        {
+            // Step 1: Exit states until we reach `TV_ON` state (Least Common Ancestor for transition).
+            this.#exitUpToStateHandler(this.#TV_ON_exit);
+            
+            // Step 2: Transition action: ``.
+            
+            // Step 3: Enter/move towards transition target `BRIGHTNESS_CHANGE`.
+            this.#BRIGHTNESS_CHANGE_enter();
+            
+            // Finish transition by calling pseudo state transition function.
+            this.#BRIGHTNESS_CHANGE_InitialState_transition();
+            return; // event processing immediately stops when a transition finishes. No other behaviors for this state are checked.
+        } // end of behavior for TV_ON
+    }
+    
+    #TV_ON_chord_press()
+    {
+        // No ancestor state handles `chord_press` event.
+        
+        // TV_ON behavior
+        // uml: CHORD_PRESS TransitionTo(VOLUME_CHANGE)
+        {
+            // Step 1: Exit states until we reach `TV_ON` state (Least Common Ancestor for transition).
+            this.#exitUpToStateHandler(this.#TV_ON_exit);
+            
+            // Step 2: Transition action: ``.
+            
+            // Step 3: Enter/move towards transition target `VOLUME_CHANGE`.
+            this.#VOLUME_CHANGE_enter();
+            
+            // Finish transition by calling pseudo state transition function.
+            this.#VOLUME_CHANGE_InitialState_transition();
+            return; // event processing immediately stops when a transition finishes. No other behaviors for this state are checked.
+        } // end of behavior for TV_ON
+    }
+    
     
     ////////////////////////////////////////////////////////////////////////////////
     // event handlers for state BRIGHTNESS_CHANGE
@@ -258,7 +354,7 @@ class TvRemoteSm
         // uml: enter / { show("Brightness Change"); }
         {
             // Step 1: execute action `show("Brightness Change");`
-            console.log("Brightness Change");
+            this.vars.output.show("Brightness Change");
         } // end of behavior for BRIGHTNESS_CHANGE
     }
     
@@ -290,6 +386,25 @@ class TvRemoteSm
         } // end of behavior for BRIGHTNESS_CHANGE
     }
     
+    #BRIGHTNESS_CHANGE_InitialState_transition()
+    {
+        // BRIGHTNESS_CHANGE.<InitialState> behavior
+        // uml: TransitionTo(BRIGHTNESS_CHANGE__INITIAL)
+        {
+            // Step 1: Exit states until we reach `BRIGHTNESS_CHANGE` state (Least Common Ancestor for transition). Already at LCA, no exiting required.
+            
+            // Step 2: Transition action: ``.
+            
+            // Step 3: Enter/move towards transition target `BRIGHTNESS_CHANGE__INITIAL`.
+            this.#BRIGHTNESS_CHANGE__INITIAL_enter();
+            
+            // Step 4: complete transition. Ends event dispatch. No other behaviors are checked.
+            this.stateId = TvRemoteSm.StateId.BRIGHTNESS_CHANGE__INITIAL;
+            this.#ancestorEventHandler = null;
+            return;
+        } // end of behavior for BRIGHTNESS_CHANGE.<InitialState>
+    }
+    
     
     ////////////////////////////////////////////////////////////////////////////////
     // event handlers for state BRIGHTNESS_CHANGE__INITIAL
@@ -371,9 +486,9 @@ class TvRemoteSm
         // uml: enter / { show("Brightness Down");\nbrightness_decrement();\nprint_brightness(); }
         {
             // Step 1: execute action `show("Brightness Down");\nbrightness_decrement();\nprint_brightness();`
-            console.log("Brightness Down");
+            this.vars.output.show("Brightness Down");
             if (this.vars.brightness > MIN_BRIGHTNESS) { this.vars.brightness--; };
-            console.log(this.vars.brightness);
+            this.vars.output.value("brightness", this.vars.brightness);
         } // end of behavior for BRIGHTNESS_DOWN
     }
     
@@ -445,9 +560,9 @@ class TvRemoteSm
         // uml: enter / { show("Brightness Up");\nbrightness_increment();\nprint_brightness(); }
         {
             // Step 1: execute action `show("Brightness Up");\nbrightness_increment();\nprint_brightness();`
-            console.log("Brightness Up");
+            this.vars.output.show("Brightness Up");
             if (this.vars.brightness < MAX_BRIGHTNESS) { this.vars.brightness++; };
-            console.log(this.vars.brightness);
+            this.vars.output.value("brightness", this.vars.brightness);
         } // end of behavior for BRIGHTNESS_UP
     }
     
@@ -512,23 +627,75 @@ class TvRemoteSm
     {
         // setup trigger/event handlers
         this.#currentStateExitHandler = this.#CHANNEL_SELECT_exit;
+        this.#currentEventHandlers[TvRemoteSm.EventId.B1_DOUBLE_PRESS] = this.#CHANNEL_SELECT_b1_double_press;
+        this.#currentEventHandlers[TvRemoteSm.EventId.B2_DOUBLE_PRESS] = this.#CHANNEL_SELECT_b2_double_press;
         this.#currentEventHandlers[TvRemoteSm.EventId.B2_LONG_PRESS] = this.#CHANNEL_SELECT_b2_long_press;
         
         // CHANNEL_SELECT behavior
         // uml: enter / { show("Channel Select"); }
         {
             // Step 1: execute action `show("Channel Select");`
-            console.log("Channel Select");
+            this.vars.output.show("Channel Select");
         } // end of behavior for CHANNEL_SELECT
     }
     
     #CHANNEL_SELECT_exit()
     {
+        // CHANNEL_SELECT behavior
+        // uml: exit / { channel_entry_clear(); }
+        {
+            // Step 1: execute action `channel_entry_clear();`
+            this.vars.channel_entry = 0;
+        } // end of behavior for CHANNEL_SELECT
+        
         // adjust function pointers for this state's exit
         this.#currentStateExitHandler = this.#TV_ON_exit;
+        this.#currentEventHandlers[TvRemoteSm.EventId.B1_DOUBLE_PRESS] = null;  // no ancestor listens to this event
+        this.#currentEventHandlers[TvRemoteSm.EventId.B2_DOUBLE_PRESS] = this.#TV_ON_b2_double_press;  // the next ancestor that handles this event is TV_ON
         this.#currentEventHandlers[TvRemoteSm.EventId.B2_LONG_PRESS] = null;  // no ancestor listens to this event
     }
     
+    #CHANNEL_SELECT_b1_double_press()
+    {
+        // No ancestor state handles `b1_double_press` event.
+        
+        // CHANNEL_SELECT behavior
+        // uml: B1_DOUBLE_PRESS / { show("Favorite Channel");\nchannel_next_favorite();\nprint_channel(); }
+        {
+            // Step 1: execute action `show("Favorite Channel");\nchannel_next_favorite();\nprint_channel();`
+            this.vars.output.show("Favorite Channel");
+            this.vars.channel = nextFavoriteChannel(this.vars.channel);
+            this.vars.output.value("channel", this.vars.channel);
+            
+            // Step 2: determine if ancestor gets to handle event next.
+            // Consume event.
+            // No ancestor handles event. Can skip nulling `ancestorEventHandler`.
+        } // end of behavior for CHANNEL_SELECT
+    }
+    
+    #CHANNEL_SELECT_b2_double_press()
+    {
+        // Setup handler for next ancestor that listens to `b2_double_press` event.
+        this.#ancestorEventHandler = this.#TV_ON_b2_double_press;
+        
+        // CHANNEL_SELECT behavior
+        // uml: B2_DOUBLE_PRESS TransitionTo(CHANNEL_ENTRY)
+        {
+            // Step 1: Exit states until we reach `CHANNEL_SELECT` state (Least Common Ancestor for transition).
+            this.#exitUpToStateHandler(this.#CHANNEL_SELECT_exit);
+            
+            // Step 2: Transition action: ``.
+            
+            // Step 3: Enter/move towards transition target `CHANNEL_ENTRY`.
+            this.#CHANNEL_ENTRY_enter();
+            
+            // Step 4: complete transition. Ends event dispatch. No other behaviors are checked.
+            this.stateId = TvRemoteSm.StateId.CHANNEL_ENTRY;
+            this.#ancestorEventHandler = null;
+            return;
+        } // end of behavior for CHANNEL_SELECT
+    }
+    
     #CHANNEL_SELECT_b2_long_press()
     {
         // No ancestor state handles `b2_long_press` event.
@@ -544,24 +711,31 @@ class TvRemoteSm
             // Step 3: Enter/move towards transition target `BRIGHTNESS_CHANGE`.
             this.#BRIGHTNESS_CHANGE_enter();
             
-            // BRIGHTNESS_CHANGE.<InitialState> behavior
-            // uml: TransitionTo(BRIGHTNESS_CHANGE__INITIAL)
-            {
-                // Step 1: Exit states until we reach `BRIGHTNESS_CHANGE` state (Least Common Ancestor for transition). Already at LCA, no exiting required.
-                
-                // Step 2: Transition action: ``.
-                
-                // Step 3: Enter/move towards transition target `BRIGHTNESS_CHANGE__INITIAL`.
-                this.#BRIGHTNESS_CHANGE__INITIAL_enter();
-                
-                // Step 4: complete transition. Ends event dispatch. No other behaviors are checked.
-                this.stateId = TvRemoteSm.StateId.BRIGHTNESS_CHANGE__INITIAL;
-                // No ancestor handles event. Can skip nulling `ancestorEventHandler`.
-                return;
-            } // end of behavior for BRIGHTNESS_CHANGE.<InitialState>
+            // Finish transition by calling pseudo state transition function.
+            this.#BRIGHTNESS_CHANGE_InitialState_transition();
+            return; // event processing immediately stops when a transition finishes. No other behaviors for this state are checked.
         } // end of behavior for CHANNEL_SELECT
     }
     
+    #CHANNEL_SELECT_InitialState_transition()
+    {
+        // CHANNEL_SELECT.<InitialState> behavior
+        // uml: TransitionTo(CHANNEL_SELECT__INITIAL)
+        {
+            // Step 1: Exit states until we reach `CHANNEL_SELECT` state (Least Common Ancestor for transition). Already at LCA, no exiting required.
+            
+            // Step 2: Transition action: ``.
+            
+            // Step 3: Enter/move towards transition target `CHANNEL_SELECT__INITIAL`.
+            this.#CHANNEL_SELECT__INITIAL_enter();
+            
+            // Step 4: complete transition. Ends event dispatch. No other behaviors are checked.
+            this.stateId = TvRemoteSm.StateId.CHANNEL_SELECT__INITIAL;
+            this.#ancestorEventHandler = null;
+            return;
+        } // end of behavior for CHANNEL_SELECT.<InitialState>
+    }
+    
     
     ////////////////////////////////////////////////////////////////////////////////
     // event handlers for state CHANNEL_DOWN
@@ -578,9 +752,9 @@ class TvRemoteSm
         // uml: enter / { show("Channel Down");\nchannel_decrement();\nprint_channel(); }
         {
             // Step 1: execute action `show("Channel Down");\nchannel_decrement();\nprint_channel();`
-            console.log("Channel Down");
+            this.vars.output.show("Channel Down");
             if (this.vars.channel <= MIN_CHANNEL) { this.vars.channel = MAX_CHANNEL; } else { this.vars.channel--; };
-            console.log(this.vars.channel);
+            this.vars.output.value("channel", this.vars.channel);
         } // end of behavior for CHANNEL_DOWN
     }
     
@@ -637,6 +811,139 @@ class TvRemoteSm
     }
     
     
+    ////////////////////////////////////////////////////////////////////////////////
+    // event handlers for state CHANNEL_ENTRY
+    ////////////////////////////////////////////////////////////////////////////////
+    
+    #CHANNEL_ENTRY_enter()
+    {
+        // setup trigger/event handlers
+        this.#currentStateExitHandler = this.#CHANNEL_ENTRY_exit;
+        this.#currentEventHandlers[TvRemoteSm.EventId.B1_DOUBLE_PRESS] = this.#CHANNEL_ENTRY_b1_double_press;
+        this.#currentEventHandlers[TvRemoteSm.EventId.B1_PRESS] = this.#CHANNEL_ENTRY_b1_press;
+        this.#currentEventHandlers[TvRemoteSm.EventId.B2_DOUBLE_PRESS] = this.#CHANNEL_ENTRY_b2_double_press;
+        this.#currentEventHandlers[TvRemoteSm.EventId.B2_PRESS] = this.#CHANNEL_ENTRY_b2_press;
+        
+        // CHANNEL_ENTRY behavior
+        // uml: enter / { show("Channel Entry");\nchannel_entry_start();\nprint_channel_entry(); }
+        {
+            // Step 1: execute action `show("Channel Entry");\nchannel_entry_start();\nprint_channel_entry();`
+            this.vars.output.show("Channel Entry");
+            this.vars.channel_entry = 0;
+            this.vars.output.value("channel_entry", this.vars.channel_entry);
+        } // end of behavior for CHANNEL_ENTRY
+    }
+    
+    #CHANNEL_ENTRY_exit()
+    {
+        // adjust function pointers for this state's exit
+        this.#currentStateExitHandler = this.#CHANNEL_SELECT_exit;
+        this.#currentEventHandlers[TvRemoteSm.EventId.B1_DOUBLE_PRESS] = this.#CHANNEL_SELECT_b1_double_press;  // the next ancestor that handles this event is CHANNEL_SELECT
+        this.#currentEventHandlers[TvRemoteSm.EventId.B1_PRESS] = null;  // no ancestor listens to this event
+        this.#currentEventHandlers[TvRemoteSm.EventId.B2_DOUBLE_PRESS] = this.#CHANNEL_SELECT_b2_double_press;  // the next ancestor that handles this event is CHANNEL_SELECT
+        this.#currentEventHandlers[TvRemoteSm.EventId.B2_PRESS] = null;  // no ancestor listens to this event
+    }
+    
+    #CHANNEL_ENTRY_b1_double_press()
+    {
+        // Setup handler for next ancestor that listens to `b1_double_press` event.
+        this.#ancestorEventHandler = this.#CHANNEL_SELECT_b1_double_press;
+        
+        // CHANNEL_ENTRY behavior
+        // uml: B1_DOUBLE_PRESS / { channel_entry_count(2);\nprint_channel_entry(); }
+        {
+            // Step 1: execute action `channel_entry_count(2);\nprint_channel_entry();`
+            this.vars.channel_entry = this.vars.channel_entry - this.vars.channel_entry % 10 + (this.vars.channel_entry % 10 + 2) % 10;
+            this.vars.output.value("channel_entry", this.vars.channel_entry);
+            
+            // Step 2: determine if ancestor gets to handle event next.
+            // Consume event.
+            this.#ancestorEventHandler = null;
+        } // end of behavior for CHANNEL_ENTRY
+    }
+    
+    #CHANNEL_ENTRY_b1_press()
+    {
+        // No ancestor state handles `b1_press` event.
+        
+        // CHANNEL_ENTRY behavior
+        // uml: B1_PRESS / { channel_entry_count(1);\nprint_channel_entry(); }
+        {
+            // Step 1: execute action `channel_entry_count(1);\nprint_channel_entry();`
+            this.vars.channel_entry = this.vars.channel_entry - this.vars.channel_entry % 10 + (this.vars.channel_entry % 10 + 1) % 10;
+            this.vars.output.value("channel_entry", this.vars.channel_entry);
+            
+            // Step 2: determine if ancestor gets to handle event next.
+            // Consume event.
+            // No ancestor handles event. Can skip nulling `ancestorEventHandler`.
+        } // end of behavior for CHANNEL_ENTRY
+    }
+    
+    #CHANNEL_ENTRY_b2_double_press()
+    {
+        // Setup handler for next ancestor that listens to `b2_double_press` event.
+        this.#ancestorEventHandler = this.#CHANNEL_SELECT_b2_double_press;
+        
+        // CHANNEL_ENTRY behavior
+        // uml: B2_DOUBLE_PRESS / { show("Channel Select");\nchannel_entry_apply();\nprint_channel(); } TransitionTo(CHANNEL_SELECT__INITIAL)
+        {
+            // Step 1: Exit states until we reach `CHANNEL_SELECT` state (Least Common Ancestor for transition).
+            this.#CHANNEL_ENTRY_exit();
+            
+            // Step 2: Transition action: `show("Channel Select");\nchannel_entry_apply();\nprint_channel();`.
+            this.vars.output.show("Channel Select");
+            if (this.vars.channel_entry >= MIN_CHANNEL && this.vars.channel_entry <= MAX_CHANNEL) { this.vars.channel = this.vars.channel_entry; } this.vars.channel_entry = 0;
+            this.vars.output.value("channel", this.vars.channel);
+            
+            // Step 3: Enter/move towards transition target `CHANNEL_SELECT__INITIAL`.
+            this.#CHANNEL_SELECT__INITIAL_enter();
+            
+            // Step 4: complete transition. Ends event dispatch. No other behaviors are checked.
+            this.stateId = TvRemoteSm.StateId.CHANNEL_SELECT__INITIAL;
+            this.#ancestorEventHandler = null;
+            return;
+        } // end of behavior for CHANNEL_ENTRY
+    }
+    
+    #CHANNEL_ENTRY_b2_press()
+    {
+        // No ancestor state handles `b2_press` event.
+        
+        // CHANNEL_ENTRY behavior
+        // uml: 1. B2_PRESS [channel_entry_full()] / { show("Channel Select");\nchannel_entry_apply();\nprint_channel(); } TransitionTo(CHANNEL_SELECT__INITIAL)
+        if (this.vars.channel_entry * 10 > MAX_CHANNEL)
+        {
+            // Step 1: Exit states until we reach `CHANNEL_SELECT` state (Least Common Ancestor for transition).
+            this.#CHANNEL_ENTRY_exit();
+            
+            // Step 2: Transition action: `show("Channel Select");\nchannel_entry_apply();\nprint_channel();`.
+            this.vars.output.show("Channel Select");
+            if (this.vars.channel_entry >= MIN_CHANNEL && this.vars.channel_entry <= MAX_CHANNEL) { this.vars.channel = this.vars.channel_entry; } this.vars.channel_entry = 0;
+            this.vars.output.value("channel", this.vars.channel);
+            
+            // Step 3: Enter/move towards transition target `CHANNEL_SELECT__INITIAL`.
+            this.#CHANNEL_SELECT__INITIAL_enter();
+            
+            // Step 4: complete transition. Ends event dispatch. No other behaviors are checked.
+            this.stateId = TvRemoteSm.StateId.CHANNEL_SELECT__INITIAL;
+            // No ancestor handles event. Can skip nulling `ancestorEventHandler`.
+            return;
+        } // end of behavior for CHANNEL_ENTRY
+        
+        // CHANNEL_ENTRY behavior
+        // uml: 2. B2_PRESS / { channel_entry_next_digit();\nprint_channel_entry(); }
+        {
+            // Step 1: execute action `channel_entry_next_digit();\nprint_channel_entry();`
+            this.vars.channel_entry *= 10;
+            this.vars.output.value("channel_entry", this.vars.channel_entry);
+            
+            // Step 2: determine if ancestor gets to handle event next.
+            // Consume event.
+            // No ancestor handles event. Can skip nulling `ancestorEventHandler`.
+        } // end of behavior for CHANNEL_ENTRY
+    }
+    
+    
     ////////////////////////////////////////////////////////////////////////////////
     // event handlers for state CHANNEL_SELECT__INITIAL
     ////////////////////////////////////////////////////////////////////////////////
@@ -717,9 +1024,9 @@ class TvRemoteSm
         // uml: enter / { show("Channel Up");\nchannel_increment();\nprint_channel(); }
         {
             // Step 1: execute action `show("Channel Up");\nchannel_increment();\nprint_channel();`
-            console.log("Channel Up");
+            this.vars.output.show("Channel Up");
             if (this.vars.channel >= MAX_CHANNEL) { this.vars.channel = MIN_CHANNEL; } else { this.vars.channel++; };
-            console.log(this.vars.channel);
+            this.vars.output.value("channel", this.vars.channel);
         } // end of behavior for CHANNEL_UP
     }
     
@@ -790,7 +1097,7 @@ class TvRemoteSm
         // uml: enter / { show("Volume Change"); }
         {
             // Step 1: execute action `show("Volume Change");`
-            console.log("Volume Change");
+            this.vars.output.show("Volume Change");
         } // end of behavior for VOLUME_CHANGE
     }
     
@@ -816,21 +1123,9 @@ class TvRemoteSm
             // Step 3: Enter/move towards transition target `CHANNEL_SELECT`.
             this.#CHANNEL_SELECT_enter();
             
-            // CHANNEL_SELECT.<InitialState> behavior
-            // uml: TransitionTo(CHANNEL_SELECT__INITIAL)
-            {
-                // Step 1: Exit states until we reach `CHANNEL_SELECT` state (Least Common Ancestor for transition). Already at LCA, no exiting required.
-                
-                // Step 2: Transition action: ``.
-                
-                // Step 3: Enter/move towards transition target `CHANNEL_SELECT__INITIAL`.
-                this.#CHANNEL_SELECT__INITIAL_enter();
-                
-                // Step 4: complete transition. Ends event dispatch. No other behaviors are checked.
-                this.stateId = TvRemoteSm.StateId.CHANNEL_SELECT__INITIAL;
-                // No ancestor handles event. Can skip nulling `ancestorEventHandler`.
-                return;
-            } // end of behavior for CHANNEL_SELECT.<InitialState>
+            // Finish transition by calling pseudo state transition function.
+            this.#CHANNEL_SELECT_InitialState_transition();
+            return; // event processing immediately stops when a transition finishes. No other behaviors for this state are checked.
         } // end of behavior for VOLUME_CHANGE
     }
     
@@ -934,9 +1229,9 @@ class TvRemoteSm
         // uml: enter / { show("Volume Down");\nvolume_decrement();\nprint_volume(); }
         {
             // Step 1: execute action `show("Volume Down");\nvolume_decrement();\nprint_volume();`
-            console.log("Volume Down");
+            this.vars.output.show("Volume Down");
             if (this.vars.volume > MIN_VOLUME) { this.vars.volume--; };
-            console.log(this.vars.volume);
+            this.vars.output.value("volume", this.vars.volume);
         } // end of behavior for VOLUME_DOWN
     }
     
@@ -1008,9 +1303,9 @@ class TvRemoteSm
         // uml: enter / { show("Volume Up");\nvolume_increment();\nprint_volume(); }
         {
             // Step 1: execute action `show("Volume Up");\nvolume_increment();\nprint_volume();`
-            console.log("Volume Up");
+            this.vars.output.show("Volume Up");
             if (this.vars.volume < MAX_VOLUME) { this.vars.volume++; };
-            console.log(this.vars.volume);
+            this.vars.output.value("volume", this.vars.volume);
         } // end of behavior for VOLUME_UP
     }
     
@@ -1080,6 +1375,7 @@ class TvRemoteSm
             case TvRemoteSm.StateId.BRIGHTNESS_UP: return "BRIGHTNESS_UP";
             case TvRemoteSm.StateId.CHANNEL_SELECT: return "CHANNEL_SELECT";
             case TvRemoteSm.StateId.CHANNEL_DOWN: return "CHANNEL_DOWN";
+            case TvRemoteSm.StateId.CHANNEL_ENTRY: return "CHANNEL_ENTRY";
             case TvRemoteSm.StateId.CHANNEL_SELECT__INITIAL: return "CHANNEL_SELECT__INITIAL";
             case TvRemoteSm.StateId.CHANNEL_UP: return "CHANNEL_UP";
             case TvRemoteSm.StateId.VOLUME_CHANGE: return "VOLUME_CHANGE";
@@ -1095,10 +1391,14 @@ class TvRemoteSm
     {
         switch (id)
         {
+            case TvRemoteSm.EventId.B1_DOUBLE_PRESS: return "B1_DOUBLE_PRESS";
             case TvRemoteSm.EventId.B1_LONG_PRESS: return "B1_LONG_PRESS";
             case TvRemoteSm.EventId.B1_PRESS: return "B1_PRESS";
+            case TvRemoteSm.EventId.B2_DOUBLE_PRESS: return "B2_DOUBLE_PRESS";
             case TvRemoteSm.EventId.B2_LONG_PRESS: return "B2_LONG_PRESS";
             case TvRemoteSm.EventId.B2_PRESS: return "B2_PRESS";
+            case TvRemoteSm.EventId.B2_TRIPLE_PRESS: return "B2_TRIPLE_PRESS";
+            case TvRemoteSm.EventId.CHORD_PRESS: return "CHORD_PRESS";
             default: return "?";
         }
     }
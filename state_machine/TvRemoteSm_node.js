@@ -0,0 +1,38 @@
+// Not generated. Runs the generated JavaScript machine in Node, without index.html.
+//
+//   const { TvRemoteSm, NULL_OUTPUT } = require("./state_machine/TvRemoteSm_node.js");
+//   const sm = new TvRemoteSm();
+//   sm.vars.output = { show(message) { ... }, value(field, value) { ... } }; // or NULL_OUTPUT
+//   sm.start();
+//   sm.dispatchEvents(Uint8Array.of(TvRemoteSm.EventId.B1_LONG_PRESS, TvRemoteSm.EventId.B2_PRESS));
+//
+// TvRemoteSm.js is a plain script (index.html loads it with a <script> tag), so it is run here in a
+// function of its own & its class returned. Its output goes to the console until `vars.output` is set.
+
+"use strict";
+
+const fs = require("fs");
+const path = require("path");
+const vm = require("vm");
+
+const MACHINE_FILE = path.join(__dirname, "TvRemoteSm.js");
+
+// On the first line of the wrapper, so stack traces have the line numbers of TvRemoteSm.js.
+const { TvRemoteSm, CONSOLE_OUTPUT } = vm.runInThisContext(
+    "(function () {" + fs.readFileSync(MACHINE_FILE, "utf8") + "\nreturn { TvRemoteSm, CONSOLE_OUTPUT };\n})",
+    { filename: MACHINE_FILE })();
+
+// Discards the output actions, like `tv_output_null_sink`.
+const NULL_OUTPUT = Object.freeze({ show() {}, value() {} });
+
+// Dispatch the event ids of `events` (a Uint8Array, or any array of TvRemoteSm.EventId) in order.
+// Ids that aren't events are ignored, as by dispatchEvent(). Returns the number of ids.
+TvRemoteSm.prototype.dispatchEvents = function (events) {
+    const count = events.length;
+    for (let i = 0; i < count; i++) {
+        this.dispatchEvent(events[i]);
+    }
+    return count;
+};
+
+module.exports = { TvRemoteSm, CONSOLE_OUTPUT, NULL_OUTPUT };
@@ -0,0 +1,133 @@
+#include "state_machine/TvRemoteSm_persist.h"
+
+#include <errno.h> // for errno
+#include <fcntl.h> // for open
+#include <stdio.h> // for snprintf
+#include <stdlib.h> // for strtoul
+#include <string.h> // for strcmp
+#include <unistd.h> // for fsync
+
+#include "channels/channel_table.h"
+#include "state_machine/TvRemoteSm_restore.h"
+
+#define FILE_SIZE 512
+#define PATH_SIZE 4096
+
+// Defined at the top of the generated TvRemoteSm.c (see code_gen.csx).
+extern const unsigned short MIN_VOLUME;
+extern const unsigned short MAX_VOLUME;
+extern const unsigned short MIN_BRIGHTNESS;
+extern const unsigned short MAX_BRIGHTNESS;
+extern const unsigned short MAX_CHANNEL;
+
+bool TvRemoteSm_persist_save(const TvRemoteSm* sm, const char* path)
+{
+    char text[FILE_SIZE];
+    const int length = snprintf(text, sizeof(text), "state %s\nvolume %u\nbrightness %u\nchannel %u\nchannel_entry %u\n",
+        TvRemoteSm_state_id_to_string(sm->state_id), sm->vars.volume, sm->vars.brightness, sm->vars.channel,
+        sm->vars.channel_entry);
+    char temporary[PATH_SIZE];
+    if (snprintf(temporary, sizeof(temporary), "%s.tmp", path) >= (int)sizeof(temporary))
+    {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    const int fd = open(temporary, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1)
+    {
+        return false;
+    }
+    if (write(fd, text, (size_t)length) != length || fsync(fd) == -1)
+    {
+        const int error = (errno != 0) ? errno : EIO;
+        close(fd);
+        unlink(temporary);
+        errno = error;
+        return false;
+    }
+    if (close(fd) == -1 || rename(temporary, path) == -1)
+    {
+        const int error = errno;
+        unlink(temporary);
+        errno = error;
+        return false;
+    }
+    return true;
+}
+
+// The value of `name` in `text`, or -1 if it's missing or out of [0, 65535].
+static long field(const char* text, const char* name)
+{
+    const size_t length = strlen(name);
+    for (const char* line = text; line != NULL && *line != '\0'; line = strchr(line, '\n') ? strchr(line, '\n') + 1 : NULL)
+    {
+        if (strncmp(line, name, length) == 0 && line[length] == ' ')
+        {
+            char* end;
+            const unsigned long value = strtoul(line + length + 1, &end, 10);
+            return (end != line + length + 1 && (*end == '\n' || *end == '\0') && value <= 0xffff) ? (long)value : -1;
+        }
+    }
+    return -1;
+}
+
+// Whether the machine could have these values: a hand-edited or stale file may have anything.
+static bool values_are_valid(const TvRemoteSm* sm, const TvRemoteSm_StateId state_id, const long volume,
+    const long brightness, const long channel, const long channel_entry)
+{
+    // At most 3 digits are typed in CHANNEL_ENTRY, and nothing is left over outside it.
+    const long max_channel_entry = (state_id == TvRemoteSm_StateId_CHANNEL_ENTRY) ? MAX_CHANNEL / 10 * 10 + 9 : 0;
+    return volume >= MIN_VOLUME && volume <= MAX_VOLUME && brightness >= MIN_BRIGHTNESS && brightness <= MAX_BRIGHTNESS
+        && channel_table_is_enabled(sm->vars.channels, (unsigned short)channel) && channel_entry <= max_channel_entry;
+}
+
+bool TvRemoteSm_persist_load(TvRemoteSm* sm, const char* path)
+{
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        return false;
+    }
+    char text[FILE_SIZE];
+    const ssize_t size = read(fd, text, sizeof(text) - 1);
+    close(fd);
+    if (size < 0)
+    {
+        return false;
+    }
+    text[size] = '\0';
+
+    int state_id = -1;
+    const char* state = strstr(text, "state ");
+    if (state == text || (state != NULL && state[-1] == '\n'))
+    {
+        const size_t length = strcspn(state + 6, "\n");
+        for (int id = 0; id < TvRemoteSm_StateIdCount; id++)
+        {
+            const char* name = TvRemoteSm_state_id_to_string((TvRemoteSm_StateId)id);
+            if (strlen(name) == length && strncmp(state + 6, name, length) == 0)
+            {
+                state_id = id;
+            }
+        }
+    }
+    const long volume = field(text, "volume");
+    const long brightness = field(text, "brightness");
+    const long channel = field(text, "channel");
+    const long channel_entry = field(text, "channel_entry");
+    TvRemoteSm_restore_init();
+    if (state_id < 0 || volume < 0 || brightness < 0 || channel < 0 || channel_entry < 0
+        || !TvRemoteSm_restore_is_reachable((TvRemoteSm_StateId)state_id)
+        || !values_are_valid(sm, (TvRemoteSm_StateId)state_id, volume, brightness, channel, channel_entry))
+    {
+        errno = EINVAL;
+        return false;
+    }
+    TvRemoteSm_Vars vars = sm->vars;
+    vars.volume = (unsigned short)volume;
+    vars.brightness = (unsigned short)brightness;
+    vars.channel = (unsigned short)channel;
+    vars.channel_entry = (unsigned short)channel_entry;
+    vars.changed = TV_CHANGED_ALL;
+    return TvRemoteSm_restore(sm, (TvRemoteSm_StateId)state_id, &vars);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+// Not generated. Saves the active state & vars of a TvRemoteSm to a file & restores them, so the
+// remote comes back as it was after a restart.
+//
+// The file is text, one "name value" per line:
+//   state VOLUME_UP
+//   volume 50
+//   brightness 50
+//   channel 7
+//   channel_entry 0
+// The state is stored by name, so a file still loads after the diagram has renumbered its states.
+// It is written to PATH.tmp, synced & renamed over PATH, so a crash leaves the old file or the new one.
+
+#include <stdbool.h> // for bool
+
+#include "state_machine/TvRemoteSm.h"
+
+// Save the state & vars of `sm` to `path`. Returns false (errno is set).
+bool TvRemoteSm_persist_save(const TvRemoteSm* sm, const char* path);
+
+// Put `sm` into the state saved in `path` with its vars, keeping its output & channels. No output
+// actions run. Returns false (errno is set: ENOENT if there is no file, EINVAL if it is malformed, the
+// state isn't reachable or a value is out of range or not in the lineup of `sm`) & leaves `sm` as it was.
+bool TvRemoteSm_persist_load(TvRemoteSm* sm, const char* path);
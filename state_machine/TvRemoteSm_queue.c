@@ -0,0 +1,114 @@
+#include "state_machine/TvRemoteSm_queue.h"
+
+#include <limits.h> // for INT_MAX
+
+// Posting from a signal handler must not take a lock.
+_Static_assert(ATOMIC_INT_LOCK_FREE == 2, "atomic_uint must be lock-free");
+
+#define MASK (TV_REMOTE_SM_QUEUE_CAPACITY - 1)
+
+static void ring_init(TvRemoteSm_QueueRing* ring)
+{
+    atomic_init(&ring->head, 0);
+    ring->tail = 0;
+    for (unsigned int i = 0; i < TV_REMOTE_SM_QUEUE_CAPACITY; i++)
+    {
+        atomic_init(&ring->sequence[i], i);
+    }
+}
+
+static bool ring_post(TvRemoteSm_QueueRing* ring, const TvRemoteSm_EventId event_id)
+{
+    unsigned int position = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    for (;;)
+    {
+        const unsigned int sequence = atomic_load_explicit(&ring->sequence[position & MASK], memory_order_acquire);
+        const int difference = (int)(sequence - position);
+        if (difference == 0)
+        {
+            // The slot is free: claim the position (a failed exchange reloads it).
+            if (atomic_compare_exchange_weak_explicit(&ring->head, &position, position + 1,
+                    memory_order_relaxed, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // The slot still holds the event posted one lap ago.
+            return false;
+        }
+        else
+        {
+            position = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+    }
+    ring->events[position & MASK] = (unsigned char)event_id;
+    atomic_store_explicit(&ring->sequence[position & MASK], position + 1, memory_order_release);
+    return true;
+}
+
+static bool ring_take(TvRemoteSm_QueueRing* ring, TvRemoteSm_EventId* event_id)
+{
+    const unsigned int position = ring->tail;
+    const unsigned int sequence = atomic_load_explicit(&ring->sequence[position & MASK], memory_order_acquire);
+    // Empty, or the next post is still being written (it is dispatched by the next drain).
+    if (sequence != position + 1)
+    {
+        return false;
+    }
+    *event_id = (TvRemoteSm_EventId)ring->events[position & MASK];
+    atomic_store_explicit(&ring->sequence[position & MASK], position + TV_REMOTE_SM_QUEUE_CAPACITY, memory_order_release);
+    ring->tail = position + 1;
+    return true;
+}
+
+void TvRemoteSm_queue_init(TvRemoteSm_Queue* queue, TvRemoteSm* sm)
+{
+    queue->sm = sm;
+    ring_init(&queue->priority);
+    ring_init(&queue->normal);
+    atomic_init(&queue->dropped, 0);
+    queue->dispatching = false;
+}
+
+bool TvRemoteSm_queue_is_priority(const TvRemoteSm_EventId event_id)
+{
+    return event_id == TvRemoteSm_EventId_B1_LONG_PRESS;
+}
+
+bool TvRemoteSm_queue_post(TvRemoteSm_Queue* queue, const TvRemoteSm_EventId event_id)
+{
+    TvRemoteSm_QueueRing* ring = TvRemoteSm_queue_is_priority(event_id) ? &queue->priority : &queue->normal;
+    if (!ring_post(ring, event_id))
+    {
+        atomic_fetch_add_explicit(&queue->dropped, 1, memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+int TvRemoteSm_queue_dispatch_batch(TvRemoteSm_Queue* queue, const int max)
+{
+    if (queue->dispatching)
+    {
+        return 0;
+    }
+    queue->dispatching = true;
+    int count = 0;
+    TvRemoteSm_EventId event_id;
+    // The priority ring is checked before every event, so a power event posted by an action or a
+    // signal handler runs next.
+    while (count < max && (ring_take(&queue->priority, &event_id) || ring_take(&queue->normal, &event_id)))
+    {
+        TvRemoteSm_dispatch_event(queue->sm, event_id);
+        count++;
+    }
+    queue->dispatching = false;
+    return count;
+}
+
+int TvRemoteSm_queue_dispatch_all(TvRemoteSm_Queue* queue)
+{
+    return TvRemoteSm_queue_dispatch_batch(queue, INT_MAX);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+// Not generated. A run-to-completion event queue in front of a TvRemoteSm.
+//
+// `TvRemoteSm_dispatch_event()` must not be called while it is running, so an action that raises
+// another event, or an input that arrives in a signal handler or from another thread during a
+// dispatch, posts it here instead. Events are dispatched one after the other, each to completion, by
+// whoever drains the queue: an event posted by an action runs after the one that posted it.
+//
+// Posting is lock-free (a bounded ring with a sequence number per slot), so it is safe from any
+// thread & from signal handlers. Draining must happen on one thread at a time. `B1_LONG_PRESS` (power
+// on/off) goes to a ring of its own that is drained first, so it doesn't wait behind a backlog of
+// other events.
+
+#include <stdatomic.h> // for atomic_uint
+#include <stdbool.h> // for bool
+
+#include "state_machine/TvRemoteSm.h"
+
+// Events per ring. Must be a power of two.
+#define TV_REMOTE_SM_QUEUE_CAPACITY 64
+
+_Static_assert((TV_REMOTE_SM_QUEUE_CAPACITY & (TV_REMOTE_SM_QUEUE_CAPACITY - 1)) == 0,
+    "TV_REMOTE_SM_QUEUE_CAPACITY must be a power of two");
+
+typedef struct TvRemoteSm_QueueRing
+{
+    // Free running positions: the next one to post (any thread) & to dispatch (the draining thread).
+    atomic_uint head;
+    unsigned int tail;
+    // Position + 1 once the slot holds the event posted at that position, position + capacity once
+    // it has been dispatched & can be posted to again.
+    atomic_uint sequence[TV_REMOTE_SM_QUEUE_CAPACITY];
+    unsigned char events[TV_REMOTE_SM_QUEUE_CAPACITY];
+} TvRemoteSm_QueueRing;
+
+typedef struct TvRemoteSm_Queue
+{
+    TvRemoteSm* sm;
+    TvRemoteSm_QueueRing priority;
+    TvRemoteSm_QueueRing normal;
+    // Posts that found their ring full.
+    atomic_uint dropped;
+    // Set while draining, so a drain started by an action returns right away.
+    bool dispatching;
+} TvRemoteSm_Queue;
+
+// An empty queue in front of `sm` (constructed, started or not).
+void TvRemoteSm_queue_init(TvRemoteSm_Queue* queue, TvRemoteSm* sm);
+
+// True for the events that go ahead of the others (B1_LONG_PRESS).
+bool TvRemoteSm_queue_is_priority(const TvRemoteSm_EventId event_id);
+
+// Add `event_id` to the queue. Returns false (& counts it in `dropped`) if its ring is full.
+// Async-signal-safe & thread safe.
+bool TvRemoteSm_queue_post(TvRemoteSm_Queue* queue, const TvRemoteSm_EventId event_id);
+
+// Dispatch up to `max` queued events, including the ones posted meanwhile. Returns how many ran, 0
+// when called from inside a drain (the outer drain runs the events).
+int TvRemoteSm_queue_dispatch_batch(TvRemoteSm_Queue* queue, const int max);
+
+// Dispatch until the queue is empty.
+int TvRemoteSm_queue_dispatch_all(TvRemoteSm_Queue* queue);
@@ -0,0 +1,84 @@
+#include "state_machine/TvRemoteSm_restore.h"
+
+#include <string.h> // for memcpy
+
+typedef struct StateTemplate {
+    bool reachable;
+    int path_length;
+    TvRemoteSm_EventId path[TV_REMOTE_SM_MAX_PATH];
+    TvRemoteSm sm;
+} StateTemplate;
+
+static StateTemplate templates[TvRemoteSm_StateIdCount];
+static bool initialized = false;
+
+void TvRemoteSm_restore_init(void)
+{
+    if (initialized)
+    {
+        return;
+    }
+
+    TvRemoteSm start;
+    TvRemoteSm_ctor(&start);
+    start.vars.output = &tv_output_null_sink;
+    TvRemoteSm_start(&start);
+
+    templates[start.state_id].reachable = true;
+    templates[start.state_id].path_length = 0;
+    templates[start.state_id].sm = start;
+
+    // Breadth first over the states so every template has the shortest path.
+    TvRemoteSm_StateId queue[TvRemoteSm_StateIdCount];
+    int head = 0;
+    int tail = 0;
+    queue[tail++] = start.state_id;
+    while (head < tail)
+    {
+        const StateTemplate* from = &templates[queue[head++]];
+        for (int event = 0; event < TvRemoteSm_EventIdCount; event++)
+        {
+            TvRemoteSm sm = from->sm;
+            TvRemoteSm_dispatch_event(&sm, (TvRemoteSm_EventId)event);
+
+            StateTemplate* to = &templates[sm.state_id];
+            if (to->reachable)
+            {
+                continue;
+            }
+            to->reachable = true;
+            to->sm = sm;
+            memcpy(to->path, from->path, sizeof(from->path[0]) * (size_t)from->path_length);
+            to->path[from->path_length] = (TvRemoteSm_EventId)event;
+            to->path_length = from->path_length + 1;
+            queue[tail++] = sm.state_id;
+        }
+    }
+    initialized = true;
+}
+
+bool TvRemoteSm_restore_is_reachable(const TvRemoteSm_StateId state_id)
+{
+    return (int)state_id < TvRemoteSm_StateIdCount && templates[state_id].reachable;
+}
+
+bool TvRemoteSm_restore(TvRemoteSm* sm, const TvRemoteSm_StateId state_id, const TvRemoteSm_Vars* vars)
+{
+    if (!TvRemoteSm_restore_is_reachable(state_id))
+    {
+        return false;
+    }
+    *sm = templates[state_id].sm;
+    sm->vars = *vars;
+    return true;
+}
+
+int TvRemoteSm_restore_path(const TvRemoteSm_StateId state_id, TvRemoteSm_EventId path[TV_REMOTE_SM_MAX_PATH])
+{
+    if (!TvRemoteSm_restore_is_reachable(state_id))
+    {
+        return -1;
+    }
+    memcpy(path, templates[state_id].path, sizeof(path[0]) * (size_t)templates[state_id].path_length);
+    return templates[state_id].path_length;
+}
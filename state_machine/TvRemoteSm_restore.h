@@ -0,0 +1,29 @@
+#pragma once
+
+// Not generated. Puts a TvRemoteSm into any reachable state without replaying its history.
+//
+// The generated machine keeps its active state as a set of handler pointers, so `state_id` alone
+// can't be written back. Instead a template machine is driven into every reachable state once
+// (breadth first over the events, output discarded) and restoring a state copies its template.
+// The handler pointers only depend on the active state (not on the vars the guards read), so the
+// vars are simply written afterwards.
+
+#include <stdbool.h> // for bool
+
+#include "state_machine/TvRemoteSm.h"
+
+// The longest event path from `TvRemoteSm_start()` to a reachable state.
+#define TV_REMOTE_SM_MAX_PATH TvRemoteSm_StateIdCount
+
+// Build the templates. Not thread safe; call once before using the functions below from any thread.
+void TvRemoteSm_restore_init(void);
+
+// True if `state_id` can be active after `TvRemoteSm_start()` (i.e. it is a reachable leaf state).
+bool TvRemoteSm_restore_is_reachable(const TvRemoteSm_StateId state_id);
+
+// Put `sm` into `state_id` with `vars`. No output actions run. Returns false if the state isn't reachable.
+// Thread safe after `TvRemoteSm_restore_init()`.
+bool TvRemoteSm_restore(TvRemoteSm* sm, const TvRemoteSm_StateId state_id, const TvRemoteSm_Vars* vars);
+
+// The shortest event path from `TvRemoteSm_start()` to `state_id`. Returns the path length or -1.
+int TvRemoteSm_restore_path(const TvRemoteSm_StateId state_id, TvRemoteSm_EventId path[TV_REMOTE_SM_MAX_PATH]);
@@ -0,0 +1,144 @@
+// Not generated. The TvSmPlugin of the generated machine, built into tvremote_sm.so with
+// TvRemoteSm.c, TvRemoteSm_restore.c & the output & channel table code it calls. Compiled with
+// hidden visibility, so only the entry point is exported & nothing clashes with the host's copy.
+
+#include "state_machine/sm_plugin.h"
+
+#include <stdio.h> // for snprintf
+#include <string.h> // for strcmp
+
+#include "state_machine/TvRemoteSm.h"
+#include "state_machine/TvRemoteSm_restore.h"
+
+// The vars that are migrated by name (all unsigned short). Add the numeric vars of the diagram here.
+#define VAR(name) { #name, offsetof(TvRemoteSm_Vars, name) }
+static const struct {
+    const char* name;
+    size_t offset;
+} VARS[] = {
+    VAR(volume),
+    VAR(brightness),
+    VAR(channel),
+    VAR(channel_entry),
+};
+#define VAR_COUNT ((int)(sizeof(VARS) / sizeof(VARS[0])))
+
+_Static_assert(VAR_COUNT <= TV_SM_MAX_VARS, "too many vars for TvSmSnapshot");
+
+static unsigned short* var_at(TvRemoteSm_Vars* vars, const int var)
+{
+    return (unsigned short*)((char*)vars + VARS[var].offset);
+}
+
+static const char* event_name(const int event_id)
+{
+    return TvRemoteSm_event_id_to_string((TvRemoteSm_EventId)event_id);
+}
+
+static void ctor(void* sm, const TvOutputSink* output, const ChannelTable* channels)
+{
+    TvRemoteSm* machine = sm;
+    TvRemoteSm_ctor(machine);
+    machine->vars.output = output;
+    machine->vars.channels = channels;
+}
+
+static void start(void* sm)
+{
+    TvRemoteSm_start(sm);
+}
+
+static void dispatch(void* sm, const int event_id)
+{
+    TvRemoteSm_dispatch_event(sm, (TvRemoteSm_EventId)event_id);
+}
+
+static bool handles(const void* sm, const int event_id)
+{
+    return ((const TvRemoteSm*)sm)->current_event_handlers[event_id] != NULL;
+}
+
+static const char* state_name(const void* sm)
+{
+    return TvRemoteSm_state_id_to_string(((const TvRemoteSm*)sm)->state_id);
+}
+
+static void snapshot(const void* sm, TvSmSnapshot* snapshot)
+{
+    const TvRemoteSm* machine = sm;
+    TvRemoteSm_Vars vars = machine->vars;
+    memset(snapshot, 0, sizeof(*snapshot));
+    snprintf(snapshot->state, sizeof(snapshot->state), "%s", state_name(sm));
+    for (int i = 0; i < VAR_COUNT; i++)
+    {
+        snprintf(snapshot->var_names[i], sizeof(snapshot->var_names[i]), "%s", VARS[i].name);
+        snapshot->var_values[i] = *var_at(&vars, i);
+    }
+    snapshot->var_count = VAR_COUNT;
+}
+
+// Set the vars `snapshot` has by name.
+static void apply_vars(TvRemoteSm_Vars* vars, const TvSmSnapshot* snapshot)
+{
+    for (int i = 0; i < VAR_COUNT; i++)
+    {
+        for (int s = 0; s < snapshot->var_count; s++)
+        {
+            if (strcmp(VARS[i].name, snapshot->var_names[s]) == 0)
+            {
+                *var_at(vars, i) = (unsigned short)snapshot->var_values[s];
+            }
+        }
+    }
+}
+
+static bool restore(void* sm, const TvSmSnapshot* snapshot)
+{
+    TvRemoteSm* machine = sm;
+    for (int id = 0; id < TvRemoteSm_StateIdCount; id++)
+    {
+        if (strcmp(TvRemoteSm_state_id_to_string((TvRemoteSm_StateId)id), snapshot->state) == 0)
+        {
+            // The initial values are those of a machine just started with the same lineup.
+            TvRemoteSm initial;
+            TvRemoteSm_ctor(&initial);
+            initial.vars.output = &tv_output_null_sink;
+            initial.vars.channels = machine->vars.channels;
+            TvRemoteSm_start(&initial);
+            TvRemoteSm_Vars vars = initial.vars;
+            vars.output = machine->vars.output;
+            vars.changed = machine->vars.changed;
+            apply_vars(&vars, snapshot);
+            if (TvRemoteSm_restore(machine, (TvRemoteSm_StateId)id, &vars))
+            {
+                return true;
+            }
+            break;
+        }
+    }
+    TvRemoteSm_start(machine);
+    apply_vars(&machine->vars, snapshot);
+    return false;
+}
+
+static const TvSmPlugin plugin = {
+    .abi_version = TV_SM_PLUGIN_ABI_VERSION,
+    .instance_size = sizeof(TvRemoteSm),
+    .event_count = TvRemoteSm_EventIdCount,
+    .event_name = event_name,
+    .ctor = ctor,
+    .start = start,
+    .dispatch = dispatch,
+    .handles = handles,
+    .state_name = state_name,
+    .snapshot = snapshot,
+    .restore = restore,
+};
+
+__attribute__((visibility("default")))
+const TvSmPlugin* tvremote_sm_plugin(void)
+{
+    // Drives a template machine through every state once, with the output discarded.
+    TvRemoteSm_restore_init();
+    return &plugin;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdbool.h> // for bool
+#include <stddef.h> // for size_t
+
+#include "channels/channel_table.h"
+#include "output/tv_output.h"
+
+// Not generated. The interface of the state machine built as a shared object (`tvremote_sm.so`, see
+// sm_plugin.c) for `remote --hot-reload`.
+//
+// The host never sees the layout of the generated TvRemoteSm: an instance is `instance_size` bytes it
+// allocates, events are numbered by the plugin (the host maps them by name) and the state & vars
+// cross from one build to the next by name in a TvSmSnapshot. So a regenerated machine with more
+// states, events or vars still loads, as long as TV_SM_PLUGIN_ABI_VERSION is unchanged. Only
+// TvOutputSink & ChannelTable are shared as they are, which are stable (the table is a file format).
+
+// Bump when TvSmPlugin or TvSmSnapshot change.
+#define TV_SM_PLUGIN_ABI_VERSION 1
+
+// The only symbol a plugin exports, a TvSmPluginEntry.
+#define TV_SM_PLUGIN_ENTRY "tvremote_sm_plugin"
+
+#define TV_SM_NAME_SIZE 32
+#define TV_SM_MAX_VARS 16
+
+// The active state & the numeric vars of a machine, by name.
+typedef struct TvSmSnapshot {
+    char state[TV_SM_NAME_SIZE];
+    int var_count;
+    char var_names[TV_SM_MAX_VARS][TV_SM_NAME_SIZE];
+    long var_values[TV_SM_MAX_VARS];
+} TvSmSnapshot;
+
+typedef struct TvSmPlugin {
+    unsigned int abi_version;
+    // Bytes of one machine, allocated by the host with at least max_align_t alignment.
+    size_t instance_size;
+    int event_count;
+    // Name of event `event_id` (0 <= event_id < event_count).
+    const char* (*event_name)(const int event_id);
+
+    // Construct `sm` with its output & channel lineup (either may be NULL, see TvRemoteSm_Vars).
+    void (*ctor)(void* sm, const TvOutputSink* output, const ChannelTable* channels);
+    void (*start)(void* sm);
+    void (*dispatch)(void* sm, const int event_id);
+    // Whether the active state (or one of its ancestors) handles `event_id`.
+    bool (*handles)(const void* sm, const int event_id);
+    const char* (*state_name)(const void* sm);
+
+    void (*snapshot)(const void* sm, TvSmSnapshot* snapshot);
+    // Put a constructed `sm` into the state of `snapshot` without running any action & set the vars
+    // it has by name (the others keep their initial values). If this machine has no such reachable
+    // state it is started instead & false is returned.
+    bool (*restore)(void* sm, const TvSmSnapshot* snapshot);
+} TvSmPlugin;
+
+typedef const TvSmPlugin* (*TvSmPluginEntry)(void);
@@ -0,0 +1,247 @@
+#include "state_machine/sm_reload.h"
+
+#include <dlfcn.h> // for dlopen
+#include <errno.h> // for errno
+#include <fcntl.h> // for open
+#include <libgen.h> // for dirname
+#include <stdio.h> // for fprintf
+#include <stdlib.h> // for calloc
+#include <string.h> // for strcmp
+#include <sys/inotify.h> // for inotify_init1
+#include <sys/stat.h> // for stat
+#include <time.h> // for clock_gettime
+#include <unistd.h> // for read
+
+#define COPY_BUFFER_SIZE 65536
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static long long stat_mtime_ns(const struct stat* info)
+{
+    return (long long)info->st_mtim.tv_sec * 1000000000LL + info->st_mtim.tv_nsec;
+}
+
+static void machine_dispatch(void* ctx, const int event_id)
+{
+    const TvSmModule* module = &((TvSmReloader*)ctx)->module;
+    const int plugin_event = module->events[event_id];
+    if (plugin_event >= 0)
+    {
+        module->plugin->dispatch(module->sm, plugin_event);
+    }
+}
+
+static bool machine_handles(void* ctx, const int event_id)
+{
+    const TvSmModule* module = &((TvSmReloader*)ctx)->module;
+    const int plugin_event = module->events[event_id];
+    return plugin_event >= 0 && module->plugin->handles(module->sm, plugin_event);
+}
+
+// Copy `path` to a new temporary file & return its name in `copy`. dlopen() returns the already loaded
+// object for a path it has seen, so every version is loaded from a name of its own.
+static bool copy_to_temporary(const char* path, char* copy, const size_t size)
+{
+    snprintf(copy, size, "/tmp/tvremote_sm-XXXXXX");
+    const int out = mkstemp(copy);
+    const int in = open(path, O_RDONLY | O_CLOEXEC);
+    bool ok = out != -1 && in != -1;
+    char buffer[COPY_BUFFER_SIZE];
+    ssize_t n;
+    while (ok && (n = read(in, buffer, sizeof(buffer))) != 0)
+    {
+        ok = n > 0 && write(out, buffer, (size_t)n) == n;
+    }
+    const int error = errno;
+    if (in != -1)
+    {
+        close(in);
+    }
+    if (out != -1)
+    {
+        close(out);
+        if (!ok)
+        {
+            unlink(copy);
+        }
+    }
+    errno = error;
+    return ok;
+}
+
+static void free_module(TvSmModule* module)
+{
+    free(module->sm);
+    if (module->handle != NULL)
+    {
+        dlclose(module->handle);
+    }
+    memset(module, 0, sizeof(*module));
+}
+
+// Load the current file of `reloader->path` & construct its machine (not started).
+static bool load_module(TvSmReloader* reloader, TvSmModule* module)
+{
+    memset(module, 0, sizeof(*module));
+    struct stat info;
+    if (stat(reloader->path, &info) == -1)
+    {
+        fprintf(stderr, "Cannot load %s: %s.\n", reloader->path, strerror(errno));
+        return false;
+    }
+    char copy[64];
+    if (!copy_to_temporary(reloader->path, copy, sizeof(copy)))
+    {
+        fprintf(stderr, "Cannot copy %s: %s.\n", reloader->path, strerror(errno));
+        return false;
+    }
+    module->handle = dlopen(copy, RTLD_NOW | RTLD_LOCAL);
+    // The mapping stays after the name is gone.
+    unlink(copy);
+    if (module->handle == NULL)
+    {
+        fprintf(stderr, "Cannot load %s: %s.\n", reloader->path, dlerror());
+        return false;
+    }
+    TvSmPluginEntry entry;
+    *(void**)&entry = dlsym(module->handle, TV_SM_PLUGIN_ENTRY);
+    module->plugin = (entry != NULL) ? entry() : NULL;
+    if (module->plugin == NULL || module->plugin->abi_version != TV_SM_PLUGIN_ABI_VERSION)
+    {
+        fprintf(stderr, "Cannot load %s: no %s with ABI version %d.\n", reloader->path, TV_SM_PLUGIN_ENTRY, TV_SM_PLUGIN_ABI_VERSION);
+        free_module(module);
+        return false;
+    }
+    module->sm = calloc(1, module->plugin->instance_size);
+    if (module->sm == NULL)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        free_module(module);
+        return false;
+    }
+    for (int event = 0; event < TvRemoteSm_EventIdCount; event++)
+    {
+        module->events[event] = -1;
+        for (int plugin_event = 0; plugin_event < module->plugin->event_count; plugin_event++)
+        {
+            if (strcmp(TvRemoteSm_event_id_to_string((TvRemoteSm_EventId)event), module->plugin->event_name(plugin_event)) == 0)
+            {
+                module->events[event] = plugin_event;
+                break;
+            }
+        }
+    }
+    module->plugin->ctor(module->sm, reloader->output, reloader->channels);
+
+    reloader->device = info.st_dev;
+    reloader->inode = info.st_ino;
+    reloader->mtime_ns = stat_mtime_ns(&info);
+    return true;
+}
+
+bool sm_reload_open(TvSmReloader* reloader, const char* path, const TvOutputSink* output, const ChannelTable* channels)
+{
+    memset(reloader, 0, sizeof(*reloader));
+    reloader->notify_fd = -1;
+    if (strlen(path) >= sizeof(reloader->path))
+    {
+        fprintf(stderr, "Cannot load %s: %s.\n", path, strerror(ENAMETOOLONG));
+        return false;
+    }
+    strcpy(reloader->path, path);
+    reloader->output = output;
+    reloader->channels = channels;
+    reloader->machine = (GestureMachine){ .dispatch = machine_dispatch, .handles = machine_handles, .ctx = reloader };
+    if (!load_module(reloader, &reloader->module))
+    {
+        return false;
+    }
+
+    char directory[sizeof(reloader->path)];
+    strcpy(directory, path);
+    reloader->notify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (reloader->notify_fd == -1
+        || inotify_add_watch(reloader->notify_fd, dirname(directory), IN_CLOSE_WRITE | IN_MOVED_TO) == -1)
+    {
+        fprintf(stderr, "Cannot watch %s: %s.\n", path, strerror(errno));
+        sm_reload_close(reloader);
+        return false;
+    }
+    reloader->module.plugin->start(reloader->module.sm);
+    return true;
+}
+
+int sm_reload_fd(const TvSmReloader* reloader)
+{
+    return reloader->notify_fd;
+}
+
+bool sm_reload_changed(TvSmReloader* reloader)
+{
+    char path[sizeof(reloader->path)];
+    strcpy(path, reloader->path);
+    const char* name = basename(path);
+
+    _Alignas(struct inotify_event) char buffer[4096];
+    bool touched = false;
+    ssize_t n;
+    while ((n = read(reloader->notify_fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (char* p = buffer; p < buffer + n; p += sizeof(struct inotify_event) + ((struct inotify_event*)p)->len)
+        {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            touched = touched || (event->len > 0 && strcmp(event->name, name) == 0);
+        }
+    }
+    struct stat info;
+    return touched && stat(reloader->path, &info) == 0
+        && (info.st_dev != reloader->device || info.st_ino != reloader->inode || stat_mtime_ns(&info) != reloader->mtime_ns);
+}
+
+bool sm_reload_swap(TvSmReloader* reloader, uint64_t* load_us, uint64_t* swap_us)
+{
+    const uint64_t start = now_us();
+    TvSmModule next;
+    if (!load_module(reloader, &next))
+    {
+        return false;
+    }
+    const uint64_t loaded = now_us();
+
+    TvSmSnapshot snapshot;
+    reloader->module.plugin->snapshot(reloader->module.sm, &snapshot);
+    const bool restored = next.plugin->restore(next.sm, &snapshot);
+    TvSmModule previous = reloader->module;
+    reloader->module = next;
+    const uint64_t swapped = now_us();
+
+    free_module(&previous);
+    reloader->reloads++;
+    *load_us = loaded - start;
+    *swap_us = swapped - loaded;
+    if (!restored)
+    {
+        fprintf(stderr, "%s has no state %s, its machine was started over.\n", reloader->path, snapshot.state);
+    }
+    return true;
+}
+
+const char* sm_reload_state_name(const TvSmReloader* reloader)
+{
+    return reloader->module.plugin->state_name(reloader->module.sm);
+}
+
+void sm_reload_close(TvSmReloader* reloader)
+{
+    free_module(&reloader->module);
+    if (reloader->notify_fd != -1)
+    {
+        close(reloader->notify_fd);
+        reloader->notify_fd = -1;
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdbool.h> // for bool
+#include <stdint.h> // for uint64_t
+#include <sys/types.h> // for ino_t
+
+#include "input/gesture.h"
+#include "state_machine/TvRemoteSm.h"
+#include "state_machine/sm_plugin.h"
+
+// Hot reload of the state machine from a shared object (`tvremote_sm.so`, see sm_plugin.h).
+//
+// The directory of the shared object is watched with inotify. When the file is rewritten (e.g. by
+// `make tvremote_sm` after regenerating the diagram) a copy of it is loaded next to the current one,
+// a machine is constructed & put into the state & vars of the current machine (by name), and only
+// then the two are swapped, between two events. If the new file doesn't load, has another ABI version
+// or lacks the entry point, the current machine stays.
+
+typedef struct TvSmModule {
+    void* handle;
+    const TvSmPlugin* plugin;
+    void* sm;
+    // Plugin event per TvRemoteSm_EventId of this build, -1 if the plugin doesn't have it.
+    int events[TvRemoteSm_EventIdCount];
+} TvSmModule;
+
+typedef struct TvSmReloader {
+    char path[4096];
+    // inotify watch of the directory of `path`.
+    int notify_fd;
+    // The file that was loaded last, to skip notifications that didn't change it.
+    dev_t device;
+    ino_t inode;
+    long long mtime_ns;
+    const TvOutputSink* output;
+    const ChannelTable* channels;
+    TvSmModule module;
+    // For gesture_set_machine().
+    GestureMachine machine;
+    unsigned int reloads;
+} TvSmReloader;
+
+// Load `path`, construct & start its machine & watch the file. Errors are printed to stderr.
+bool sm_reload_open(TvSmReloader* reloader, const char* path, const TvOutputSink* output, const ChannelTable* channels);
+
+// The file descriptor to poll for changes.
+int sm_reload_fd(const TvSmReloader* reloader);
+
+// Read the pending notifications. Returns true if the shared object was rewritten since it was loaded.
+bool sm_reload_changed(TvSmReloader* reloader);
+
+// Load the new shared object (see above) & swap it in. `load_us` is the time to load & prepare it,
+// `swap_us` the time from taking the snapshot of the current machine to the new one being in use.
+// Errors are printed to stderr & leave the current machine in place.
+bool sm_reload_swap(TvSmReloader* reloader, uint64_t* load_us, uint64_t* swap_us);
+
+// The name of the active state.
+const char* sm_reload_state_name(const TvSmReloader* reloader);
+
+void sm_reload_close(TvSmReloader* reloader);
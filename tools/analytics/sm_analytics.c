@@ -0,0 +1,491 @@
+// How users navigate the two buttons, from recorded sessions: `struct input_event` dumps (e.g. from a
+// keyboard or load_gen) or columnar traces (input/key_trace.h), told apart by their first bytes.
+//
+// Each file is replayed through the gesture recognizer & a TvRemoteSm of its own (output discarded,
+// on the clock of the events), and every dispatch is counted:
+//   - transitions: how often each event is dispatched in each state,
+//   - dwell: how long the machine stays in a state, from the dispatch that enters it to the one that
+//     leaves it (the state a file ends in isn't counted),
+//   - mode cycling: a run of B2_LONG_PRESS that changes the mode (volume, channel select, brightness)
+//     ends when another event is dispatched, in the mode the user wanted. The B2_PRESS every long
+//     press starts with doesn't end it. The run overshot if it took more presses than the shortest
+//     way round from the mode it started in; a run that comes back to where it started went all the
+//     way round.
+// The files are read in blocks, so their size doesn't matter, and shared among threads that count
+// into totals of their own, added up at the end.
+
+#include <dirent.h> // for opendir
+#include <errno.h> // for errno
+#include <linux/input.h> // for input_event
+#include <pthread.h> // for pthread_create
+#include <stdatomic.h> // for atomic_fetch_add
+#include <stdint.h> // for uint64_t
+#include <stdio.h> // for printf
+#include <stdlib.h> // for qsort
+#include <string.h> // for strcmp
+#include <sys/stat.h> // for stat
+#include <time.h> // for clock_gettime
+#include <unistd.h> // for sysconf
+
+#include "input/gesture.h"
+#include "input/key_trace.h"
+#include "metrics/histogram.h"
+
+#define MAX_THREADS 256
+#define PATH_SIZE 4096
+#define BUFFER_EVENTS 4096
+
+// The modes B2_LONG_PRESS cycles through, in order.
+enum
+{
+    MODE_NONE = -1,
+    MODE_VOLUME,
+    MODE_CHANNEL,
+    MODE_BRIGHTNESS,
+    MODE_COUNT
+};
+
+static const char* const MODE_NAMES[MODE_COUNT] = { "VOLUME_CHANGE", "CHANNEL_SELECT", "BRIGHTNESS_CHANGE" };
+
+typedef struct Totals {
+    uint64_t dispatches[TvRemoteSm_StateIdCount][TvRemoteSm_EventIdCount];
+    // Milliseconds.
+    Histogram dwell[TvRemoteSm_StateIdCount];
+    uint64_t cycle_runs;
+    uint64_t cycle_overshoots;
+    uint64_t cycle_extra_presses;
+    uint64_t cycle_runs_to[MODE_COUNT];
+    uint64_t key_events;
+    uint64_t files;
+    uint64_t failed_files;
+} Totals;
+
+// One file being replayed.
+typedef struct Session {
+    Totals* totals;
+    TvRemoteSm sm;
+    GestureRecognizer gestures;
+    TvRemoteSm_StateId state;
+    int64_t entered_us;
+    bool entered;
+    // The B2_LONG_PRESS run in progress, if `cycle_presses` > 0.
+    int cycle_start;
+    int cycle_presses;
+} Session;
+
+typedef struct Worker {
+    _Alignas(64) pthread_t thread;
+    Totals totals;
+    Session session;
+    struct input_event buffer[BUFFER_EVENTS];
+    int64_t times_us[KEY_TRACE_BLOCK_EVENTS];
+} Worker;
+
+static char** paths;
+static size_t path_count;
+static atomic_size_t next_path;
+
+static double seconds_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int mode_of(const TvRemoteSm_StateId state)
+{
+    switch (state)
+    {
+        case TvRemoteSm_StateId_VOLUME_CHANGE:
+        case TvRemoteSm_StateId_VOLUME_CHANGE__INITIAL:
+        case TvRemoteSm_StateId_VOLUME_DOWN:
+        case TvRemoteSm_StateId_VOLUME_UP:
+            return MODE_VOLUME;
+        case TvRemoteSm_StateId_CHANNEL_SELECT:
+        case TvRemoteSm_StateId_CHANNEL_SELECT__INITIAL:
+        case TvRemoteSm_StateId_CHANNEL_DOWN:
+        case TvRemoteSm_StateId_CHANNEL_UP:
+        case TvRemoteSm_StateId_CHANNEL_ENTRY:
+            return MODE_CHANNEL;
+        case TvRemoteSm_StateId_BRIGHTNESS_CHANGE:
+        case TvRemoteSm_StateId_BRIGHTNESS_CHANGE__INITIAL:
+        case TvRemoteSm_StateId_BRIGHTNESS_DOWN:
+        case TvRemoteSm_StateId_BRIGHTNESS_UP:
+            return MODE_BRIGHTNESS;
+        default:
+            return MODE_NONE;
+    }
+}
+
+static int64_t event_us(const struct input_event* event)
+{
+    return (int64_t)event->input_event_sec * 1000000 + event->input_event_usec;
+}
+
+// The user settled in `mode` after the run in progress.
+static void end_cycle(Session* session, const int mode)
+{
+    Totals* totals = session->totals;
+    if (mode != MODE_NONE)
+    {
+        // Presses on the shortest way round, 0 back where it started.
+        const int shortest = (mode - session->cycle_start + MODE_COUNT) % MODE_COUNT;
+        totals->cycle_runs++;
+        totals->cycle_runs_to[mode]++;
+        if (session->cycle_presses > shortest)
+        {
+            totals->cycle_overshoots++;
+            totals->cycle_extra_presses += (uint64_t)(session->cycle_presses - shortest);
+        }
+    }
+    session->cycle_presses = 0;
+}
+
+static void count_dispatch(void* ctx, const int event_id, const struct input_event* source)
+{
+    Session* session = ctx;
+    Totals* totals = session->totals;
+    const TvRemoteSm_StateId from = session->state;
+    const TvRemoteSm_StateId to = session->sm.state_id;
+    const int from_mode = mode_of(from);
+    const int to_mode = mode_of(to);
+    totals->dispatches[from][event_id]++;
+
+    if (event_id == TvRemoteSm_EventId_B2_LONG_PRESS && from_mode != MODE_NONE && to_mode != from_mode)
+    {
+        if (session->cycle_presses == 0)
+        {
+            session->cycle_start = from_mode;
+        }
+        session->cycle_presses++;
+    }
+    else if (session->cycle_presses > 0 && event_id != TvRemoteSm_EventId_B2_PRESS)
+    {
+        end_cycle(session, from_mode);
+    }
+
+    if (to != from)
+    {
+        const int64_t at_us = event_us(source);
+        if (session->entered && at_us >= session->entered_us)
+        {
+            histogram_record(&totals->dwell[from], (uint64_t)(at_us - session->entered_us) / 1000);
+        }
+        session->state = to;
+        session->entered_us = at_us;
+        session->entered = true;
+    }
+}
+
+static void start_session(Session* session, Totals* totals)
+{
+    session->totals = totals;
+    TvRemoteSm_ctor(&session->sm);
+    session->sm.vars.output = &tv_output_null_sink;
+    TvRemoteSm_start(&session->sm);
+    gesture_init(&session->gestures, &session->sm, DEFAULT_TAP_WINDOW, DEFAULT_CHORD_WINDOW);
+    gesture_set_callback(&session->gestures, count_dispatch, session);
+    session->state = session->sm.state_id;
+    session->entered = false;
+    session->cycle_presses = 0;
+}
+
+static bool replay_key_trace(Worker* worker, const char* path)
+{
+    KeyTrace trace;
+    if (!key_trace_open(&trace, path))
+    {
+        return false;
+    }
+    bool ok = true;
+    for (uint32_t block = 0; block < trace.header->block_count && ok; block++)
+    {
+        ok = key_trace_times(&trace, block, worker->times_us);
+        const uint16_t* codes = key_trace_codes(&trace, block);
+        const uint8_t* values = key_trace_values(&trace, block);
+        for (uint32_t i = 0; i < trace.blocks[block].count && ok; i++)
+        {
+            struct input_event event = { .type = EV_KEY, .code = codes[i], .value = values[i] };
+            event.input_event_sec = worker->times_us[i] / 1000000;
+            event.input_event_usec = worker->times_us[i] % 1000000;
+            gesture_handle_input_event(&worker->session.gestures, &event);
+        }
+        worker->totals.key_events += trace.blocks[block].count;
+    }
+    key_trace_close(&trace);
+    if (!ok)
+    {
+        errno = EINVAL;
+    }
+    return ok;
+}
+
+static bool replay_input_events(Worker* worker, FILE* file)
+{
+    size_t n;
+    while ((n = fread(worker->buffer, sizeof(worker->buffer[0]), BUFFER_EVENTS, file)) > 0)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            if (worker->buffer[i].type == EV_KEY)
+            {
+                gesture_handle_input_event(&worker->session.gestures, &worker->buffer[i]);
+                worker->totals.key_events++;
+            }
+        }
+    }
+    return !ferror(file);
+}
+
+static void analyze_file(Worker* worker, const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    char magic[sizeof(KEY_TRACE_MAGIC) - 1] = { 0 };
+    bool ok = file != NULL;
+    const bool key_trace = ok && fread(magic, sizeof(magic), 1, file) == 1 && memcmp(magic, KEY_TRACE_MAGIC, sizeof(magic)) == 0;
+    start_session(&worker->session, &worker->totals);
+    if (key_trace)
+    {
+        ok = replay_key_trace(worker, path);
+    }
+    else if (ok)
+    {
+        rewind(file);
+        ok = replay_input_events(worker, file);
+    }
+    if (ok)
+    {
+        gesture_flush(&worker->session.gestures);
+    }
+    if (!ok)
+    {
+        fprintf(stderr, "Cannot read %s: %s.\n", path, strerror(errno));
+        worker->totals.failed_files++;
+    }
+    worker->totals.files++;
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+}
+
+static void* run_worker(void* arg)
+{
+    Worker* worker = arg;
+    size_t index;
+    while ((index = atomic_fetch_add(&next_path, 1)) < path_count)
+    {
+        analyze_file(worker, paths[index]);
+    }
+    return NULL;
+}
+
+static bool add_path(const char* path, size_t* capacity)
+{
+    if (path_count == *capacity)
+    {
+        *capacity = *capacity ? *capacity * 2 : 1024;
+        char** grown = realloc(paths, *capacity * sizeof(char*));
+        if (grown == NULL)
+        {
+            return false;
+        }
+        paths = grown;
+    }
+    paths[path_count] = strdup(path);
+    return paths[path_count++] != NULL;
+}
+
+static int compare_paths(const void* a, const void* b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// `path` itself, or the regular files in it if it is a directory.
+static bool list_path(const char* path, size_t* capacity)
+{
+    struct stat info;
+    if (stat(path, &info) == -1)
+    {
+        fprintf(stderr, "Cannot open %s: %s.\n", path, strerror(errno));
+        return false;
+    }
+    if (!S_ISDIR(info.st_mode))
+    {
+        return add_path(path, capacity);
+    }
+    DIR* dir = opendir(path);
+    if (dir == NULL)
+    {
+        fprintf(stderr, "Cannot open %s: %s.\n", path, strerror(errno));
+        return false;
+    }
+    struct dirent* entry;
+    char file_path[PATH_SIZE];
+    bool ok = true;
+    while (ok && (entry = readdir(dir)) != NULL)
+    {
+        if (entry->d_type == DT_REG || entry->d_type == DT_UNKNOWN)
+        {
+            snprintf(file_path, sizeof(file_path), "%s/%s", path, entry->d_name);
+            ok = add_path(file_path, capacity);
+        }
+    }
+    closedir(dir);
+    return ok;
+}
+
+static void merge(Totals* into, const Totals* from)
+{
+    for (int state = 0; state < TvRemoteSm_StateIdCount; state++)
+    {
+        for (int event = 0; event < TvRemoteSm_EventIdCount; event++)
+        {
+            into->dispatches[state][event] += from->dispatches[state][event];
+        }
+        histogram_merge(&into->dwell[state], &from->dwell[state]);
+    }
+    into->cycle_runs += from->cycle_runs;
+    into->cycle_overshoots += from->cycle_overshoots;
+    into->cycle_extra_presses += from->cycle_extra_presses;
+    for (int mode = 0; mode < MODE_COUNT; mode++)
+    {
+        into->cycle_runs_to[mode] += from->cycle_runs_to[mode];
+    }
+    into->key_events += from->key_events;
+    into->files += from->files;
+    into->failed_files += from->failed_files;
+}
+
+static void report(const Totals* totals)
+{
+    printf("Dispatches per state (rows) & event (columns):\n%-27s", "");
+    for (int event = 0; event < TvRemoteSm_EventIdCount; event++)
+    {
+        // Without the "_PRESS" every name fits the column.
+        const char* name = TvRemoteSm_event_id_to_string((TvRemoteSm_EventId)event);
+        const size_t length = strlen(name) - (strlen(name) > 6 ? 6 : 0);
+        printf(" %12.*s", (int)length, name);
+    }
+    printf("\n");
+    for (int state = 0; state < TvRemoteSm_StateIdCount; state++)
+    {
+        uint64_t row = 0;
+        for (int event = 0; event < TvRemoteSm_EventIdCount; event++)
+        {
+            row += totals->dispatches[state][event];
+        }
+        if (row == 0)
+        {
+            continue;
+        }
+        printf("%-27s", TvRemoteSm_state_id_to_string((TvRemoteSm_StateId)state));
+        for (int event = 0; event < TvRemoteSm_EventIdCount; event++)
+        {
+            printf(" %12llu", (unsigned long long)totals->dispatches[state][event]);
+        }
+        printf("\n");
+    }
+
+    printf("\nDwell time (ms):\n%-27s %10s %10s %10s %10s %10s %10s\n", "", "count", "mean", "p50", "p90", "p99", "max");
+    for (int state = 0; state < TvRemoteSm_StateIdCount; state++)
+    {
+        const Histogram* dwell = &totals->dwell[state];
+        if (dwell->total == 0)
+        {
+            continue;
+        }
+        printf("%-27s %10llu %10.0f %10llu %10llu %10llu %10llu\n", TvRemoteSm_state_id_to_string((TvRemoteSm_StateId)state),
+            (unsigned long long)dwell->total, (double)dwell->sum / (double)dwell->total,
+            (unsigned long long)histogram_percentile(dwell, 50), (unsigned long long)histogram_percentile(dwell, 90),
+            (unsigned long long)histogram_percentile(dwell, 99), (unsigned long long)dwell->max);
+    }
+
+    printf("\nB2_LONG_PRESS mode cycling: %llu runs, %llu overshot (%.1f%%), %llu extra presses\n",
+        (unsigned long long)totals->cycle_runs, (unsigned long long)totals->cycle_overshoots,
+        totals->cycle_runs ? 100.0 * (double)totals->cycle_overshoots / (double)totals->cycle_runs : 0.0,
+        (unsigned long long)totals->cycle_extra_presses);
+    for (int mode = 0; mode < MODE_COUNT; mode++)
+    {
+        printf("  to %-24s %llu\n", MODE_NAMES[mode], (unsigned long long)totals->cycle_runs_to[mode]);
+    }
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-j THREADS] FILE_OR_DIR...\n", name);
+}
+
+int main(int argc, char ** argv)
+{
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t capacity = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            threads = strtol(argv[++i], NULL, 10);
+        }
+        else if (argv[i][0] == '-')
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        else if (!list_path(argv[i], &capacity))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    if (path_count == 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    qsort(paths, path_count, sizeof(char*), compare_paths);
+    threads = (threads < 1) ? 1 : (threads > MAX_THREADS) ? MAX_THREADS : threads;
+    threads = ((size_t)threads > path_count) ? (long)path_count : threads;
+
+    Worker* workers = aligned_alloc(_Alignof(Worker), sizeof(Worker) * (size_t)threads);
+    Totals* totals = calloc(1, sizeof(Totals));
+    if (workers == NULL || totals == NULL)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        return EXIT_FAILURE;
+    }
+    atomic_init(&next_path, 0);
+    const double start = seconds_now();
+    long started = 0;
+    for (; started < threads; started++)
+    {
+        memset(&workers[started].totals, 0, sizeof(Totals));
+        if (pthread_create(&workers[started].thread, NULL, run_worker, &workers[started]) != 0)
+        {
+            break;
+        }
+    }
+    if (started == 0)
+    {
+        fprintf(stderr, "Cannot start a thread.\n");
+        return EXIT_FAILURE;
+    }
+    for (long t = 0; t < started; t++)
+    {
+        pthread_join(workers[t].thread, NULL);
+        merge(totals, &workers[t].totals);
+    }
+    const double seconds = seconds_now() - start;
+
+    report(totals);
+    printf("\n%llu files, %llu key events in %.2f s (%.1f M key events/s) with %ld threads\n",
+        (unsigned long long)totals->files, (unsigned long long)totals->key_events, seconds,
+        (double)totals->key_events / seconds / 1e6, started);
+    const bool failed = totals->failed_files > 0;
+    for (size_t i = 0; i < path_count; i++)
+    {
+        free(paths[i]);
+    }
+    free(paths);
+    free(workers);
+    free(totals);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,329 @@
+// Button presses needed to tune from one channel to another in channel select.
+//
+// For every start channel, a shortest path search over the (state, channel, channel_entry)
+// configurations inside CHANNEL_SELECT of the generated C machine finds the fewest presses that tune
+// every target channel. Gestures are weighted by the presses they take (a double press is 2, a
+// triple press 3, a chord 2) & events that leave CHANNEL_SELECT are not followed.
+//
+// "before" only allows B1_PRESS & B2_PRESS, which is all that changed the channel before channel
+// entry & favorites were added. "after" allows every event. With `-c TABLE_FILE` only the channels
+// enabled in the lineup are counted (and tuned).
+
+#include <errno.h> // for errno
+#include <stdbool.h> // for bool
+#include <stdint.h> // for uint32_t
+#include <stdio.h> // for printf
+#include <stdlib.h> // for calloc
+#include <string.h> // for strerror
+
+#include "state_machine/TvRemoteSm.h"
+#include "state_machine/TvRemoteSm_restore.h"
+
+// Same as the constants in code_gen.csx.
+#define MIN_CHANNEL 1
+#define MAX_CHANNEL 256
+#define CHANNEL_VALUES 257
+#define CHANNEL_ENTRY_VALUES 260
+#define CONFIG_COUNT ((uint32_t)TvRemoteSm_StateIdCount * CHANNEL_VALUES * CHANNEL_ENTRY_VALUES)
+
+// Longer paths are reported as unreachable.
+#define MAX_PRESSES 512
+#define UNREACHED UINT16_MAX
+
+// Presses per event.
+static const int EVENT_PRESSES[TvRemoteSm_EventIdCount] = {
+    [TvRemoteSm_EventId_B1_DOUBLE_PRESS] = 2,
+    [TvRemoteSm_EventId_B1_LONG_PRESS] = 1,
+    [TvRemoteSm_EventId_B1_PRESS] = 1,
+    [TvRemoteSm_EventId_B2_DOUBLE_PRESS] = 2,
+    [TvRemoteSm_EventId_B2_LONG_PRESS] = 1,
+    [TvRemoteSm_EventId_B2_PRESS] = 1,
+    [TvRemoteSm_EventId_B2_TRIPLE_PRESS] = 3,
+    [TvRemoteSm_EventId_CHORD_PRESS] = 2,
+};
+
+// Configurations waiting to be expanded, one list per distance (Dial's algorithm).
+typedef struct Bucket {
+    uint32_t* items;
+    size_t count;
+    size_t capacity;
+} Bucket;
+
+typedef struct Search {
+    uint16_t* presses;
+    Bucket buckets[MAX_PRESSES];
+    unsigned long long dispatches;
+} Search;
+
+// The lineup, NULL for every channel.
+static const ChannelTable* lineup = NULL;
+
+typedef struct Summary {
+    unsigned long long pairs;
+    unsigned long long total;
+    unsigned long long histogram[MAX_PRESSES];
+    int max;
+    int max_from;
+    int max_to;
+} Summary;
+
+static bool in_channel_select(const TvRemoteSm_StateId state_id)
+{
+    switch (state_id)
+    {
+        case TvRemoteSm_StateId_CHANNEL_SELECT__INITIAL:
+        case TvRemoteSm_StateId_CHANNEL_UP:
+        case TvRemoteSm_StateId_CHANNEL_DOWN:
+        case TvRemoteSm_StateId_CHANNEL_ENTRY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static uint32_t encode(const TvRemoteSm_StateId state_id, const unsigned short channel, const unsigned short channel_entry)
+{
+    return ((uint32_t)state_id * CHANNEL_VALUES + channel) * CHANNEL_ENTRY_VALUES + channel_entry;
+}
+
+static void bucket_push(Bucket* bucket, const uint32_t index)
+{
+    if (bucket->count == bucket->capacity)
+    {
+        bucket->capacity = bucket->capacity ? bucket->capacity * 2 : 1024;
+        bucket->items = realloc(bucket->items, bucket->capacity * sizeof(bucket->items[0]));
+        if (bucket->items == NULL)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    bucket->items[bucket->count++] = index;
+}
+
+// Fewest presses from channel select at `from_channel` to every configuration, using the events in `allowed`.
+static void search(Search* s, const unsigned short from_channel, const bool allowed[TvRemoteSm_EventIdCount])
+{
+    for (uint32_t i = 0; i < CONFIG_COUNT; i++)
+    {
+        s->presses[i] = UNREACHED;
+    }
+
+    TvRemoteSm_Vars vars = {
+        .volume = 50,
+        .brightness = 50,
+        .channel = from_channel,
+        .channel_entry = 0,
+        .output = &tv_output_null_sink,
+        .channels = lineup
+    };
+    const uint32_t start = encode(TvRemoteSm_StateId_CHANNEL_SELECT__INITIAL, from_channel, 0);
+    s->presses[start] = 0;
+    bucket_push(&s->buckets[0], start);
+
+    for (int distance = 0; distance < MAX_PRESSES; distance++)
+    {
+        Bucket* bucket = &s->buckets[distance];
+        // Pushes to the current bucket can't happen (every event costs at least 1 press).
+        for (size_t i = 0; i < bucket->count; i++)
+        {
+            const uint32_t index = bucket->items[i];
+            if (s->presses[index] != distance)
+            {
+                continue; // Reached with fewer presses since it was queued.
+            }
+            const TvRemoteSm_StateId state_id = (TvRemoteSm_StateId)(index / (CHANNEL_VALUES * CHANNEL_ENTRY_VALUES));
+            vars.channel = (unsigned short)(index / CHANNEL_ENTRY_VALUES % CHANNEL_VALUES);
+            vars.channel_entry = (unsigned short)(index % CHANNEL_ENTRY_VALUES);
+
+            for (int event = 0; event < TvRemoteSm_EventIdCount; event++)
+            {
+                if (!allowed[event])
+                {
+                    continue;
+                }
+                TvRemoteSm sm;
+                TvRemoteSm_restore(&sm, state_id, &vars);
+                TvRemoteSm_dispatch_event(&sm, (TvRemoteSm_EventId)event);
+                s->dispatches++;
+                if (!in_channel_select(sm.state_id) || sm.vars.channel >= CHANNEL_VALUES || sm.vars.channel_entry >= CHANNEL_ENTRY_VALUES)
+                {
+                    continue;
+                }
+                const int presses = distance + EVENT_PRESSES[event];
+                const uint32_t next = encode(sm.state_id, sm.vars.channel, sm.vars.channel_entry);
+                if (presses < MAX_PRESSES && presses < s->presses[next])
+                {
+                    s->presses[next] = (uint16_t)presses;
+                    bucket_push(&s->buckets[presses], next);
+                }
+            }
+        }
+        bucket->count = 0;
+    }
+}
+
+// Fewest presses that leave channel select tuned to `channel` (not still typing it).
+static int presses_to(const Search* s, const unsigned short channel)
+{
+    int best = UNREACHED;
+    for (int state = 0; state < TvRemoteSm_StateIdCount; state++)
+    {
+        if (state == TvRemoteSm_StateId_CHANNEL_ENTRY || !in_channel_select((TvRemoteSm_StateId)state))
+        {
+            continue;
+        }
+        const int presses = s->presses[encode((TvRemoteSm_StateId)state, channel, 0)];
+        if (presses < best)
+        {
+            best = presses;
+        }
+    }
+    return best;
+}
+
+static int percentile(const Summary* summary, const double fraction)
+{
+    const unsigned long long rank = (unsigned long long)(fraction * (double)summary->pairs);
+    unsigned long long seen = 0;
+    for (int presses = 0; presses < MAX_PRESSES; presses++)
+    {
+        seen += summary->histogram[presses];
+        if (seen > rank)
+        {
+            return presses;
+        }
+    }
+    return summary->max;
+}
+
+static bool summarize(const char* name, const bool allowed[TvRemoteSm_EventIdCount], const unsigned short example_from, const unsigned short example_to)
+{
+    Search* s = calloc(1, sizeof(Search));
+    Summary summary = { 0 };
+    int example = UNREACHED;
+    if (s == NULL || (s->presses = malloc(CONFIG_COUNT * sizeof(s->presses[0]))) == NULL)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        return false;
+    }
+
+    for (unsigned short from = MIN_CHANNEL; from <= MAX_CHANNEL; from++)
+    {
+        if (!channel_table_is_enabled(lineup, from))
+        {
+            continue;
+        }
+        search(s, from, allowed);
+        for (unsigned short to = MIN_CHANNEL; to <= MAX_CHANNEL; to++)
+        {
+            if (to == from || !channel_table_is_enabled(lineup, to))
+            {
+                continue;
+            }
+            const int presses = presses_to(s, to);
+            if (presses == UNREACHED)
+            {
+                fprintf(stderr, "%s: channel %d can't be reached from %d.\n", name, to, from);
+                return false;
+            }
+            summary.pairs++;
+            summary.total += (unsigned long long)presses;
+            summary.histogram[presses]++;
+            if (presses > summary.max)
+            {
+                summary.max = presses;
+                summary.max_from = from;
+                summary.max_to = to;
+            }
+            if (from == example_from && to == example_to)
+            {
+                example = presses;
+            }
+        }
+    }
+
+    printf("%-7s mean %6.2f  p50 %3d  p90 %3d  max %3d (%d -> %d)  %d -> %d: %3d   %llu dispatches\n",
+        name, (double)summary.total / (double)summary.pairs, percentile(&summary, 0.5), percentile(&summary, 0.9),
+        summary.max, summary.max_from, summary.max_to, example_from, example_to, example, s->dispatches);
+
+    for (int i = 0; i < MAX_PRESSES; i++)
+    {
+        free(s->buckets[i].items);
+    }
+    free(s->presses);
+    free(s);
+    return true;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-c TABLE_FILE] [-f FROM_CHANNEL] [-t TO_CHANNEL]\n", name);
+}
+
+int main(int argc, char ** argv)
+{
+    const char* table_path = NULL;
+    unsigned short example_from = 1;
+    unsigned short example_to = 200;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+        {
+            table_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+        {
+            example_from = (unsigned short)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+        {
+            example_to = (unsigned short)strtoul(argv[++i], NULL, 10);
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    ChannelTable table;
+    if (table_path != NULL)
+    {
+        if (!channel_table_open(&table, table_path))
+        {
+            fprintf(stderr, "Cannot load channel table %s: %s.\n", table_path, strerror(errno));
+            return EXIT_FAILURE;
+        }
+        lineup = &table;
+    }
+    if (!channel_table_is_enabled(lineup, example_from) || !channel_table_is_enabled(lineup, example_to) || example_from == example_to)
+    {
+        fprintf(stderr, "Channels must be two different enabled channels in [%d, %d].\n", MIN_CHANNEL, MAX_CHANNEL);
+        return EXIT_FAILURE;
+    }
+    int enabled = 0;
+    for (unsigned short channel = MIN_CHANNEL; channel <= MAX_CHANNEL; channel++)
+    {
+        enabled += channel_table_is_enabled(lineup, channel) ? 1 : 0;
+    }
+
+    TvRemoteSm_restore_init();
+
+    bool before[TvRemoteSm_EventIdCount] = { 0 };
+    before[TvRemoteSm_EventId_B1_PRESS] = true;
+    before[TvRemoteSm_EventId_B2_PRESS] = true;
+    bool after[TvRemoteSm_EventIdCount];
+    for (int event = 0; event < TvRemoteSm_EventIdCount; event++)
+    {
+        after[event] = true;
+    }
+
+    printf("Presses to tune every channel from every other channel (%d pairs):\n", enabled * (enabled - 1));
+    if (!summarize("before", before, example_from, example_to) || !summarize("after", after, example_from, example_to))
+    {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
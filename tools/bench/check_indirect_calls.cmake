@@ -0,0 +1,45 @@
+# Fails when tv_probe_cpp() (one `Machine::dispatch<Event>()`) makes more indirect calls than the C
+# dispatch it replaces: TvRemoteSm_dispatch_event(), or tv_probe_c() when LTO inlined it there.
+#   cmake -DOBJDUMP=objdump -DBINARY=sm_cpp_bench -P check_indirect_calls.cmake
+
+execute_process(COMMAND ${OBJDUMP} -d --no-show-raw-insn ${BINARY} OUTPUT_VARIABLE DISASSEMBLY RESULT_VARIABLE RESULT)
+if(NOT RESULT EQUAL 0)
+    message(FATAL_ERROR "Cannot disassemble ${BINARY}.")
+endif()
+string(REGEX MATCHALL "[^\n]*\n" LINES "${DISASSEMBLY}")
+
+# x86 `call *%rax` & `jmp *...`, AArch64 `blr x1` & `br x1`.
+set(INDIRECT "[ \t](call|callq|jmp|jmpq)[ \t]+\\*|[ \t](blr|br)[ \t]+x")
+
+# Sets `${FUNCTION}_FOUND` & `${FUNCTION}_INDIRECT` (the number of indirect calls & jumps).
+function(count_indirect FUNCTION)
+    set(INSIDE FALSE)
+    set(FOUND FALSE)
+    set(COUNT 0)
+    foreach(LINE ${LINES})
+        if(LINE MATCHES "^[0-9a-f]+ <([^>]+)>:")
+            if(CMAKE_MATCH_1 STREQUAL FUNCTION)
+                set(INSIDE TRUE)
+                set(FOUND TRUE)
+            else()
+                set(INSIDE FALSE)
+            endif()
+        elseif(INSIDE AND LINE MATCHES "${INDIRECT}")
+            math(EXPR COUNT "${COUNT} + 1")
+        endif()
+    endforeach()
+    set(${FUNCTION}_FOUND ${FOUND} PARENT_SCOPE)
+    set(${FUNCTION}_INDIRECT ${COUNT} PARENT_SCOPE)
+endfunction()
+
+count_indirect(tv_probe_cpp)
+count_indirect(tv_probe_c)
+count_indirect(TvRemoteSm_dispatch_event)
+if(NOT tv_probe_cpp_FOUND OR NOT tv_probe_c_FOUND)
+    message(FATAL_ERROR "${BINARY} has no tv_probe_cpp() or tv_probe_c().")
+endif()
+math(EXPR C_INDIRECT "${tv_probe_c_INDIRECT} + ${TvRemoteSm_dispatch_event_INDIRECT}")
+if(tv_probe_cpp_INDIRECT GREATER C_INDIRECT)
+    message(FATAL_ERROR "dispatch<Event>() makes ${tv_probe_cpp_INDIRECT} indirect calls, the C dispatch ${C_INDIRECT}.")
+endif()
+message(STATUS "Indirect calls per dispatch: C++ ${tv_probe_cpp_INDIRECT}, C ${C_INDIRECT}.")
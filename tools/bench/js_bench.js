@@ -0,0 +1,99 @@
+#!/usr/bin/env node
+// Throughput of the generated JavaScript machine over a trace of event ids, against the C machine.
+//
+// The trace is the file written by `sm_event_bench -w` (one TvRemoteSm_EventId per byte). It is
+// dispatched with dispatchEvents() of TvRemoteSm_node.js, best of a few rounds, with the output
+// discarded & with a sink that counts it. Given the path of sm_event_bench, the C machine is run on
+// the same file, the rates are compared and both machines must end in the same configuration.
+//
+// Usage: node js_bench.js TRACE_FILE [path/to/sm_event_bench]
+
+"use strict";
+
+const childProcess = require("child_process");
+const fs = require("fs");
+const path = require("path");
+
+const { TvRemoteSm, NULL_OUTPUT } = require(path.join(__dirname, "..", "..", "state_machine", "TvRemoteSm_node.js"));
+
+const ROUNDS = 5;
+
+// What a simulator would do with the output at least: look at every action.
+function countingOutput() {
+    return {
+        shows: 0,
+        values: 0,
+        show(message) { this.shows++; },
+        value(field, value) { this.values += value; },
+    };
+}
+
+// Best seconds of ROUNDS runs over `events` & the machine of the last one.
+function run(events, makeOutput) {
+    let best = Infinity;
+    let sm = null;
+    for (let round = 0; round < ROUNDS; round++) {
+        sm = new TvRemoteSm();
+        sm.vars.output = makeOutput();
+        sm.start();
+        const started = process.hrtime.bigint();
+        sm.dispatchEvents(events);
+        best = Math.min(best, Number(process.hrtime.bigint() - started) / 1e9);
+    }
+    return { seconds: best, sm };
+}
+
+// Same as the "end" line of sm_event_bench.
+function configuration(sm) {
+    const stateName = Object.keys(TvRemoteSm.StateId).find(name => TvRemoteSm.StateId[name] === sm.stateId);
+    const v = sm.vars;
+    return `${stateName} volume=${v.volume} brightness=${v.brightness} channel=${v.channel} channel_entry=${v.channel_entry}`;
+}
+
+function report(label, count, seconds) {
+    console.log(`${label.padEnd(26)} ${(seconds * 1e9 / count).toFixed(2).padStart(8)} ns/event  ${(count / seconds / 1e6).toFixed(1).padStart(8)} M events/s`);
+}
+
+function main() {
+    const tracePath = process.argv[2];
+    const cBench = process.argv[3];
+    if (!tracePath) {
+        console.error("Usage: node js_bench.js TRACE_FILE [sm_event_bench]");
+        process.exit(2);
+    }
+    const events = new Uint8Array(fs.readFileSync(tracePath));
+    if (events.length === 0) {
+        console.error(`${tracePath} has no events.`);
+        process.exit(2);
+    }
+
+    const silent = run(events, () => NULL_OUTPUT);
+    const counted = run(events, countingOutput);
+    console.log(`${events.length} events, best of ${ROUNDS}`);
+    report("JS dispatchEvents", events.length, silent.seconds);
+    report("JS dispatchEvents, count", events.length, counted.seconds);
+
+    const end = configuration(silent.sm);
+    if (!cBench) {
+        console.log(`end ${end}`);
+        return;
+    }
+    const output = childProcess.execFileSync(cBench, [tracePath], { encoding: "utf8" });
+    const rate = /C dispatch_event .* ([\d.]+) M events\/s/.exec(output);
+    const cEnd = /^end (.*)$/m.exec(output);
+    if (rate === null || cEnd === null) {
+        console.error(`Unexpected output from ${cBench}:\n${output}`);
+        process.exit(2);
+    }
+    const cRate = Number(rate[1]);
+    const jsRate = events.length / silent.seconds / 1e6;
+    console.log(`${"C dispatch_event".padEnd(26)} ${(1e3 / cRate).toFixed(2).padStart(8)} ns/event  ${cRate.toFixed(1).padStart(8)} M events/s`);
+    console.log(`JS runs at ${(jsRate / cRate * 100).toFixed(1)}% of the C rate.`);
+    if (cEnd[1] !== end) {
+        console.log(`The machines ended in different configurations: C ${cEnd[1]}, JS ${end}.`);
+        process.exit(1);
+    }
+    console.log(`end ${end}`);
+}
+
+main();
@@ -0,0 +1,187 @@
+// Wake-up jitter of the input loop on a loaded host. A thread sleeps until a deadline every interval,
+// as the loop does for a held back press or a long-press, and dispatches an event when it wakes up;
+// how late it wakes up is recorded. It runs twice under the same CPU hog (threads spinning over a
+// buffer at normal priority): as a plain thread, which is what the loop gets by default, and through
+// realtime_run() as `remote --realtime` does (SCHED_FIFO, optionally pinned & with the memory locked).
+
+#include <pthread.h> // for pthread_create
+#include <stdatomic.h> // for atomic_bool
+#include <stdint.h> // for uint64_t
+#include <stdio.h> // for printf
+#include <stdlib.h> // for strtoul
+#include <string.h> // for strcmp
+#include <time.h> // for clock_nanosleep
+#include <unistd.h> // for sysconf
+
+#include "input/realtime.h"
+#include "metrics/histogram.h"
+#include "state_machine/TvRemoteSm.h"
+
+#define DEFAULT_WAKEUPS 3000
+#define DEFAULT_INTERVAL_US 1000
+#define MAX_HOGS 256
+#define HOG_BUFFER_SIZE (8 * 1024 * 1024)
+
+typedef struct Measurement {
+    unsigned long wakeups;
+    unsigned long interval_us;
+    // Microseconds late.
+    Histogram late;
+    TvRemoteSm sm;
+} Measurement;
+
+static atomic_bool hogs_stop;
+
+static void* run_hog(void* arg)
+{
+    (void)arg;
+    // Spin over a buffer larger than the caches, so the measured thread loses them too.
+    volatile uint64_t* buffer = malloc(HOG_BUFFER_SIZE);
+    uint64_t value = 1;
+    while (buffer != NULL && !atomic_load_explicit(&hogs_stop, memory_order_relaxed))
+    {
+        for (size_t i = 0; i < HOG_BUFFER_SIZE / sizeof(uint64_t); i += 8)
+        {
+            buffer[i] += value++;
+        }
+    }
+    free((void*)buffer);
+    return NULL;
+}
+
+static void add_us(struct timespec* ts, const unsigned long us)
+{
+    ts->tv_nsec += (long)(us % 1000000) * 1000;
+    ts->tv_sec += (time_t)(us / 1000000) + ts->tv_nsec / 1000000000;
+    ts->tv_nsec %= 1000000000;
+}
+
+static void* measure(void* arg)
+{
+    Measurement* m = arg;
+    static const TvRemoteSm_EventId EVENTS[] = { TvRemoteSm_EventId_B2_PRESS, TvRemoteSm_EventId_B1_PRESS };
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    for (unsigned long i = 0; i < m->wakeups; i++)
+    {
+        add_us(&deadline, m->interval_us);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        const long long late_ns = (long long)(now.tv_sec - deadline.tv_sec) * 1000000000LL + (now.tv_nsec - deadline.tv_nsec);
+        histogram_record(&m->late, late_ns > 0 ? (uint64_t)late_ns / 1000 : 0);
+        TvRemoteSm_dispatch_event(&m->sm, EVENTS[i % 2]);
+    }
+    return NULL;
+}
+
+static void start_measurement(Measurement* m, const unsigned long wakeups, const unsigned long interval_us)
+{
+    m->wakeups = wakeups;
+    m->interval_us = interval_us;
+    histogram_reset(&m->late);
+    TvRemoteSm_ctor(&m->sm);
+    m->sm.vars.output = &tv_output_null_sink;
+    TvRemoteSm_start(&m->sm);
+    // Turned on, so the presses change the volume.
+    TvRemoteSm_dispatch_event(&m->sm, TvRemoteSm_EventId_B1_LONG_PRESS);
+}
+
+static void report(const char* label, const Measurement* m)
+{
+    printf("%-38s %8llu %8llu %8llu %8llu %8llu\n", label, (unsigned long long)m->late.total,
+        (unsigned long long)histogram_percentile(&m->late, 50), (unsigned long long)histogram_percentile(&m->late, 99),
+        (unsigned long long)histogram_percentile(&m->late, 99.9), (unsigned long long)m->late.max);
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-n WAKEUPS] [-i INTERVAL_US] [-H HOG_THREADS] [-p PRIORITY] [-c CPU] [-m]\n", name);
+}
+
+int main(int argc, char ** argv)
+{
+    unsigned long wakeups = DEFAULT_WAKEUPS;
+    unsigned long interval_us = DEFAULT_INTERVAL_US;
+    long hogs = 2 * sysconf(_SC_NPROCESSORS_ONLN);
+    RealtimeOptions realtime = { .priority = REALTIME_DEFAULT_PRIORITY, .cpu = -1, .lock_memory = false };
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            wakeups = strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc)
+        {
+            interval_us = strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "-H") == 0 && i + 1 < argc)
+        {
+            hogs = strtol(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+        {
+            realtime.priority = (int)strtol(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+        {
+            realtime.cpu = (int)strtol(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "-m") == 0)
+        {
+            realtime.lock_memory = true;
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (wakeups == 0 || interval_us == 0 || realtime.priority < 0 || realtime.priority > 99)
+    {
+        fprintf(stderr, "WAKEUPS & INTERVAL_US must not be 0, PRIORITY must be in [0, 99].\n");
+        return EXIT_FAILURE;
+    }
+    hogs = (hogs < 0) ? 0 : (hogs > MAX_HOGS) ? MAX_HOGS : hogs;
+
+    pthread_t hog_threads[MAX_HOGS];
+    long started = 0;
+    atomic_init(&hogs_stop, false);
+    for (; started < hogs && pthread_create(&hog_threads[started], NULL, run_hog, NULL) == 0; started++)
+    {
+    }
+
+    static Measurement plain;
+    static Measurement fifo;
+    start_measurement(&plain, wakeups, interval_us);
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, measure, &plain) != 0)
+    {
+        fprintf(stderr, "Cannot start a thread.\n");
+        return EXIT_FAILURE;
+    }
+    pthread_join(thread, NULL);
+
+    start_measurement(&fifo, wakeups, interval_us);
+    realtime_prefault(&fifo, sizeof(fifo));
+    RealtimeStatus status;
+    if (!realtime_run(&realtime, measure, &fifo, &status))
+    {
+        return EXIT_FAILURE;
+    }
+
+    atomic_store(&hogs_stop, true);
+    for (long i = 0; i < started; i++)
+    {
+        pthread_join(hog_threads[i], NULL);
+    }
+
+    char label[64];
+    snprintf(label, sizeof(label), "realtime (%s%s%s)", status.fifo ? "SCHED_FIFO" : "normal",
+        status.pinned ? ", pinned" : "", status.locked ? ", mlock" : "");
+    printf("%lu wakeups every %lu us, %ld hog threads, late by (us):\n", wakeups, interval_us, started);
+    printf("%-38s %8s %8s %8s %8s %8s\n", "", "count", "p50", "p99", "p99.9", "max");
+    report("default", &plain);
+    report(label, &fifo);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,253 @@
+// Dispatch through the C++ wrapper (TvRemoteSm.hpp) against the generated C functions, with the
+// output discarded: pseudo random events known at run time, then a fixed sequence of events known at
+// compile time (`dispatch<Event>()`), with & without an observer. Every run must end in the same
+// configuration as the C one, and the name tables must match the generated functions.
+//
+// tv_probe_c() & tv_probe_cpp() dispatch one event each way. check_indirect_calls.cmake disassembles
+// them after the build and fails if the C++ one makes more indirect calls than the C dispatch.
+
+#include <chrono> // for std::chrono::steady_clock
+#include <cstdint> // for std::uint64_t
+#include <cstdio> // for std::printf
+#include <cstdlib> // for std::strtoull
+#include <cstring> // for std::strcmp
+#include <vector> // for std::vector
+
+#include "state_machine/TvRemoteSm.hpp"
+
+using tv_remote::Event;
+using tv_remote::Machine;
+using tv_remote::State;
+
+namespace
+{
+
+constexpr std::uint64_t default_count = 20000000;
+constexpr int rounds = 5;
+
+// Counts the dispatches that changed the state, without a virtual call.
+struct TransitionCounter
+{
+    std::uint64_t transitions = 0;
+
+    void on_dispatch(Event, const State from, const State to)
+    {
+        transitions += (from != to);
+    }
+};
+
+double seconds_now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// xorshift64* so the events are reproducible from the seed.
+std::uint64_t next_random(std::uint64_t& state)
+{
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+bool same_configuration(const TvRemoteSm& a, const TvRemoteSm& b)
+{
+    return a.state_id == b.state_id && a.vars.volume == b.vars.volume && a.vars.brightness == b.vars.brightness
+        && a.vars.channel == b.vars.channel && a.vars.channel_entry == b.vars.channel_entry;
+}
+
+bool names_match()
+{
+    for (std::size_t i = 0; i < tv_remote::event_count; i++)
+    {
+        if (tv_remote::event_names[i] != TvRemoteSm_event_id_to_string(static_cast<TvRemoteSm_EventId>(i)))
+        {
+            return false;
+        }
+    }
+    for (std::size_t i = 0; i < tv_remote::state_count; i++)
+    {
+        if (tv_remote::state_names[i] != TvRemoteSm_state_id_to_string(static_cast<TvRemoteSm_StateId>(i)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// A cycle that visits every mode: on, volume, channel select & entry, brightness, the gestures, off.
+#define TV_CYCLE(DISPATCH) \
+    DISPATCH(B1_LONG_PRESS, B1LongPress) DISPATCH(B1_PRESS, B1Press) DISPATCH(B2_PRESS, B2Press) \
+    DISPATCH(B2_LONG_PRESS, B2LongPress) DISPATCH(B1_PRESS, B1Press) DISPATCH(B1_DOUBLE_PRESS, B1DoublePress) \
+    DISPATCH(B2_DOUBLE_PRESS, B2DoublePress) DISPATCH(B1_PRESS, B1Press) DISPATCH(B2_DOUBLE_PRESS, B2DoublePress) \
+    DISPATCH(B2_TRIPLE_PRESS, B2TriplePress) DISPATCH(B2_PRESS, B2Press) DISPATCH(CHORD_PRESS, ChordPress) \
+    DISPATCH(B1_LONG_PRESS, B1LongPress)
+#define COUNT_ONE(C, CPP) +1
+constexpr std::uint64_t cycle_length = 0 TV_CYCLE(COUNT_ONE);
+
+struct Result
+{
+    double seconds;
+    TvRemoteSm sm;
+};
+
+template <typename Run>
+Result best_of(Run run)
+{
+    Result best{};
+    for (int round = 0; round < rounds; round++)
+    {
+        const double start = seconds_now();
+        const TvRemoteSm sm = run();
+        const double seconds = seconds_now() - start;
+        if (round == 0 || seconds < best.seconds)
+        {
+            best = Result{ seconds, sm };
+        }
+    }
+    return best;
+}
+
+void report(const char* label, const Result& result, const Result& baseline, const std::uint64_t count)
+{
+    std::printf("%-28s %7.2f ns/event  %7.1f M events/s  (%+.1f%%)\n", label, result.seconds * 1e9 / double(count),
+        double(count) / result.seconds / 1e6, (result.seconds / baseline.seconds - 1) * 100);
+}
+
+void usage(const char* name)
+{
+    std::fprintf(stderr, "Usage: %s [-n EVENTS] [-s SEED]\n", name);
+}
+
+} // namespace
+
+// Used & called once from main() so that LTO & --gc-sections keep them for the check.
+extern "C" __attribute__((used, noinline)) void tv_probe_c(TvRemoteSm* sm)
+{
+    TvRemoteSm_dispatch_event(sm, TvRemoteSm_EventId_B1_PRESS);
+}
+
+extern "C" __attribute__((used, noinline)) void tv_probe_cpp(Machine<>* machine)
+{
+    machine->dispatch<Event::B1Press>();
+}
+
+int main(int argc, char** argv)
+{
+    std::uint64_t count = default_count;
+    std::uint64_t seed = 0x5eed;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            count = std::strtoull(argv[++i], nullptr, 0);
+        }
+        else if (std::strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            seed = std::strtoull(argv[++i], nullptr, 0);
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (count == 0 || seed == 0)
+    {
+        std::fprintf(stderr, "EVENTS & SEED must not be 0.\n");
+        return EXIT_FAILURE;
+    }
+    if (!names_match())
+    {
+        std::fprintf(stderr, "The names in TvRemoteSm.hpp don't match TvRemoteSm.c.\n");
+        return EXIT_FAILURE;
+    }
+    TvRemoteSm probe_sm;
+    TvRemoteSm_ctor(&probe_sm);
+    probe_sm.vars.output = &tv_output_null_sink;
+    TvRemoteSm_start(&probe_sm);
+    tv_probe_c(&probe_sm);
+    Machine<> probe_machine(&tv_output_null_sink);
+    tv_probe_cpp(&probe_machine);
+    if (!same_configuration(probe_sm, probe_machine.c_machine()))
+    {
+        std::fprintf(stderr, "tv_probe_c() & tv_probe_cpp() end in different configurations.\n");
+        return EXIT_FAILURE;
+    }
+
+    std::vector<TvRemoteSm_EventId> events(count);
+    for (auto& event : events)
+    {
+        event = static_cast<TvRemoteSm_EventId>(next_random(seed) % TvRemoteSm_EventIdCount);
+    }
+    const std::uint64_t cycles = (count + cycle_length - 1) / cycle_length;
+
+    const Result c_random = best_of([&] {
+        TvRemoteSm sm;
+        TvRemoteSm_ctor(&sm);
+        sm.vars.output = &tv_output_null_sink;
+        TvRemoteSm_start(&sm);
+        for (const TvRemoteSm_EventId event : events)
+        {
+            TvRemoteSm_dispatch_event(&sm, event);
+        }
+        return sm;
+    });
+    const Result cpp_random = best_of([&] {
+        Machine<> machine(&tv_output_null_sink);
+        for (const TvRemoteSm_EventId event : events)
+        {
+            machine.dispatch(static_cast<Event>(event));
+        }
+        return machine.c_machine();
+    });
+
+#define C_DISPATCH(C, CPP) TvRemoteSm_dispatch_event(&sm, TvRemoteSm_EventId_##C);
+#define CPP_DISPATCH(C, CPP) machine.dispatch<Event::CPP>();
+    const Result c_fixed = best_of([&] {
+        TvRemoteSm sm;
+        TvRemoteSm_ctor(&sm);
+        sm.vars.output = &tv_output_null_sink;
+        TvRemoteSm_start(&sm);
+        for (std::uint64_t i = 0; i < cycles; i++)
+        {
+            TV_CYCLE(C_DISPATCH)
+        }
+        return sm;
+    });
+    const Result cpp_fixed = best_of([&] {
+        Machine<> machine(&tv_output_null_sink);
+        for (std::uint64_t i = 0; i < cycles; i++)
+        {
+            TV_CYCLE(CPP_DISPATCH)
+        }
+        return machine.c_machine();
+    });
+    std::uint64_t transitions = 0;
+    const Result cpp_observed = best_of([&] {
+        Machine<TransitionCounter> machine(&tv_output_null_sink);
+        for (std::uint64_t i = 0; i < cycles; i++)
+        {
+            TV_CYCLE(CPP_DISPATCH)
+        }
+        transitions = machine.observer().transitions;
+        return machine.c_machine();
+    });
+
+    std::printf("%llu random events\n", static_cast<unsigned long long>(count));
+    report("C dispatch_event", c_random, c_random, count);
+    report("C++ dispatch(Event)", cpp_random, c_random, count);
+    std::printf("%llu events in a fixed sequence\n", static_cast<unsigned long long>(cycles * cycle_length));
+    report("C dispatch_event", c_fixed, c_fixed, cycles * cycle_length);
+    report("C++ dispatch<Event>()", cpp_fixed, c_fixed, cycles * cycle_length);
+    report("C++ dispatch<Event>() + obs", cpp_observed, c_fixed, cycles * cycle_length);
+    std::printf("%llu transitions observed\n", static_cast<unsigned long long>(transitions));
+
+    if (!same_configuration(c_random.sm, cpp_random.sm) || !same_configuration(c_fixed.sm, cpp_fixed.sm)
+        || !same_configuration(c_fixed.sm, cpp_observed.sm))
+    {
+        std::fprintf(stderr, "The C++ machine ended in another configuration than the C one.\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
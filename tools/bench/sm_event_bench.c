@@ -0,0 +1,172 @@
+// Throughput of TvRemoteSm_dispatch_event() over a trace of event ids, with the output discarded.
+// The trace is a file of one byte per event (the TvRemoteSm_EventId), so tools/bench/js_bench.js
+// runs the generated JavaScript machine over exactly the same events & compares the rates.
+//
+// Without a trace file the events are pseudo random from the seed; `-w FILE` writes them out.
+// The configuration the machine ends in is printed, so the runs can be checked against each other.
+
+#include <errno.h> // for errno
+#include <stdbool.h> // for bool
+#include <stdint.h> // for uint64_t
+#include <stdio.h> // for printf
+#include <stdlib.h> // for malloc
+#include <string.h> // for strcmp
+#include <time.h> // for clock_gettime
+
+#include "state_machine/TvRemoteSm.h"
+
+#define DEFAULT_COUNT 20000000u
+#define ROUNDS 5
+
+static double seconds_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// xorshift64* so the events are reproducible from the seed.
+static uint64_t next_random(uint64_t* state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+// The whole file in memory. Returns NULL (errno is set).
+static unsigned char* read_trace(const char* path, size_t* count)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    unsigned char* events = NULL;
+    if (fseek(file, 0, SEEK_END) == 0)
+    {
+        const long size = ftell(file);
+        events = (size > 0) ? malloc((size_t)size) : NULL;
+        rewind(file);
+        if (events != NULL && fread(events, 1, (size_t)size, file) != (size_t)size)
+        {
+            free(events);
+            events = NULL;
+        }
+        *count = (size_t)size;
+    }
+    fclose(file);
+    return events;
+}
+
+static bool write_trace(const char* path, const unsigned char* events, const size_t count)
+{
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    const bool written = fwrite(events, 1, count, file) == count;
+    return fclose(file) == 0 && written;
+}
+
+static double run(const unsigned char* events, const size_t count, TvRemoteSm* sm)
+{
+    TvRemoteSm_ctor(sm);
+    sm->vars.output = &tv_output_null_sink;
+    TvRemoteSm_start(sm);
+    const double start = seconds_now();
+    for (size_t i = 0; i < count; i++)
+    {
+        TvRemoteSm_dispatch_event(sm, (TvRemoteSm_EventId)events[i]);
+    }
+    return seconds_now() - start;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-n EVENTS] [-s SEED] [-w FILE] [TRACE_FILE]\n", name);
+}
+
+int main(int argc, char ** argv)
+{
+    size_t count = DEFAULT_COUNT;
+    uint64_t seed = 0x5eed;
+    const char* output = NULL;
+    const char* input = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            count = (size_t)strtoull(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            seed = strtoull(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+        {
+            output = argv[++i];
+        }
+        else if (argv[i][0] != '-' && input == NULL)
+        {
+            input = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (count == 0 || seed == 0)
+    {
+        fprintf(stderr, "EVENTS must be > 0 & SEED not 0.\n");
+        return EXIT_FAILURE;
+    }
+
+    unsigned char* events;
+    if (input != NULL)
+    {
+        errno = 0;
+        events = read_trace(input, &count);
+        if (events == NULL)
+        {
+            fprintf(stderr, "Cannot read %s: %s.\n", input, (errno != 0) ? strerror(errno) : "empty file");
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        events = malloc(count);
+        if (events == NULL)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            return EXIT_FAILURE;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            events[i] = (unsigned char)(next_random(&seed) % TvRemoteSm_EventIdCount);
+        }
+    }
+    if (output != NULL && !write_trace(output, events, count))
+    {
+        fprintf(stderr, "Cannot write %s: %s.\n", output, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    double best = 0;
+    TvRemoteSm sm;
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        const double seconds = run(events, count, &sm);
+        best = (round == 0 || seconds < best) ? seconds : best;
+    }
+
+    printf("%zu events, best of %d\n", count, ROUNDS);
+    printf("C dispatch_event  %8.2f ns/event  %8.1f M events/s\n", best * 1e9 / (double)count, (double)count / best / 1e6);
+    printf("end %s volume=%u brightness=%u channel=%u channel_entry=%u\n", TvRemoteSm_state_id_to_string(sm.state_id),
+        sm.vars.volume, sm.vars.brightness, sm.vars.channel, sm.vars.channel_entry);
+    free(events);
+    return EXIT_SUCCESS;
+}
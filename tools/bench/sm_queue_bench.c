@@ -0,0 +1,184 @@
+// Throughput of TvRemoteSm_queue (post a batch, then drain it) against calling
+// TvRemoteSm_dispatch_event() directly, over the same pseudo random events with the output discarded.
+//
+// Draining a batch runs its B1_LONG_PRESS events first, so the direct run dispatches every batch in
+// that order too & both runs must end in the same configuration, which is checked.
+
+#include <stdint.h> // for uint64_t
+#include <stdio.h> // for printf
+#include <stdlib.h> // for malloc
+#include <string.h> // for strcmp
+#include <time.h> // for clock_gettime
+
+#include "state_machine/TvRemoteSm.h"
+#include "state_machine/TvRemoteSm_queue.h"
+
+#define DEFAULT_COUNT 20000000u
+#define DEFAULT_BATCH 32
+#define ROUNDS 5
+
+static double seconds_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// xorshift64* so the events are reproducible from the seed.
+static uint64_t next_random(uint64_t* state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+static void start_machine(TvRemoteSm* sm)
+{
+    TvRemoteSm_ctor(sm);
+    sm->vars.output = &tv_output_null_sink;
+    TvRemoteSm_start(sm);
+}
+
+static bool same_configuration(const TvRemoteSm* a, const TvRemoteSm* b)
+{
+    return a->state_id == b->state_id && a->vars.volume == b->vars.volume && a->vars.brightness == b->vars.brightness
+        && a->vars.channel == b->vars.channel && a->vars.channel_entry == b->vars.channel_entry;
+}
+
+// Reorder every batch of `events` the way the queue drains it: priority events first, each group in order.
+static void order_like_queue(unsigned char* events, const size_t count, const int batch)
+{
+    unsigned char* normal = malloc((size_t)batch);
+    for (size_t first = 0; first < count; first += (size_t)batch)
+    {
+        const size_t end = (first + (size_t)batch < count) ? first + (size_t)batch : count;
+        size_t priority_count = 0;
+        size_t normal_count = 0;
+        for (size_t i = first; i < end; i++)
+        {
+            if (TvRemoteSm_queue_is_priority((TvRemoteSm_EventId)events[i]))
+            {
+                events[first + priority_count++] = events[i];
+            }
+            else
+            {
+                normal[normal_count++] = events[i];
+            }
+        }
+        memcpy(events + first + priority_count, normal, normal_count);
+    }
+    free(normal);
+}
+
+static double run_direct(const unsigned char* events, const size_t count, TvRemoteSm* sm)
+{
+    start_machine(sm);
+    const double start = seconds_now();
+    for (size_t i = 0; i < count; i++)
+    {
+        TvRemoteSm_dispatch_event(sm, (TvRemoteSm_EventId)events[i]);
+    }
+    return seconds_now() - start;
+}
+
+static double run_queued(const unsigned char* events, const size_t count, const int batch, TvRemoteSm* sm,
+    unsigned int* dropped)
+{
+    start_machine(sm);
+    TvRemoteSm_Queue queue;
+    TvRemoteSm_queue_init(&queue, sm);
+    const double start = seconds_now();
+    for (size_t first = 0; first < count; first += (size_t)batch)
+    {
+        const size_t end = (first + (size_t)batch < count) ? first + (size_t)batch : count;
+        for (size_t i = first; i < end; i++)
+        {
+            TvRemoteSm_queue_post(&queue, (TvRemoteSm_EventId)events[i]);
+        }
+        TvRemoteSm_queue_dispatch_all(&queue);
+    }
+    const double seconds = seconds_now() - start;
+    *dropped = atomic_load(&queue.dropped);
+    return seconds;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-n EVENTS] [-b BATCH] [-s SEED]\n", name);
+}
+
+int main(int argc, char ** argv)
+{
+    size_t count = DEFAULT_COUNT;
+    int batch = DEFAULT_BATCH;
+    uint64_t seed = 0x5eed;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            count = (size_t)strtoull(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+        {
+            batch = (int)strtol(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            seed = strtoull(argv[++i], NULL, 0);
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (count == 0 || batch < 1 || batch > TV_REMOTE_SM_QUEUE_CAPACITY || seed == 0)
+    {
+        fprintf(stderr, "EVENTS must be > 0, BATCH in [1, %d] & SEED not 0.\n", TV_REMOTE_SM_QUEUE_CAPACITY);
+        return EXIT_FAILURE;
+    }
+
+    unsigned char* events = malloc(count);
+    unsigned char* ordered = malloc(count);
+    if (events == NULL || ordered == NULL)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        events[i] = (unsigned char)(next_random(&seed) % TvRemoteSm_EventIdCount);
+    }
+    memcpy(ordered, events, count);
+    order_like_queue(ordered, count, batch);
+
+    // Best of a few rounds, alternating so both see the same machine conditions.
+    double direct = 0;
+    double queued = 0;
+    TvRemoteSm direct_sm;
+    TvRemoteSm queued_sm;
+    unsigned int dropped = 0;
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        const double d = run_direct(ordered, count, &direct_sm);
+        const double q = run_queued(events, count, batch, &queued_sm, &dropped);
+        direct = (round == 0 || d < direct) ? d : direct;
+        queued = (round == 0 || q < queued) ? q : queued;
+    }
+
+    printf("%zu events, batches of %d\n", count, batch);
+    printf("direct  %8.2f ns/event  %8.1f M events/s\n", direct * 1e9 / (double)count, (double)count / direct / 1e6);
+    printf("queued  %8.2f ns/event  %8.1f M events/s  (%+.1f%%)\n", queued * 1e9 / (double)count,
+        (double)count / queued / 1e6, (queued / direct - 1) * 100);
+    if (dropped != 0 || !same_configuration(&direct_sm, &queued_sm))
+    {
+        fprintf(stderr, "The queued run ended in %s, the direct run in %s (%u events dropped).\n",
+            TvRemoteSm_state_id_to_string(queued_sm.state_id), TvRemoteSm_state_id_to_string(direct_sm.state_id), dropped);
+        return EXIT_FAILURE;
+    }
+    free(events);
+    free(ordered);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,224 @@
+// Builds the memory-mapped channel table (see channels/channel_table.h) from a CSV lineup.
+//
+// CSV format, one channel per line:
+//   number,name,flags
+// where flags is empty or a space separated list of `skip` (listed but not tuned by channel up/down,
+// entry or the favorites) & `favorite`. Channel numbers that aren't listed are unused. Empty lines,
+// lines starting with '#' & a header line starting with "channel" are ignored.
+
+#include <ctype.h> // for isspace
+#include <errno.h> // for errno
+#include <stdbool.h> // for bool
+#include <stdio.h> // for fopen
+#include <stdlib.h> // for strtol
+#include <string.h> // for strtok
+
+#include "channels/channel_table.h"
+
+#define LINE_SIZE 256
+
+// Remove leading & trailing white space in place.
+static char* trim(char* text)
+{
+    while (isspace((unsigned char)*text))
+    {
+        text++;
+    }
+    size_t length = strlen(text);
+    while (length > 0 && isspace((unsigned char)text[length - 1]))
+    {
+        text[--length] = '\0';
+    }
+    return text;
+}
+
+// Parse one "number,name,flags" line into `entries`. Returns an error message or NULL.
+static const char* parse_line(char* line, ChannelTableEntry* entries, bool* listed)
+{
+    char* number_field = line;
+    char* name_field = strchr(number_field, ',');
+    if (name_field == NULL)
+    {
+        return "expected number,name,flags";
+    }
+    *name_field++ = '\0';
+    char* flags_field = strchr(name_field, ',');
+    if (flags_field != NULL)
+    {
+        *flags_field++ = '\0';
+    }
+
+    char* end;
+    number_field = trim(number_field);
+    const long number = strtol(number_field, &end, 10);
+    if (*number_field == '\0' || *end != '\0' || number < CHANNEL_TABLE_MIN_CHANNEL || number > CHANNEL_TABLE_MAX_CHANNEL)
+    {
+        return "channel number not in [1, 256]";
+    }
+    if (listed[number])
+    {
+        return "channel listed twice";
+    }
+    listed[number] = true;
+
+    ChannelTableEntry* entry = &entries[number];
+    name_field = trim(name_field);
+    if (strlen(name_field) >= CHANNEL_TABLE_NAME_SIZE)
+    {
+        return "name longer than 23 characters";
+    }
+    strcpy(entry->name, name_field);
+
+    bool skip = false;
+    bool favorite = false;
+    for (char* flag = strtok(flags_field ? flags_field : "", " \t\r\n"); flag != NULL; flag = strtok(NULL, " \t\r\n"))
+    {
+        if (strcmp(flag, "skip") == 0)
+        {
+            skip = true;
+        }
+        else if (strcmp(flag, "favorite") == 0)
+        {
+            favorite = true;
+        }
+        else
+        {
+            return "unknown flag (expected skip or favorite)";
+        }
+    }
+    if (skip && favorite)
+    {
+        return "a skipped channel can't be a favorite";
+    }
+    entry->flags = skip ? 0 : (uint8_t)(CHANNEL_ENABLED | (favorite ? CHANNEL_FAVORITE : 0));
+    return NULL;
+}
+
+static bool read_csv(const char* path, ChannelTableEntry* entries)
+{
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Cannot open %s: %s.\n", path, strerror(errno));
+        return false;
+    }
+
+    bool listed[CHANNEL_TABLE_ENTRY_COUNT] = { false };
+    char line[LINE_SIZE];
+    int line_number = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file) != NULL)
+    {
+        line_number++;
+        char* text = trim(line);
+        if (*text == '\0' || *text == '#' || strncmp(text, "channel", 7) == 0)
+        {
+            continue;
+        }
+        const char* error = parse_line(text, entries, listed);
+        if (error != NULL)
+        {
+            fprintf(stderr, "%s:%d: %s.\n", path, line_number, error);
+            ok = false;
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+static void put_u16(unsigned char* bytes, const uint16_t value)
+{
+    bytes[0] = (unsigned char)(value & 0xff);
+    bytes[1] = (unsigned char)(value >> 8);
+}
+
+static bool write_table(const char* path, const ChannelTableEntry* entries)
+{
+    unsigned char header[CHANNEL_TABLE_HEADER_SIZE] = { 0 };
+    memcpy(header, CHANNEL_TABLE_MAGIC, 8);
+    put_u16(&header[8], CHANNEL_TABLE_ENTRY_COUNT);
+    put_u16(&header[10], sizeof(ChannelTableEntry));
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Cannot create %s: %s.\n", path, strerror(errno));
+        return false;
+    }
+    bool ok = fwrite(header, sizeof(header), 1, file) == 1
+        && fwrite(entries, sizeof(ChannelTableEntry), CHANNEL_TABLE_ENTRY_COUNT, file) == CHANNEL_TABLE_ENTRY_COUNT;
+    ok = (fclose(file) == 0) && ok;
+    if (!ok)
+    {
+        fprintf(stderr, "Cannot write %s: %s.\n", path, strerror(errno));
+    }
+    return ok;
+}
+
+// Print the enabled channels of a table file with their links.
+static bool dump_table(const char* path)
+{
+    ChannelTable table;
+    if (!channel_table_open(&table, path))
+    {
+        fprintf(stderr, "Cannot load channel table %s: %s.\n", path, strerror(errno));
+        return false;
+    }
+    int enabled = 0;
+    for (int channel = CHANNEL_TABLE_MIN_CHANNEL; channel <= CHANNEL_TABLE_MAX_CHANNEL; channel++)
+    {
+        const ChannelTableEntry* entry = &table.entries[channel];
+        if (!(entry->flags & CHANNEL_ENABLED))
+        {
+            continue;
+        }
+        enabled++;
+        printf("%3d %-23s prev %3d next %3d favorite %3d%s\n", channel, entry->name, entry->prev, entry->next,
+            entry->next_favorite, (entry->flags & CHANNEL_FAVORITE) ? " *" : "");
+    }
+    printf("%d channels enabled.\n", enabled);
+    channel_table_close(&table);
+    return true;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s LINEUP_CSV TABLE_FILE\n       %s -d TABLE_FILE\n", name, name);
+}
+
+int main(int argc, char ** argv)
+{
+    if (argc == 3 && strcmp(argv[1], "-d") == 0)
+    {
+        return dump_table(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (argc != 3)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    ChannelTableEntry entries[CHANNEL_TABLE_ENTRY_COUNT];
+    memset(entries, 0, sizeof(entries));
+    if (!read_csv(argv[1], entries))
+    {
+        return EXIT_FAILURE;
+    }
+    if (!channel_table_link(entries))
+    {
+        fprintf(stderr, "%s: no channel is enabled.\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    if (!write_table(argv[2], entries))
+    {
+        return EXIT_FAILURE;
+    }
+
+    int enabled = 0;
+    for (int channel = CHANNEL_TABLE_MIN_CHANNEL; channel <= CHANNEL_TABLE_MAX_CHANNEL; channel++)
+    {
+        enabled += (entries[channel].flags & CHANNEL_ENABLED) ? 1 : 0;
+    }
+    printf("Wrote %d enabled channels to %s.\n", enabled, argv[2]);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,503 @@
+// Regression runner for a corpus of recorded key sessions (e.g. from load_gen or a keyboard).
+//
+// Every file of TRACE_DIR is a sequence of `struct input_event` records. A pool of threads takes the
+// files one at a time; each replays its file through its own gesture recognizer & TvRemoteSm (output
+// discarded, on the clock of the events) and compares every dispatch, as (event, state, volume,
+// brightness, channel, channel entry), with GOLDEN_DIR/FILE.golden. A file stops at its first
+// difference, which is reported with the input event that caused it. `-r` records the goldens instead.
+//
+// A golden file starts with the event & state names of the machine that recorded it, so states &
+// events that were added, removed or renumbered since only fail the files that actually reach them.
+
+#include <dirent.h> // for opendir
+#include <errno.h> // for errno
+#include <pthread.h> // for pthread_create
+#include <stdatomic.h> // for atomic_fetch_add
+#include <stdint.h> // for uint8_t
+#include <stdio.h> // for fopen
+#include <stdlib.h> // for qsort
+#include <string.h> // for strcmp
+#include <time.h> // for clock_gettime
+#include <unistd.h> // for sysconf
+
+#include "input/gesture.h"
+#include "state_machine/TvRemoteSm.h"
+
+#define MAX_THREADS 256
+#define PATH_SIZE 4096
+#define MESSAGE_SIZE 320
+#define INPUT_BUFFER_EVENTS 4096
+#define FILE_BUFFER_SIZE 65536
+
+#define GOLDEN_MAGIC "TVGOLD01"
+#define GOLDEN_NAME_SIZE 32
+#define GOLDEN_MAX_IDS 256
+
+typedef struct GoldenRecord {
+    uint8_t event_id;
+    uint8_t state_id;
+    uint16_t volume;
+    uint16_t brightness;
+    uint16_t channel;
+    uint16_t channel_entry;
+} GoldenRecord;
+
+typedef struct GoldenHeader {
+    char magic[8];
+    uint16_t event_count;
+    uint16_t state_count;
+} GoldenHeader;
+
+typedef struct FileResult {
+    bool failed;
+    uint64_t records;
+    char message[MESSAGE_SIZE];
+} FileResult;
+
+typedef struct Corpus {
+    const char* trace_dir;
+    const char* golden_dir;
+    bool record;
+    char** names;
+    size_t count;
+    FileResult* results;
+    atomic_size_t next;
+} Corpus;
+
+// One file being replayed.
+typedef struct Job {
+    FILE* golden;
+    bool record;
+    // Golden ids to the ids of this build, -1 for names it doesn't have.
+    int events[GOLDEN_MAX_IDS];
+    int states[GOLDEN_MAX_IDS];
+    char event_names[GOLDEN_MAX_IDS][GOLDEN_NAME_SIZE];
+    char state_names[GOLDEN_MAX_IDS][GOLDEN_NAME_SIZE];
+    TvRemoteSm sm;
+    GestureRecognizer gestures;
+    uint64_t input_events;
+    FileResult* result;
+    bool io_error;
+} Job;
+
+typedef struct Worker {
+    _Alignas(64) pthread_t thread;
+    Corpus* corpus;
+    Job job;
+    struct input_event buffer[INPUT_BUFFER_EVENTS];
+} Worker;
+
+static double seconds_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static GoldenRecord record_of(const TvRemoteSm* sm, const int event_id)
+{
+    return (GoldenRecord){
+        .event_id = (uint8_t)event_id,
+        .state_id = (uint8_t)sm->state_id,
+        .volume = sm->vars.volume,
+        .brightness = sm->vars.brightness,
+        .channel = sm->vars.channel,
+        .channel_entry = sm->vars.channel_entry,
+    };
+}
+
+static int describe(char* buffer, const size_t size, const char* event, const char* state, const GoldenRecord* record)
+{
+    return snprintf(buffer, size, "%s -> %s volume %u brightness %u channel %u entry %u", event, state,
+        record->volume, record->brightness, record->channel, record->channel_entry);
+}
+
+static const char* golden_event_name(const Job* job, const int id)
+{
+    return (id < GOLDEN_MAX_IDS && job->event_names[id][0] != '\0') ? job->event_names[id] : "?";
+}
+
+static const char* golden_state_name(const Job* job, const int id)
+{
+    return (id < GOLDEN_MAX_IDS && job->state_names[id][0] != '\0') ? job->state_names[id] : "?";
+}
+
+static void fail(Job* job, const GoldenRecord* expected, const GoldenRecord* actual, const struct input_event* source)
+{
+    FileResult* result = job->result;
+    result->failed = true;
+    int length = (source == NULL)
+        ? snprintf(result->message, sizeof(result->message), "record %llu (end of trace, %llu input events): ",
+            (unsigned long long)result->records, (unsigned long long)job->input_events)
+        : snprintf(result->message, sizeof(result->message), "record %llu (input event %llu at %lld.%06ld): ",
+            (unsigned long long)result->records, (unsigned long long)job->input_events,
+            (long long)source->input_event_sec, (long)source->input_event_usec);
+    char expected_text[128] = "nothing";
+    char actual_text[128] = "nothing";
+    if (expected != NULL)
+    {
+        describe(expected_text, sizeof(expected_text), golden_event_name(job, expected->event_id),
+            golden_state_name(job, expected->state_id), expected);
+    }
+    if (actual != NULL)
+    {
+        describe(actual_text, sizeof(actual_text), TvRemoteSm_event_id_to_string((TvRemoteSm_EventId)actual->event_id),
+            TvRemoteSm_state_id_to_string((TvRemoteSm_StateId)actual->state_id), actual);
+    }
+    snprintf(result->message + length, sizeof(result->message) - (size_t)length, "expected %s, got %s", expected_text, actual_text);
+}
+
+// Compare (or record) one dispatch.
+static void check_dispatch(void* ctx, const int event_id, const struct input_event* source)
+{
+    Job* job = ctx;
+    if (job->result->failed || job->io_error)
+    {
+        return;
+    }
+    const GoldenRecord actual = record_of(&job->sm, event_id);
+    if (job->record)
+    {
+        job->io_error = fwrite(&actual, sizeof(actual), 1, job->golden) != 1;
+        job->result->records++;
+        return;
+    }
+    GoldenRecord expected;
+    if (fread(&expected, sizeof(expected), 1, job->golden) != 1)
+    {
+        fail(job, NULL, &actual, source);
+        return;
+    }
+    if (job->events[expected.event_id] != actual.event_id || job->states[expected.state_id] != actual.state_id
+        || expected.volume != actual.volume || expected.brightness != actual.brightness
+        || expected.channel != actual.channel || expected.channel_entry != actual.channel_entry)
+    {
+        fail(job, &expected, &actual, source);
+        return;
+    }
+    job->result->records++;
+}
+
+static bool write_header(FILE* golden)
+{
+    GoldenHeader header = { .event_count = TvRemoteSm_EventIdCount, .state_count = TvRemoteSm_StateIdCount };
+    memcpy(header.magic, GOLDEN_MAGIC, sizeof(header.magic));
+    bool ok = fwrite(&header, sizeof(header), 1, golden) == 1;
+    char name[GOLDEN_NAME_SIZE];
+    for (int i = 0; i < TvRemoteSm_EventIdCount && ok; i++)
+    {
+        strncpy(name, TvRemoteSm_event_id_to_string((TvRemoteSm_EventId)i), sizeof(name) - 1);
+        name[sizeof(name) - 1] = '\0';
+        ok = fwrite(name, sizeof(name), 1, golden) == 1;
+    }
+    for (int i = 0; i < TvRemoteSm_StateIdCount && ok; i++)
+    {
+        strncpy(name, TvRemoteSm_state_id_to_string((TvRemoteSm_StateId)i), sizeof(name) - 1);
+        name[sizeof(name) - 1] = '\0';
+        ok = fwrite(name, sizeof(name), 1, golden) == 1;
+    }
+    return ok;
+}
+
+// Read the names of the golden file & map them to this build. Returns NULL or what is wrong with the file.
+static const char* read_header(Job* job)
+{
+    GoldenHeader header;
+    if (fread(&header, sizeof(header), 1, job->golden) != 1)
+    {
+        return "shorter than its header";
+    }
+    if (memcmp(header.magic, GOLDEN_MAGIC, sizeof(header.magic)) != 0)
+    {
+        return "bad magic, not " GOLDEN_MAGIC;
+    }
+    if (header.event_count > GOLDEN_MAX_IDS || header.state_count > GOLDEN_MAX_IDS)
+    {
+        return "more event or state names than a machine can have";
+    }
+    for (int i = 0; i < GOLDEN_MAX_IDS; i++)
+    {
+        job->events[i] = -1;
+        job->states[i] = -1;
+        job->event_names[i][0] = '\0';
+        job->state_names[i][0] = '\0';
+    }
+    for (int i = 0; i < header.event_count; i++)
+    {
+        if (fread(job->event_names[i], GOLDEN_NAME_SIZE, 1, job->golden) != 1)
+        {
+            return "ends in its event names";
+        }
+        job->event_names[i][GOLDEN_NAME_SIZE - 1] = '\0';
+        for (int id = 0; id < TvRemoteSm_EventIdCount; id++)
+        {
+            if (strcmp(job->event_names[i], TvRemoteSm_event_id_to_string((TvRemoteSm_EventId)id)) == 0)
+            {
+                job->events[i] = id;
+            }
+        }
+    }
+    for (int i = 0; i < header.state_count; i++)
+    {
+        if (fread(job->state_names[i], GOLDEN_NAME_SIZE, 1, job->golden) != 1)
+        {
+            return "ends in its state names";
+        }
+        job->state_names[i][GOLDEN_NAME_SIZE - 1] = '\0';
+        for (int id = 0; id < TvRemoteSm_StateIdCount; id++)
+        {
+            if (strcmp(job->state_names[i], TvRemoteSm_state_id_to_string((TvRemoteSm_StateId)id)) == 0)
+            {
+                job->states[i] = id;
+            }
+        }
+    }
+    return NULL;
+}
+
+static void run_file(Worker* worker, const size_t index)
+{
+    Corpus* corpus = worker->corpus;
+    Job* job = &worker->job;
+    FileResult* result = &corpus->results[index];
+    char trace_path[PATH_SIZE];
+    char golden_path[PATH_SIZE];
+    snprintf(trace_path, sizeof(trace_path), "%s/%s", corpus->trace_dir, corpus->names[index]);
+    snprintf(golden_path, sizeof(golden_path), "%s/%s.golden", corpus->golden_dir, corpus->names[index]);
+
+    FILE* trace = fopen(trace_path, "rb");
+    if (trace == NULL)
+    {
+        result->failed = true;
+        snprintf(result->message, sizeof(result->message), "cannot open: %s", strerror(errno));
+        return;
+    }
+    job->golden = fopen(golden_path, corpus->record ? "wb" : "rb");
+    if (job->golden == NULL)
+    {
+        result->failed = true;
+        snprintf(result->message, sizeof(result->message), "cannot open its golden file: %s", strerror(errno));
+        fclose(trace);
+        return;
+    }
+    setvbuf(job->golden, NULL, _IOFBF, FILE_BUFFER_SIZE);
+    job->record = corpus->record;
+    job->result = result;
+    job->io_error = false;
+    job->input_events = 0;
+    if (corpus->record)
+    {
+        if (!write_header(job->golden))
+        {
+            result->failed = true;
+            snprintf(result->message, sizeof(result->message), "cannot write the header of %s/%s.golden: %s",
+                corpus->golden_dir, corpus->names[index], strerror(errno));
+        }
+    }
+    else
+    {
+        const char* malformed = read_header(job);
+        if (malformed != NULL)
+        {
+            result->failed = true;
+            snprintf(result->message, sizeof(result->message), "golden file %s/%s.golden is malformed: %s",
+                corpus->golden_dir, corpus->names[index], malformed);
+        }
+    }
+
+    TvRemoteSm_ctor(&job->sm);
+    job->sm.vars.output = &tv_output_null_sink;
+    TvRemoteSm_start(&job->sm);
+    gesture_init(&job->gestures, &job->sm, DEFAULT_TAP_WINDOW, DEFAULT_CHORD_WINDOW);
+    gesture_set_callback(&job->gestures, check_dispatch, job);
+
+    // Stop reading at the first difference.
+    size_t n = 0;
+    while (!result->failed && !job->io_error && (n = fread(worker->buffer, sizeof(worker->buffer[0]), INPUT_BUFFER_EVENTS, trace)) > 0)
+    {
+        for (size_t i = 0; i < n && !result->failed; i++)
+        {
+            job->input_events++;
+            gesture_handle_input_event(&job->gestures, &worker->buffer[i]);
+        }
+    }
+    if (!result->failed)
+    {
+        gesture_flush(&job->gestures);
+    }
+    if (!result->failed && !corpus->record)
+    {
+        // Dispatches the golden file has & the trace no longer makes.
+        GoldenRecord expected;
+        if (fread(&expected, sizeof(expected), 1, job->golden) == 1)
+        {
+            fail(job, &expected, NULL, NULL);
+        }
+    }
+    if (ferror(trace))
+    {
+        result->failed = true;
+        snprintf(result->message, sizeof(result->message), "cannot read: %s", strerror(errno));
+    }
+    if (fclose(job->golden) != 0 || job->io_error)
+    {
+        result->failed = true;
+        snprintf(result->message, sizeof(result->message), "cannot write its golden file: %s", strerror(errno));
+    }
+    fclose(trace);
+}
+
+static void* run_worker(void* arg)
+{
+    Worker* worker = arg;
+    size_t index;
+    while ((index = atomic_fetch_add(&worker->corpus->next, 1)) < worker->corpus->count)
+    {
+        run_file(worker, index);
+    }
+    return NULL;
+}
+
+static int compare_names(const void* a, const void* b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// The regular files of `dir`, sorted.
+static bool list_files(Corpus* corpus)
+{
+    DIR* dir = opendir(corpus->trace_dir);
+    if (dir == NULL)
+    {
+        fprintf(stderr, "Cannot open %s: %s.\n", corpus->trace_dir, strerror(errno));
+        return false;
+    }
+    size_t capacity = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (entry->d_type != DT_REG && entry->d_type != DT_UNKNOWN)
+        {
+            continue;
+        }
+        if (corpus->count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 1024;
+            char** names = realloc(corpus->names, capacity * sizeof(char*));
+            if (names == NULL)
+            {
+                closedir(dir);
+                fprintf(stderr, "Out of memory.\n");
+                return false;
+            }
+            corpus->names = names;
+        }
+        corpus->names[corpus->count] = strdup(entry->d_name);
+        if (corpus->names[corpus->count] == NULL)
+        {
+            closedir(dir);
+            fprintf(stderr, "Out of memory.\n");
+            return false;
+        }
+        corpus->count++;
+    }
+    closedir(dir);
+    qsort(corpus->names, corpus->count, sizeof(char*), compare_names);
+    return true;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-j THREADS] [-r] TRACE_DIR GOLDEN_DIR\n", name);
+    fprintf(stderr, "  -r   record the golden files instead of comparing with them\n");
+}
+
+int main(int argc, char ** argv)
+{
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    Corpus corpus = { 0 };
+    int positional = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            threads = strtol(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "-r") == 0)
+        {
+            corpus.record = true;
+        }
+        else if (argv[i][0] != '-' && positional < 2)
+        {
+            *(positional++ == 0 ? &corpus.trace_dir : &corpus.golden_dir) = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (positional != 2)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    threads = (threads < 1) ? 1 : (threads > MAX_THREADS) ? MAX_THREADS : threads;
+
+    if (!list_files(&corpus))
+    {
+        return EXIT_FAILURE;
+    }
+    corpus.results = calloc(corpus.count ? corpus.count : 1, sizeof(FileResult));
+    Worker* workers = aligned_alloc(_Alignof(Worker), sizeof(Worker) * (size_t)threads);
+    if (corpus.results == NULL || workers == NULL)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        return EXIT_FAILURE;
+    }
+    atomic_init(&corpus.next, 0);
+
+    const double start = seconds_now();
+    long started = 0;
+    for (; started < threads; started++)
+    {
+        workers[started].corpus = &corpus;
+        if (pthread_create(&workers[started].thread, NULL, run_worker, &workers[started]) != 0)
+        {
+            break;
+        }
+    }
+    if (started == 0)
+    {
+        fprintf(stderr, "Cannot start a thread.\n");
+        return EXIT_FAILURE;
+    }
+    for (long t = 0; t < started; t++)
+    {
+        pthread_join(workers[t].thread, NULL);
+    }
+    const double seconds = seconds_now() - start;
+
+    size_t failed = 0;
+    unsigned long long records = 0;
+    for (size_t i = 0; i < corpus.count; i++)
+    {
+        records += corpus.results[i].records;
+        if (corpus.results[i].failed)
+        {
+            failed++;
+            printf("%s: %s\n", corpus.names[i], corpus.results[i].message);
+        }
+    }
+    printf("%zu files, %zu %s, %llu dispatches %s in %.2f s with %ld threads\n", corpus.count, failed,
+        corpus.record ? "not recorded" : "differ", records, corpus.record ? "recorded" : "matched", seconds, started);
+
+    for (size_t i = 0; i < corpus.count; i++)
+    {
+        free(corpus.names[i]);
+    }
+    free(corpus.names);
+    free(corpus.results);
+    free(workers);
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,29 @@
+# Fails when an object of the embedded profile references stdio or the heap.
+#   cmake -DNM=nm -DOBJECTS="a.o|b.o" -P check_symbols.cmake
+# Only our objects are checked: the static libc still brings its own allocator for its startup code.
+
+set(FORBIDDEN "^(.*printf.*|puts|fputs|putchar|fputc|putc|fwrite|fflush|fopen|fclose|stdout|stderr|malloc|calloc|realloc|free|reallocarray|aligned_alloc|posix_memalign|strdup|strndup)$")
+
+string(REPLACE "|" ";" OBJECT_LIST "${OBJECTS}")
+set(FOUND "")
+foreach(OBJECT ${OBJECT_LIST})
+    execute_process(COMMAND ${NM} -u ${OBJECT} OUTPUT_VARIABLE SYMBOLS RESULT_VARIABLE RESULT)
+    if(NOT RESULT EQUAL 0)
+        message(FATAL_ERROR "Cannot list the symbols of ${OBJECT}.")
+    endif()
+    string(REGEX MATCHALL "[^\n]+" LINES "${SYMBOLS}")
+    foreach(LINE ${LINES})
+        string(REGEX REPLACE "^ *U +" "" SYMBOL "${LINE}")
+        # Versioned names, e.g. from a shared libc.
+        string(REGEX REPLACE "@.*$" "" SYMBOL "${SYMBOL}")
+        if(SYMBOL MATCHES "${FORBIDDEN}")
+            get_filename_component(NAME ${OBJECT} NAME)
+            list(APPEND FOUND "${NAME}: ${SYMBOL}")
+        endif()
+    endforeach()
+endforeach()
+
+if(FOUND)
+    string(REPLACE ";" "\n  " FOUND "${FOUND}")
+    message(FATAL_ERROR "The embedded profile must not use stdio or the heap:\n  ${FOUND}")
+endif()
@@ -0,0 +1,145 @@
+// The remote for the embedded profile (TVREMOTE_EMBEDDED): the state machine & the gesture recognizer
+// reading one input device, with no stdio & no heap. Everything lives in static storage, the output
+// actions go through a sink that writes each line with one write() & numbers are formatted with
+// tv_output_format_value(). The build checks that none of its objects reference malloc() or printf()
+// (see check_symbols.cmake).
+//
+// Usage: remote_embedded [DEVICE]
+// It reads DEVICE (the keyboard of main.c by default) until the end of the input or SIGINT/SIGTERM.
+
+#include <errno.h> // for errno
+#include <fcntl.h> // for open
+#include <linux/input.h> // for input_event
+#include <poll.h> // for poll
+#include <signal.h> // for sigaction
+#include <stdlib.h> // for EXIT_FAILURE
+#include <string.h> // for strlen
+#include <sys/uio.h> // for writev
+#include <unistd.h> // for read
+
+#include "input/gesture.h"
+#include "output/tv_output.h"
+#include "state_machine/TvRemoteSm.h"
+
+#define DEFAULT_DEVICE "/dev/input/by-path/platform-i8042-serio-0-event-kbd"
+
+// Events read per read().
+#define READ_EVENTS 16
+
+static TvRemoteSm sm;
+static GestureRecognizer gestures;
+static struct input_event events[READ_EVENTS];
+static volatile sig_atomic_t stop_requested = 0;
+
+// Write the strings of `parts` to `fd` as one line.
+static void write_line(const int fd, const char* const* parts, const int count)
+{
+    struct iovec iov[8];
+    int n = 0;
+    for (int i = 0; i < count && n < 7; i++)
+    {
+        iov[n++] = (struct iovec){ .iov_base = (void*)parts[i], .iov_len = strlen(parts[i]) };
+    }
+    iov[n++] = (struct iovec){ .iov_base = "\n", .iov_len = 1 };
+    (void)writev(fd, iov, n);
+}
+
+static void sink_show(void* ctx, const char* message)
+{
+    const char* parts[] = { message };
+    write_line(*(const int*)ctx, parts, 1);
+}
+
+static void sink_value(void* ctx, TvOutputField field, unsigned short value)
+{
+    (void)field;
+    char text[TV_OUTPUT_VALUE_SIZE];
+    tv_output_format_value(text, value);
+    const char* parts[] = { text };
+    write_line(*(const int*)ctx, parts, 1);
+}
+
+static const int output_fd = STDOUT_FILENO;
+
+static const TvOutputSink sink = {
+    .show = sink_show,
+    .value = sink_value,
+    .ctx = (void*)&output_fd
+};
+
+static void request_stop(int signal_number)
+{
+    (void)signal_number;
+    stop_requested = 1;
+}
+
+// "Cannot open PATH: REASON." on stderr.
+static void print_error(const char* what, const char* path, const int error)
+{
+    const char* parts[] = { "Cannot ", what, " ", path, ": ", strerror(error), "." };
+    write_line(STDERR_FILENO, parts, 7);
+}
+
+int main(int argc, char ** argv)
+{
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-'))
+    {
+        const char* parts[] = { "Usage: ", argv[0], " [DEVICE]" };
+        write_line(STDERR_FILENO, parts, 3);
+        return EXIT_FAILURE;
+    }
+    const char* device = (argc == 2) ? argv[1] : DEFAULT_DEVICE;
+
+    TvRemoteSm_ctor(&sm);
+    sm.vars.output = &sink;
+    TvRemoteSm_start(&sm);
+    gesture_init(&gestures, &sm, DEFAULT_TAP_WINDOW, DEFAULT_CHORD_WINDOW);
+
+    const int fd = open(device, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        print_error("open", device, errno);
+        return EXIT_FAILURE;
+    }
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = request_stop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    int status = EXIT_SUCCESS;
+    while (!stop_requested)
+    {
+        // Wait for the next event, or until a held back key press is due.
+        struct pollfd input = { .fd = fd, .events = POLLIN };
+        const int ready = poll(&input, 1, gesture_timeout_ms(&gestures, timeInMicroseconds()));
+        if (ready == 0)
+        {
+            gesture_expire(&gestures, timeInMicroseconds());
+            continue;
+        }
+        const ssize_t n = (ready > 0) ? read(fd, events, sizeof(events)) : -1;
+        if (n == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n == -1)
+        {
+            print_error("read", device, errno);
+            status = EXIT_FAILURE;
+            break;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        for (size_t i = 0; i < (size_t)n / sizeof(events[0]); i++)
+        {
+            gesture_handle_input_event(&gestures, &events[i]);
+        }
+    }
+    gesture_flush(&gestures);
+    close(fd);
+    return status;
+}
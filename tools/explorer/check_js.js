@@ -0,0 +1,186 @@
+#!/usr/bin/env node
+// Checks the generated JavaScript machine against the transition table written by `sm_explorer -o`.
+//
+// Every record is replayed on TvRemoteSm.js: the machine is put into the record's state (by replaying
+// the shortest event path from start(), found breadth first like TvRemoteSm_restore.c does), its
+// vars are set, the event is dispatched and the resulting state & vars are compared. The records of
+// the state the table holds with one volume & brightness (CHANNEL_ENTRY) are replayed with other
+// values of them too, which the machine must keep.
+//
+// Usage: node check_js.js TABLE_FILE [path/to/TvRemoteSm.js]
+
+"use strict";
+
+const fs = require("fs");
+const path = require("path");
+
+const HEADER_SIZE = 20;
+const RECORD_SIZE = 16;
+const MAX_REPORTED = 10;
+const MAX_IDLE_PER_STATE = 64;
+
+// Load the generated class with a `console` that discards the output actions.
+function loadMachine(file) {
+    const source = fs.readFileSync(file, "utf8");
+    const silentConsole = { log() {} };
+    return new Function("console", source + "\nreturn TvRemoteSm;")(silentConsole);
+}
+
+// Shortest event path from start() to every reachable state.
+function findPaths(TvRemoteSm) {
+    const paths = new Map();
+    const start = new TvRemoteSm();
+    start.start();
+    paths.set(start.stateId, []);
+    const queue = [start.stateId];
+    while (queue.length > 0) {
+        const from = paths.get(queue.shift());
+        for (let event = 0; event < TvRemoteSm.EventIdCount; event++) {
+            const sm = replay(TvRemoteSm, from);
+            sm.dispatchEvent(event);
+            if (!paths.has(sm.stateId)) {
+                paths.set(sm.stateId, from.concat([event]));
+                queue.push(sm.stateId);
+            }
+        }
+    }
+    return paths;
+}
+
+function replay(TvRemoteSm, events) {
+    const sm = new TvRemoteSm();
+    sm.start();
+    for (const event of events) {
+        sm.dispatchEvent(event);
+    }
+    return sm;
+}
+
+// Same per-record hash as sm_explorer.c so the digests can be compared.
+function hashRecord(buffer, offset) {
+    let h = 0x811c9dc5;
+    for (let i = 0; i < RECORD_SIZE; i += 4) {
+        h = Math.imul(h ^ buffer.readUInt32LE(offset + i), 0x9e3779b1);
+        h = (h ^ (h >>> 15)) >>> 0;
+    }
+    return h;
+}
+
+function main() {
+    const tablePath = process.argv[2];
+    const machinePath = process.argv[3] || path.join(__dirname, "..", "..", "state_machine", "TvRemoteSm.js");
+    if (!tablePath) {
+        console.error("Usage: node check_js.js TABLE_FILE [TvRemoteSm.js]");
+        process.exit(2);
+    }
+
+    const TvRemoteSm = loadMachine(machinePath);
+    const paths = findPaths(TvRemoteSm);
+    const stateNames = Object.keys(TvRemoteSm.StateId);
+    const eventNames = Object.keys(TvRemoteSm.EventId);
+
+    const fd = fs.openSync(tablePath, "r");
+    const header = Buffer.alloc(HEADER_SIZE);
+    fs.readSync(fd, header, 0, HEADER_SIZE, 0);
+    if (header.toString("latin1", 0, 8) !== "TVSMTT03") {
+        console.error(`${tablePath} is not a transition table.`);
+        process.exit(2);
+    }
+    if (header.readUInt16LE(8) !== TvRemoteSm.StateIdCount || header.readUInt16LE(10) !== TvRemoteSm.EventIdCount) {
+        console.error("The table was generated from a diagram with different states or events.");
+        process.exit(1);
+    }
+    const entryState = header[16];
+    const OTHER_VARS = [[0, 100], [100, 0]];
+
+    // Idle machines per state. A machine lands in the pool of the state it ends up in,
+    // so most records don't need to replay a path. The pools are capped because events that
+    // leave a state would otherwise pile up machines in the states they lead to.
+    const pool = new Map();
+    const take = (stateId) => {
+        const idle = pool.get(stateId);
+        if (idle && idle.length > 0) {
+            return idle.pop();
+        }
+        if (!paths.has(stateId)) {
+            return null;
+        }
+        return replay(TvRemoteSm, paths.get(stateId));
+    };
+    const give = (sm) => {
+        if (!pool.has(sm.stateId)) {
+            pool.set(sm.stateId, []);
+        }
+        const idle = pool.get(sm.stateId);
+        if (idle.length < MAX_IDLE_PER_STATE) {
+            idle.push(sm);
+        }
+    };
+
+    const started = process.hrtime.bigint();
+    const chunk = Buffer.alloc(RECORD_SIZE * 65536);
+    let position = HEADER_SIZE;
+    let records = 0;
+    let mismatches = 0;
+    let digest = 0;
+
+    // Dispatch the event of the record at `o` to `sm` with the given volume & brightness.
+    const check = (sm, o, volume, brightness, expected) => {
+        sm.vars.volume = volume;
+        sm.vars.brightness = brightness;
+        sm.vars.channel = chunk.readUInt16LE(o + 4);
+        sm.vars.channel_entry = chunk.readUInt16LE(o + 6);
+        sm.dispatchEvent(chunk[o + 1]);
+
+        const actual = [sm.stateId, sm.vars.volume, sm.vars.brightness, sm.vars.channel, sm.vars.channel_entry];
+        if (expected.some((value, i) => value !== actual[i])) {
+            mismatches++;
+            if (mismatches <= MAX_REPORTED) {
+                console.log(`${stateNames[chunk[o]]} vol=${volume} bri=${brightness} ch=${chunk.readUInt16LE(o + 4)} entry=${chunk.readUInt16LE(o + 6)} + ${eventNames[chunk[o + 1]]}:` +
+                    ` C -> ${stateNames[expected[0]]} ${expected.slice(1).join("/")},` +
+                    ` JS -> ${stateNames[actual[0]]} ${actual.slice(1).join("/")}`);
+            }
+        }
+        give(sm);
+    };
+
+    for (;;) {
+        const read = fs.readSync(fd, chunk, 0, chunk.length, position);
+        if (read < RECORD_SIZE) {
+            break;
+        }
+        const count = Math.floor(read / RECORD_SIZE);
+        position += count * RECORD_SIZE;
+
+        for (let r = 0; r < count; r++) {
+            const o = r * RECORD_SIZE;
+            const state = chunk[o];
+            const sm = take(state);
+            records++;
+            digest = (digest + hashRecord(chunk, o)) >>> 0;
+            if (sm === null) {
+                mismatches++;
+                if (mismatches <= MAX_REPORTED) {
+                    console.log(`JS machine can't reach ${stateNames[state]}.`);
+                }
+                continue;
+            }
+
+            const expected = [chunk[o + 8], chunk[o + 10], chunk[o + 11], chunk.readUInt16LE(o + 12), chunk.readUInt16LE(o + 14)];
+            check(sm, o, chunk[o + 2], chunk[o + 3], expected);
+            if (state === entryState) {
+                for (const [volume, brightness] of OTHER_VARS) {
+                    const other = take(state);
+                    check(other, o, volume, brightness, [expected[0], volume, brightness, expected[3], expected[4]]);
+                }
+            }
+        }
+    }
+    fs.closeSync(fd);
+
+    const seconds = Number(process.hrtime.bigint() - started) / 1e9;
+    console.log(`Checked ${records} records in ${seconds.toFixed(3)} s, digest ${digest.toString(16).padStart(8, "0")}, ${mismatches} mismatches.`);
+    process.exit(mismatches === 0 ? 0 : 1);
+}
+
+main();
@@ -0,0 +1,595 @@
+// Exhaustive state space explorer for the generated C state machine.
+//
+// Breadth first search over every reachable (state_id, volume, brightness, channel, channel_entry)
+// configuration, starting from `TvRemoteSm_start()`. Visited configurations are one bit each in a
+// bitmap that the worker threads update atomically. `channel_entry` is only non-zero in CHANNEL_ENTRY,
+// and no action reads or writes the volume & brightness there, so CHANNEL_ENTRY is explored over
+// (channel, channel_entry) only, with the volume & brightness of the initial configuration: a
+// transition into it keeps the channel & entry of its target. Every transition out of CHANNEL_ENTRY is
+// checked to keep the volume & brightness, and to do the same with other values of them.
+//   16 states x 101 x 101 x 257 + (CHANNEL_ENTRY) 257 x 260 ~ 42M bits = 5 MB.
+//
+// Optionally writes the canonical transition table: one record per reachable configuration & event,
+// sorted by (state, volume, brightness, channel, event), then the CHANNEL_ENTRY configurations sorted
+// by (channel, channel_entry, event). `check_js.js` replays the table against the generated
+// JavaScript machine to check that both machines behave the same.
+//
+// Table format (little endian):
+//   header:  "TVSMTT03", u16 state count, u16 event count, u32 stride,
+//            u8 CHANNEL_ENTRY (the state explored with one volume & brightness), u8 its volume,
+//            u8 its brightness, u8 0
+//   records: u8 state, u8 event, u8 volume, u8 brightness, u16 channel, u16 channel_entry,
+//            u8 next state, u8 0, u8 next volume, u8 next brightness, u16 next channel, u16 next channel_entry
+
+#include <errno.h> // for errno
+#include <fcntl.h> // for open
+#include <pthread.h> // for pthread_create
+#include <stdatomic.h> // for atomic_fetch_or
+#include <stdbool.h> // for bool
+#include <stdint.h> // for uint64_t
+#include <stdio.h> // for printf
+#include <stdlib.h> // for calloc
+#include <string.h> // for strerror
+#include <time.h> // for clock_gettime
+#include <unistd.h> // for pwrite & sysconf
+
+#include "state_machine/TvRemoteSm.h"
+#include "state_machine/TvRemoteSm_restore.h"
+
+#define VOLUME_VALUES 101
+#define BRIGHTNESS_VALUES 101
+#define CHANNEL_VALUES 257
+#define CHANNEL_ENTRY_VALUES 260
+#define VARS_COUNT ((uint32_t)VOLUME_VALUES * BRIGHTNESS_VALUES * CHANNEL_VALUES)
+// Configurations of every state without an entry, then those of CHANNEL_ENTRY.
+#define BASE_CONFIG_COUNT ((uint32_t)TvRemoteSm_StateIdCount * VARS_COUNT)
+#define CONFIG_COUNT (BASE_CONFIG_COUNT + (uint32_t)CHANNEL_VALUES * CHANNEL_ENTRY_VALUES)
+#define BITMAP_WORDS ((CONFIG_COUNT + 63) / 64)
+
+#define HEADER_SIZE 20
+#define RECORD_SIZE 16
+#define MAX_THREADS 256
+
+// Configurations per block when writing the table. Each block is written by one thread.
+#define EMIT_BLOCK_WORDS 1024
+
+static _Atomic uint64_t* visited;
+
+// Set when a dispatch produced vars outside the ranges above.
+static atomic_bool out_of_range;
+
+// The volume & brightness of the CHANNEL_ENTRY configurations (those of the initial configuration).
+static unsigned short entry_volume;
+static unsigned short entry_brightness;
+
+// Set when a transition out of CHANNEL_ENTRY changed or depended on the volume or brightness.
+static atomic_bool entry_uses_vars;
+
+static double seconds_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static bool encode_config(const TvRemoteSm* sm, uint32_t* index)
+{
+    const TvRemoteSm_Vars* vars = &sm->vars;
+    if (vars->volume >= VOLUME_VALUES || vars->brightness >= BRIGHTNESS_VALUES || vars->channel >= CHANNEL_VALUES)
+    {
+        return false;
+    }
+    if (sm->state_id == TvRemoteSm_StateId_CHANNEL_ENTRY)
+    {
+        if (vars->channel_entry >= CHANNEL_ENTRY_VALUES)
+        {
+            return false;
+        }
+        *index = BASE_CONFIG_COUNT + (uint32_t)vars->channel * CHANNEL_ENTRY_VALUES + vars->channel_entry;
+        return true;
+    }
+    const uint32_t vars_index = ((uint32_t)vars->volume * BRIGHTNESS_VALUES + vars->brightness) * CHANNEL_VALUES + vars->channel;
+    if (vars->channel_entry != 0)
+    {
+        return false;
+    }
+    *index = (uint32_t)sm->state_id * VARS_COUNT + vars_index;
+    return true;
+}
+
+static void decode_config(uint32_t index, TvRemoteSm* sm)
+{
+    TvRemoteSm_Vars vars = {
+        .output = &tv_output_null_sink
+    };
+    if (index >= BASE_CONFIG_COUNT)
+    {
+        index -= BASE_CONFIG_COUNT;
+        vars.volume = entry_volume;
+        vars.brightness = entry_brightness;
+        vars.channel = (unsigned short)(index / CHANNEL_ENTRY_VALUES);
+        vars.channel_entry = (unsigned short)(index % CHANNEL_ENTRY_VALUES);
+        TvRemoteSm_restore(sm, TvRemoteSm_StateId_CHANNEL_ENTRY, &vars);
+        return;
+    }
+    const TvRemoteSm_StateId state_id = (TvRemoteSm_StateId)(index / VARS_COUNT);
+    index %= VARS_COUNT;
+    vars.channel = (unsigned short)(index % CHANNEL_VALUES);
+    index /= CHANNEL_VALUES;
+    vars.brightness = (unsigned short)(index % BRIGHTNESS_VALUES);
+    index /= BRIGHTNESS_VALUES;
+    vars.volume = (unsigned short)index;
+    TvRemoteSm_restore(sm, state_id, &vars);
+}
+
+// The configurations of `state` are indexes [first, last).
+static void state_configs(const int state, uint32_t* first, uint32_t* last)
+{
+    if (state == TvRemoteSm_StateId_CHANNEL_ENTRY)
+    {
+        *first = BASE_CONFIG_COUNT;
+        *last = CONFIG_COUNT;
+        return;
+    }
+    *first = (uint32_t)state * VARS_COUNT;
+    *last = *first + VARS_COUNT;
+}
+
+// Mark a configuration as visited. Returns true if this call visited it first.
+static bool visit(const uint32_t index)
+{
+    const uint64_t bit = 1ULL << (index % 64);
+    return (atomic_fetch_or_explicit(&visited[index / 64], bit, memory_order_relaxed) & bit) == 0;
+}
+
+typedef struct Frontier {
+    uint32_t* items;
+    size_t count;
+    size_t capacity;
+} Frontier;
+
+static void frontier_push(Frontier* frontier, const uint32_t index)
+{
+    if (frontier->count == frontier->capacity)
+    {
+        frontier->capacity = frontier->capacity ? frontier->capacity * 2 : 4096;
+        frontier->items = realloc(frontier->items, frontier->capacity * sizeof(uint32_t));
+        if (frontier->items == NULL)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    frontier->items[frontier->count++] = index;
+}
+
+// Whether the transition from the CHANNEL_ENTRY configuration `from` to `to` keeps the volume &
+// brightness, and is the same with the extremes of them.
+static bool entry_keeps_vars(const TvRemoteSm* from, const int event, const TvRemoteSm* to)
+{
+    if (to->vars.volume != from->vars.volume || to->vars.brightness != from->vars.brightness)
+    {
+        return false;
+    }
+    static const unsigned short OTHER_VARS[][2] = { { 0, BRIGHTNESS_VALUES - 1 }, { VOLUME_VALUES - 1, 0 } };
+    for (size_t i = 0; i < sizeof(OTHER_VARS) / sizeof(OTHER_VARS[0]); i++)
+    {
+        TvRemoteSm other = *from;
+        other.vars.volume = OTHER_VARS[i][0];
+        other.vars.brightness = OTHER_VARS[i][1];
+        TvRemoteSm_dispatch_event(&other, (TvRemoteSm_EventId)event);
+        if (other.state_id != to->state_id || other.vars.volume != OTHER_VARS[i][0] || other.vars.brightness != OTHER_VARS[i][1]
+            || other.vars.channel != to->vars.channel || other.vars.channel_entry != to->vars.channel_entry)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+typedef struct ExpandJob {
+    const uint32_t* items;
+    size_t begin;
+    size_t end;
+    Frontier next;
+    unsigned long long transitions;
+} ExpandJob;
+
+// Expand one slice of the current BFS level into a thread-local next level.
+static void* expand(void* arg)
+{
+    ExpandJob* job = arg;
+    TvRemoteSm from;
+    TvRemoteSm sm;
+
+    for (size_t i = job->begin; i < job->end; i++)
+    {
+        decode_config(job->items[i], &from);
+        for (int event = 0; event < TvRemoteSm_EventIdCount; event++)
+        {
+            sm = from;
+            TvRemoteSm_dispatch_event(&sm, (TvRemoteSm_EventId)event);
+            job->transitions++;
+            if (from.state_id == TvRemoteSm_StateId_CHANNEL_ENTRY && !entry_keeps_vars(&from, event, &sm))
+            {
+                atomic_store(&entry_uses_vars, true);
+            }
+
+            uint32_t index;
+            if (!encode_config(&sm, &index))
+            {
+                atomic_store(&out_of_range, true);
+                continue;
+            }
+            if (visit(index))
+            {
+                frontier_push(&job->next, index);
+            }
+        }
+    }
+    return NULL;
+}
+
+typedef struct EmitJob {
+    const uint64_t* block_offsets; // First record of each block.
+    size_t block_count;
+    atomic_size_t* next_block;
+    unsigned int stride;
+    int fd;
+    uint32_t digest;
+    bool failed;
+} EmitJob;
+
+// Per-record hash, summed so the digest doesn't depend on the order blocks are written in.
+// Mirrored by check_js.js.
+static uint32_t hash_record(const uint8_t* record)
+{
+    uint32_t h = 0x811c9dc5u;
+    for (int i = 0; i < RECORD_SIZE; i += 4)
+    {
+        const uint32_t word = (uint32_t)record[i] | ((uint32_t)record[i + 1] << 8) | ((uint32_t)record[i + 2] << 16) | ((uint32_t)record[i + 3] << 24);
+        h = (h ^ word) * 0x9e3779b1u;
+        h ^= h >> 15;
+    }
+    return h;
+}
+
+static void write_record(uint8_t* record, const TvRemoteSm* from, const int event, const TvRemoteSm* to)
+{
+    record[0] = (uint8_t)from->state_id;
+    record[1] = (uint8_t)event;
+    record[2] = (uint8_t)from->vars.volume;
+    record[3] = (uint8_t)from->vars.brightness;
+    record[4] = (uint8_t)(from->vars.channel & 0xff);
+    record[5] = (uint8_t)(from->vars.channel >> 8);
+    record[6] = (uint8_t)(from->vars.channel_entry & 0xff);
+    record[7] = (uint8_t)(from->vars.channel_entry >> 8);
+    record[8] = (uint8_t)to->state_id;
+    record[9] = 0;
+    record[10] = (uint8_t)to->vars.volume;
+    record[11] = (uint8_t)to->vars.brightness;
+    record[12] = (uint8_t)(to->vars.channel & 0xff);
+    record[13] = (uint8_t)(to->vars.channel >> 8);
+    record[14] = (uint8_t)(to->vars.channel_entry & 0xff);
+    record[15] = (uint8_t)(to->vars.channel_entry >> 8);
+}
+
+// Write the records of whole bitmap blocks at their final offset in the table.
+static void* emit(void* arg)
+{
+    EmitJob* job = arg;
+    static const size_t BUFFER_RECORDS = EMIT_BLOCK_WORDS * 64 * TvRemoteSm_EventIdCount;
+    uint8_t* buffer = malloc(BUFFER_RECORDS * RECORD_SIZE);
+    if (buffer == NULL)
+    {
+        job->failed = true;
+        return NULL;
+    }
+
+    size_t block;
+    while ((block = atomic_fetch_add(job->next_block, 1)) < job->block_count)
+    {
+        const size_t first_word = block * EMIT_BLOCK_WORDS;
+        size_t last_word = first_word + EMIT_BLOCK_WORDS;
+        if (last_word > BITMAP_WORDS)
+        {
+            last_word = BITMAP_WORDS;
+        }
+
+        // Rank of the first configuration in this block, used for the stride.
+        uint64_t rank = job->block_offsets[block];
+        size_t records = 0;
+        for (size_t word = first_word; word < last_word; word++)
+        {
+            uint64_t bits = atomic_load_explicit(&visited[word], memory_order_relaxed);
+            while (bits)
+            {
+                const uint32_t index = (uint32_t)(word * 64 + (size_t)__builtin_ctzll(bits));
+                bits &= bits - 1;
+                if (rank++ % job->stride != 0)
+                {
+                    continue;
+                }
+
+                TvRemoteSm from;
+                decode_config(index, &from);
+                for (int event = 0; event < TvRemoteSm_EventIdCount; event++)
+                {
+                    TvRemoteSm to = from;
+                    TvRemoteSm_dispatch_event(&to, (TvRemoteSm_EventId)event);
+                    uint8_t* record = &buffer[records++ * RECORD_SIZE];
+                    write_record(record, &from, event, &to);
+                    job->digest += hash_record(record);
+                }
+            }
+        }
+
+        if (job->fd >= 0 && records > 0)
+        {
+            // Records before this block: one per event for every sampled configuration.
+            const uint64_t first_sample = (job->block_offsets[block] + job->stride - 1) / job->stride;
+            const off_t offset = HEADER_SIZE + (off_t)(first_sample * TvRemoteSm_EventIdCount * RECORD_SIZE);
+            if (pwrite(job->fd, buffer, records * RECORD_SIZE, offset) != (ssize_t)(records * RECORD_SIZE))
+            {
+                job->failed = true;
+            }
+        }
+    }
+    free(buffer);
+    return NULL;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-j THREADS] [-o TABLE_FILE] [-s STRIDE]\n", name);
+}
+
+int main(int argc, char ** argv)
+{
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    const char* table_path = NULL;
+    unsigned int stride = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            threads = strtol(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            table_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            stride = (unsigned int)strtoul(argv[++i], NULL, 10);
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+    if (threads > MAX_THREADS)
+    {
+        threads = MAX_THREADS;
+    }
+    if (stride < 1)
+    {
+        stride = 1;
+    }
+
+    TvRemoteSm_restore_init();
+    visited = calloc(BITMAP_WORDS, sizeof(uint64_t));
+    if (visited == NULL)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        return EXIT_FAILURE;
+    }
+
+    const double start = seconds_now();
+
+    // The initial configuration.
+    TvRemoteSm sm;
+    TvRemoteSm_ctor(&sm);
+    sm.vars.output = &tv_output_null_sink;
+    TvRemoteSm_start(&sm);
+    entry_volume = sm.vars.volume;
+    entry_brightness = sm.vars.brightness;
+    uint32_t initial;
+    if (!encode_config(&sm, &initial))
+    {
+        fprintf(stderr, "Initial vars out of range.\n");
+        return EXIT_FAILURE;
+    }
+    visit(initial);
+
+    Frontier frontier = { 0 };
+    frontier_push(&frontier, initial);
+
+    pthread_t workers[MAX_THREADS];
+    bool threaded[MAX_THREADS];
+    ExpandJob jobs[MAX_THREADS];
+    memset(jobs, 0, sizeof(jobs));
+    unsigned long long configs = 1;
+    unsigned long long transitions = 0;
+    unsigned int depth = 0;
+
+    // Level synchronous BFS: each thread expands a slice of the level.
+    while (frontier.count > 0)
+    {
+        const long used = (frontier.count < 1024) ? 1 : threads;
+        const size_t slice = (frontier.count + (size_t)used - 1) / (size_t)used;
+        for (long t = 0; t < used; t++)
+        {
+            jobs[t].items = frontier.items;
+            jobs[t].begin = (size_t)t * slice;
+            jobs[t].end = jobs[t].begin + slice;
+            if (jobs[t].begin > frontier.count)
+            {
+                jobs[t].begin = frontier.count;
+            }
+            if (jobs[t].end > frontier.count)
+            {
+                jobs[t].end = frontier.count;
+            }
+            jobs[t].next.count = 0;
+            // A slice without a thread is expanded here.
+            threaded[t] = used > 1 && pthread_create(&workers[t], NULL, expand, &jobs[t]) == 0;
+            if (!threaded[t])
+            {
+                expand(&jobs[t]);
+            }
+        }
+
+        frontier.count = 0;
+        for (long t = 0; t < used; t++)
+        {
+            if (threaded[t])
+            {
+                pthread_join(workers[t], NULL);
+            }
+            for (size_t i = 0; i < jobs[t].next.count; i++)
+            {
+                frontier_push(&frontier, jobs[t].next.items[i]);
+            }
+            configs += jobs[t].next.count;
+            transitions += jobs[t].transitions;
+            jobs[t].transitions = 0;
+        }
+        depth++;
+    }
+    const double explored = seconds_now();
+
+    if (atomic_load(&out_of_range))
+    {
+        fprintf(stderr, "A transition produced vars outside volume [0, 100], brightness [0, 100], channel [0, 256] or channel entry [0, 259] (0 outside CHANNEL_ENTRY).\n");
+        return EXIT_FAILURE;
+    }
+    if (atomic_load(&entry_uses_vars))
+    {
+        fprintf(stderr, "A transition out of CHANNEL_ENTRY changed or depended on the volume or brightness, so it can't be explored with one value of them.\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("Explored %llu configurations (%llu transitions, depth %u) in %.3f s with %ld threads.\n",
+        configs, transitions, depth, explored - start, threads);
+    for (int state = 0; state < TvRemoteSm_StateIdCount; state++)
+    {
+        unsigned long long count = 0;
+        uint32_t first;
+        uint32_t last;
+        state_configs(state, &first, &last);
+        for (uint32_t index = first; index < last; index++)
+        {
+            count += (atomic_load_explicit(&visited[index / 64], memory_order_relaxed) >> (index % 64)) & 1;
+        }
+        if (count > 0)
+        {
+            printf("  %-28s %llu\n", TvRemoteSm_state_id_to_string((TvRemoteSm_StateId)state), count);
+        }
+    }
+
+    // Transition table: prefix counts per block give every thread its output offset.
+    const size_t block_count = (BITMAP_WORDS + EMIT_BLOCK_WORDS - 1) / EMIT_BLOCK_WORDS;
+    uint64_t* block_offsets = calloc(block_count, sizeof(uint64_t));
+    uint64_t total = 0;
+    for (size_t block = 0; block < block_count; block++)
+    {
+        block_offsets[block] = total;
+        for (size_t word = block * EMIT_BLOCK_WORDS; word < (block + 1) * EMIT_BLOCK_WORDS && word < BITMAP_WORDS; word++)
+        {
+            total += (uint64_t)__builtin_popcountll(atomic_load_explicit(&visited[word], memory_order_relaxed));
+        }
+    }
+
+    int fd = -1;
+    if (table_path != NULL)
+    {
+        fd = open(table_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd == -1)
+        {
+            fprintf(stderr, "Cannot open %s: %s.\n", table_path, strerror(errno));
+            return EXIT_FAILURE;
+        }
+        uint8_t header[HEADER_SIZE] = { 'T', 'V', 'S', 'M', 'T', 'T', '0', '3' };
+        header[8] = TvRemoteSm_StateIdCount;
+        header[10] = TvRemoteSm_EventIdCount;
+        header[12] = (uint8_t)(stride & 0xff);
+        header[13] = (uint8_t)((stride >> 8) & 0xff);
+        header[14] = (uint8_t)((stride >> 16) & 0xff);
+        header[15] = (uint8_t)((stride >> 24) & 0xff);
+        header[16] = TvRemoteSm_StateId_CHANNEL_ENTRY;
+        header[17] = (uint8_t)entry_volume;
+        header[18] = (uint8_t)entry_brightness;
+        if (pwrite(fd, header, sizeof(header), 0) != (ssize_t)sizeof(header))
+        {
+            fprintf(stderr, "Cannot write %s.\n", table_path);
+            return EXIT_FAILURE;
+        }
+    }
+
+    atomic_size_t next_block = 0;
+    EmitJob emit_jobs[MAX_THREADS];
+    long started = 0;
+    for (; started < threads; started++)
+    {
+        const long t = started;
+        emit_jobs[t] = (EmitJob) {
+            .block_offsets = block_offsets,
+            .block_count = block_count,
+            .next_block = &next_block,
+            .stride = stride,
+            .fd = fd,
+            .digest = 0,
+            .failed = false
+        };
+        if (pthread_create(&workers[t], NULL, emit, &emit_jobs[t]) != 0)
+        {
+            break;
+        }
+    }
+    // The threads take blocks until none are left, so any number of them writes the whole table.
+    const long emitters = (started > 0) ? started : 1;
+    if (started == 0)
+    {
+        emit(&emit_jobs[0]);
+    }
+    uint32_t digest = 0;
+    bool failed = false;
+    for (long t = 0; t < emitters; t++)
+    {
+        if (t < started)
+        {
+            pthread_join(workers[t], NULL);
+        }
+        digest += emit_jobs[t].digest;
+        failed |= emit_jobs[t].failed;
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    if (failed)
+    {
+        fprintf(stderr, "Failed to write the transition table.\n");
+        return EXIT_FAILURE;
+    }
+
+    const unsigned long long sampled = (total + stride - 1) / stride;
+    printf("Transition table: %llu records (stride %u), digest %08x, %.3f s.\n",
+        sampled * TvRemoteSm_EventIdCount, stride, digest, seconds_now() - explored);
+
+    free(block_offsets);
+    free(frontier.items);
+    for (long t = 0; t < threads; t++)
+    {
+        free(jobs[t].next.items);
+    }
+    free((void*)visited);
+    return EXIT_SUCCESS;
+}
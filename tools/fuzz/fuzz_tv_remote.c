@@ -0,0 +1,364 @@
+// Fuzz harness for the input event -> TvRemoteSm pipeline.
+//
+// Each input is a stream of 4 byte records. Every record becomes a `struct input_event` that is
+// pushed through the gesture recognizer (default windows) exactly like `main()` does with the keyboard:
+//   byte 0: bit 0 selects B1/B2, bit 6 makes it a non-key (EV_MSC) event,
+//           bit 7 replaces the key code with the low 7 bits (i.e. some other key).
+//   byte 1: key value, mapped to -1..3 so out of range values are exercised.
+//   byte 2-3: little endian time since the previous event in ms.
+// The presses still held back at the end of the input are flushed.
+// The state machine invariants are checked after every event and the process aborts on a violation.
+//
+// Built with clang and TVREMOTE_LIBFUZZER this is a libFuzzer target. Otherwise it is a standalone
+// driver that works with AFL (stdin, persistent mode when available), replays files and has a fast
+// in-process random mode & a corpus minimizer.
+
+#include <dirent.h> // for opendir
+#include <stdbool.h> // for bool
+#include <stddef.h> // for size_t
+#include <stdint.h> // for uint8_t
+#include <stdio.h> // for fprintf
+#include <stdlib.h> // for abort
+#include <string.h> // for memset
+#include <time.h> // for clock_gettime
+
+#include "input/gesture.h"
+#include "input/key_input.h"
+#include "output/tv_output.h"
+#include "state_machine/TvRemoteSm.h"
+
+#define RECORD_SIZE 4
+#define MAX_INPUT_SIZE (64 * 1024)
+
+// Fail loudly so libFuzzer/AFL record the input.
+#define FUZZ_CHECK(cond, sm) do { if (!(cond)) { report_violation(#cond, (sm)); } } while (0)
+
+// Features seen by the current input. Used by the corpus minimizer.
+// (previous state, new state) pairs plus one bit per variable limit reached.
+#define TRANSITION_FEATURES (TvRemoteSm_StateIdCount * TvRemoteSm_StateIdCount)
+#define LIMIT_FEATURES 7
+#define FEATURE_COUNT (TRANSITION_FEATURES + LIMIT_FEATURES)
+static bool features[FEATURE_COUNT];
+
+static void report_violation(const char* what, const TvRemoteSm* sm)
+{
+    fprintf(stderr, "Invariant violated: %s (state %s, volume %d, brightness %d, channel %d, channel entry %d).\n",
+        what, TvRemoteSm_state_id_to_string(sm->state_id), sm->vars.volume, sm->vars.brightness, sm->vars.channel,
+        sm->vars.channel_entry);
+    abort();
+}
+
+// Only leaf states can be active once the machine has started.
+static bool is_leaf_state(const TvRemoteSm_StateId id)
+{
+    switch (id)
+    {
+        case TvRemoteSm_StateId_TV_OFF:
+        case TvRemoteSm_StateId_BRIGHTNESS_CHANGE__INITIAL:
+        case TvRemoteSm_StateId_BRIGHTNESS_DOWN:
+        case TvRemoteSm_StateId_BRIGHTNESS_UP:
+        case TvRemoteSm_StateId_CHANNEL_DOWN:
+        case TvRemoteSm_StateId_CHANNEL_ENTRY:
+        case TvRemoteSm_StateId_CHANNEL_SELECT__INITIAL:
+        case TvRemoteSm_StateId_CHANNEL_UP:
+        case TvRemoteSm_StateId_VOLUME_CHANGE__INITIAL:
+        case TvRemoteSm_StateId_VOLUME_DOWN:
+        case TvRemoteSm_StateId_VOLUME_UP:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void check_invariants(const TvRemoteSm* sm)
+{
+    FUZZ_CHECK(sm->vars.volume <= 100, sm);
+    FUZZ_CHECK(sm->vars.brightness <= 100, sm);
+    FUZZ_CHECK(sm->vars.channel >= 1 && sm->vars.channel <= 256, sm);
+    // At most 3 digits, and nothing left over once the entry is done.
+    FUZZ_CHECK(sm->vars.channel_entry <= 259, sm);
+    FUZZ_CHECK(sm->vars.channel_entry == 0 || sm->state_id == TvRemoteSm_StateId_CHANNEL_ENTRY, sm);
+    FUZZ_CHECK(is_leaf_state(sm->state_id), sm);
+    FUZZ_CHECK(sm->current_state_exit_handler != NULL, sm);
+}
+
+static void record_features(const TvRemoteSm_StateId previous, const TvRemoteSm* sm)
+{
+    features[previous * TvRemoteSm_StateIdCount + sm->state_id] = true;
+    features[TRANSITION_FEATURES + 0] |= sm->vars.volume == 0;
+    features[TRANSITION_FEATURES + 1] |= sm->vars.volume == 100;
+    features[TRANSITION_FEATURES + 2] |= sm->vars.brightness == 0;
+    features[TRANSITION_FEATURES + 3] |= sm->vars.brightness == 100;
+    features[TRANSITION_FEATURES + 4] |= sm->vars.channel == 1;
+    features[TRANSITION_FEATURES + 5] |= sm->vars.channel == 256;
+    features[TRANSITION_FEATURES + 6] |= sm->vars.channel_entry * 10 > 256;
+}
+
+// Decode one record into an input event at time `now_ms`.
+static void decode_record(const uint8_t* record, long long* now_ms, struct input_event* event)
+{
+    const uint8_t selector = record[0];
+
+    *now_ms += (long long)(record[2] | (record[3] << 8));
+
+    memset(event, 0, sizeof(*event));
+    event->input_event_sec = *now_ms / SECONDS_TO_MS;
+    event->input_event_usec = (*now_ms % SECONDS_TO_MS) * MS_TO_MICROSEC;
+    event->type = (selector & 0x40) ? EV_MSC : EV_KEY;
+    event->code = (selector & 0x01) ? B2_CODE : B1_CODE;
+    if (selector & 0x80)
+    {
+        event->code = selector & 0x7f;
+    }
+    event->value = (int)(record[1] % 5) - 1;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    TvRemoteSm sm;
+    TvRemoteSm_ctor(&sm);
+    sm.vars.output = &tv_output_null_sink;
+    TvRemoteSm_start(&sm);
+    check_invariants(&sm);
+
+    GestureRecognizer gestures;
+    gesture_init(&gestures, &sm, DEFAULT_TAP_WINDOW, DEFAULT_CHORD_WINDOW);
+
+    long long now_ms = 0;
+    struct input_event event;
+    for (size_t i = 0; i + RECORD_SIZE <= size; i += RECORD_SIZE)
+    {
+        const TvRemoteSm_StateId previous = sm.state_id;
+        decode_record(&data[i], &now_ms, &event);
+        gesture_handle_input_event(&gestures, &event);
+        check_invariants(&sm);
+        record_features(previous, &sm);
+    }
+    const TvRemoteSm_StateId previous = sm.state_id;
+    gesture_flush(&gestures);
+    check_invariants(&sm);
+    record_features(previous, &sm);
+    return 0;
+}
+
+#ifndef TVREMOTE_LIBFUZZER
+
+#ifdef __AFL_FUZZ_TESTCASE_LEN
+__AFL_FUZZ_INIT();
+#endif
+
+static double seconds_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Read a whole file (at most MAX_INPUT_SIZE bytes). Returns the length or -1.
+static long read_input(FILE* file, uint8_t* buffer)
+{
+    const size_t n = fread(buffer, 1, MAX_INPUT_SIZE, file);
+    if (ferror(file))
+    {
+        return -1;
+    }
+    return (long)n;
+}
+
+static int run_file(const char* path, uint8_t* buffer)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Cannot open %s.\n", path);
+        return EXIT_FAILURE;
+    }
+    const long n = read_input(file, buffer);
+    fclose(file);
+    if (n < 0)
+    {
+        fprintf(stderr, "Cannot read %s.\n", path);
+        return EXIT_FAILURE;
+    }
+    LLVMFuzzerTestOneInput(buffer, (size_t)n);
+    return EXIT_SUCCESS;
+}
+
+// xorshift64* so the random mode is reproducible from the seed.
+static uint64_t next_random(uint64_t* state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+// Fast in-process mode: generate random inputs & run them without leaving the process.
+static int run_random(const unsigned long long iterations, uint64_t seed, uint8_t* buffer)
+{
+    const double start = seconds_now();
+    unsigned long long records = 0;
+
+    for (unsigned long long i = 0; i < iterations; i++)
+    {
+        // Mostly short inputs with the occasional long one, like a fuzzer's queue.
+        const size_t count = 1 + (next_random(&seed) % ((i % 256 == 0) ? 1024 : 16));
+        for (size_t r = 0; r < count; r++)
+        {
+            const uint64_t bits = next_random(&seed);
+            uint8_t* record = &buffer[r * RECORD_SIZE];
+            record[0] = (uint8_t)((bits & 0xff) < 0xf0 ? (bits & 0x01) : bits);
+            record[1] = (uint8_t)(bits >> 8);
+            // Bias the delays around the long-press timeout.
+            record[2] = (uint8_t)(bits >> 16);
+            record[3] = (uint8_t)((bits >> 24) & 0x03);
+        }
+        LLVMFuzzerTestOneInput(buffer, count * RECORD_SIZE);
+        records += count;
+    }
+
+    const double elapsed = seconds_now() - start;
+    printf("%llu execs (%llu events) in %.3f s: %.0f execs/s, %.0f events/s.\n",
+        iterations, records, elapsed, (double)iterations / elapsed, (double)records / elapsed);
+    return EXIT_SUCCESS;
+}
+
+// Copy the inputs of `in_dir` that add new features into `out_dir`.
+// The largest inputs are not preferred; inputs are taken in directory order, so run it twice
+// (or use libFuzzer's -merge=1 when built with clang) for a tighter corpus.
+static int minimize_corpus(const char* out_dir, const char* in_dir, uint8_t* buffer)
+{
+    bool seen[FEATURE_COUNT];
+    memset(seen, 0, sizeof(seen));
+
+    DIR* dir = opendir(in_dir);
+    if (dir == NULL)
+    {
+        fprintf(stderr, "Cannot open %s.\n", in_dir);
+        return EXIT_FAILURE;
+    }
+
+    unsigned int total = 0;
+    unsigned int kept = 0;
+    struct dirent* entry;
+    char path[4096];
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (entry->d_name[0] == '.')
+        {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s", in_dir, entry->d_name);
+        FILE* file = fopen(path, "rb");
+        if (file == NULL)
+        {
+            continue;
+        }
+        const long n = read_input(file, buffer);
+        fclose(file);
+        if (n < 0)
+        {
+            continue;
+        }
+        total++;
+
+        memset(features, 0, sizeof(features));
+        LLVMFuzzerTestOneInput(buffer, (size_t)n);
+
+        bool adds_feature = false;
+        for (int f = 0; f < FEATURE_COUNT; f++)
+        {
+            if (features[f] && !seen[f])
+            {
+                seen[f] = true;
+                adds_feature = true;
+            }
+        }
+        if (!adds_feature)
+        {
+            continue;
+        }
+
+        snprintf(path, sizeof(path), "%s/%s", out_dir, entry->d_name);
+        file = fopen(path, "wb");
+        if (file == NULL || fwrite(buffer, 1, (size_t)n, file) != (size_t)n)
+        {
+            fprintf(stderr, "Cannot write %s.\n", path);
+            closedir(dir);
+            return EXIT_FAILURE;
+        }
+        fclose(file);
+        kept++;
+    }
+    closedir(dir);
+
+    unsigned int covered = 0;
+    for (int f = 0; f < FEATURE_COUNT; f++)
+    {
+        covered += seen[f];
+    }
+    printf("Kept %u of %u inputs covering %u features.\n", kept, total, covered);
+    return EXIT_SUCCESS;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+        "Usage: %s                       run one input from stdin (AFL)\n"
+        "       %s FILE...               replay inputs\n"
+        "       %s -r COUNT [SEED]       run COUNT random inputs in process\n"
+        "       %s -m OUT_DIR IN_DIR     minimize a corpus\n",
+        name, name, name, name);
+}
+
+int main(int argc, char ** argv)
+{
+    static uint8_t buffer[MAX_INPUT_SIZE];
+
+    if (argc >= 3 && strcmp(argv[1], "-r") == 0)
+    {
+        const uint64_t seed = (argc >= 4) ? strtoull(argv[3], NULL, 0) : 0x5eed;
+        return run_random(strtoull(argv[2], NULL, 0), seed ? seed : 1, buffer);
+    }
+    if (argc == 4 && strcmp(argv[1], "-m") == 0)
+    {
+        return minimize_corpus(argv[2], argv[3], buffer);
+    }
+    if (argc >= 2 && argv[1][0] == '-')
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (argc >= 2)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            if (run_file(argv[i], buffer) != EXIT_SUCCESS)
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        return EXIT_SUCCESS;
+    }
+
+#ifdef __AFL_FUZZ_TESTCASE_LEN
+    // AFL++ persistent mode: the test case is shared memory, no stdin reads.
+    __AFL_INIT();
+    const uint8_t* afl_buffer = __AFL_FUZZ_TESTCASE_BUF;
+    while (__AFL_LOOP(100000))
+    {
+        LLVMFuzzerTestOneInput(afl_buffer, (size_t)__AFL_FUZZ_TESTCASE_LEN);
+    }
+    return EXIT_SUCCESS;
+#else
+    const long n = read_input(stdin, buffer);
+    if (n < 0)
+    {
+        return EXIT_FAILURE;
+    }
+    LLVMFuzzerTestOneInput(buffer, (size_t)n);
+    return EXIT_SUCCESS;
+#endif
+}
+
+#endif // TVREMOTE_LIBFUZZER
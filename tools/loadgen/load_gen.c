@@ -0,0 +1,619 @@
+// Synthetic multi-user traffic for capacity planning: key press traces of simulated viewers.
+//
+// Every user is a Markov chain over what they want to do (watch, surf channels, nudge the volume,
+// type a channel, change the brightness, turn the TV off & later on again). Each activity is played as
+// the key edges a person makes: press durations are drawn around LONG_PRESS_TIMEOUT (short presses
+// from a log-normal around 110 ms, long ones from a normal around 1050 ms, so a few of each end up on
+// the wrong side of 800 ms), held keys auto-repeat like the kernel does (250 ms, then every 33 ms)
+// and the gaps between presses sometimes fall inside the tap window. The user watches the screen:
+// the events go through the gesture recognizer into a TvRemoteSm of their own, and the next press
+// depends on the mode the TV is really in, so mistakes (a long press that came out short) are
+// noticed & corrected like a person would.
+//
+// With `-o DIR` every user's events are written to DIR/user-NNNNNNNN.ev as `struct input_event`
+// records on a virtual clock (replayable with `remote --device FILE`). Without it the events are only
+// dispatched, at most `-r` key events per second over all threads. Memory doesn't grow with the
+// number of events: a thread generates one user at a time.
+
+#include <errno.h> // for errno
+#include <math.h> // for log
+#include <pthread.h> // for pthread_create
+#include <stdatomic.h> // for atomic_fetch_add
+#include <stdint.h> // for uint64_t
+#include <stdio.h> // for printf
+#include <stdlib.h> // for strtoull
+#include <string.h> // for strcmp
+#include <time.h> // for clock_gettime
+#include <unistd.h> // for sysconf
+
+#include "input/gesture.h"
+#include "input/key_input.h"
+
+#define MAX_THREADS 256
+#define PATH_SIZE 4096
+#define WRITE_BUFFER_SIZE (1 << 20)
+
+// Kernel auto-repeat defaults.
+#define REPEAT_DELAY_US 250000LL
+#define REPEAT_PERIOD_US 33000LL
+
+// The virtual clock starts here (s), so the timestamps look like real ones.
+#define EPOCH_SECONDS 1700000000LL
+
+// Key events between two checks of the rate.
+#define PACE_EVERY 256
+
+typedef enum Activity {
+    WATCH,
+    SURF,
+    VOLUME,
+    TYPE_CHANNEL,
+    BRIGHTNESS,
+    POWER_OFF,
+    ACTIVITY_COUNT
+} Activity;
+
+static const char* const ACTIVITY_NAMES[ACTIVITY_COUNT] = {
+    "watch", "surf", "volume", "type channel", "brightness", "power off",
+};
+
+// Transition probabilities (%) from watching. Every other activity returns to watching, a powered off
+// TV is turned on again after a while.
+static const int FROM_WATCH[ACTIVITY_COUNT] = {
+    [WATCH] = 15, [SURF] = 35, [VOLUME] = 30, [TYPE_CHANNEL] = 5, [BRIGHTNESS] = 5, [POWER_OFF] = 10,
+};
+
+// Mean idle times (virtual us).
+#define WATCH_MEAN_US 30000000.0
+#define OFF_MEAN_US 900000000.0
+
+typedef enum Mode {
+    MODE_OFF,
+    MODE_VOLUME,
+    MODE_CHANNEL,
+    MODE_CHANNEL_ENTRY,
+    MODE_BRIGHTNESS,
+} Mode;
+
+typedef struct Totals {
+    uint64_t key_events;
+    uint64_t sm_events[TvRemoteSm_EventIdCount];
+    uint64_t activities[ACTIVITY_COUNT];
+    uint64_t virtual_us;
+    uint64_t users;
+} Totals;
+
+typedef struct User {
+    uint64_t random;
+    long long now_us;
+    TvRemoteSm sm;
+    GestureRecognizer gestures;
+    FILE* out;
+    uint64_t key_events;
+    Totals* totals;
+} User;
+
+typedef struct Options {
+    uint64_t users;
+    uint64_t events_per_user;
+    uint64_t seed;
+    double rate;
+    const char* directory;
+    int threads;
+} Options;
+
+// On cache lines of its own: the counters are written for every dispatch.
+typedef struct Worker {
+    _Alignas(64) pthread_t thread;
+    const Options* options;
+    Totals totals;
+    bool failed;
+    // stdio buffer of the trace file being written.
+    char* buffer;
+    // Pacing: key events since `start`.
+    struct timespec start;
+    uint64_t paced_events;
+} Worker;
+
+static atomic_ullong next_user;
+
+static double seconds_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Seed of each user, independent of the thread that generates it.
+static uint64_t splitmix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// xorshift64*.
+static uint64_t next_random(uint64_t* state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+// Uniform in (0, 1].
+static double uniform(User* user)
+{
+    return (double)((next_random(&user->random) >> 11) + 1) / 9007199254740992.0;
+}
+
+static int uniform_int(User* user, const int low, const int high)
+{
+    return low + (int)(next_random(&user->random) % (uint64_t)(high - low + 1));
+}
+
+static double normal(User* user)
+{
+    return sqrt(-2.0 * log(uniform(user))) * cos(6.283185307179586 * uniform(user));
+}
+
+static long long exponential_us(User* user, const double mean_us)
+{
+    return (long long)(-log(uniform(user)) * mean_us);
+}
+
+static long long clamp_us(const double us, const long long low, const long long high)
+{
+    return (us < (double)low) ? low : (us > (double)high) ? high : (long long)us;
+}
+
+static long long short_press_us(User* user)
+{
+    return clamp_us(110000.0 * exp(0.45 * normal(user)), 30000, 2000000);
+}
+
+static long long long_press_us(User* user)
+{
+    return clamp_us(1050000.0 + 220000.0 * normal(user), 200000, 3000000);
+}
+
+// Gap between two presses of a burst, `median_us` apart on average (log-normal).
+static long long gap_us(User* user, const double median_us)
+{
+    return clamp_us(median_us * exp(0.35 * normal(user)), 60000, 5000000);
+}
+
+static Mode mode(const User* user)
+{
+    switch (user->sm.state_id)
+    {
+        case TvRemoteSm_StateId_TV_OFF:
+            return MODE_OFF;
+        case TvRemoteSm_StateId_CHANNEL_SELECT__INITIAL:
+        case TvRemoteSm_StateId_CHANNEL_UP:
+        case TvRemoteSm_StateId_CHANNEL_DOWN:
+            return MODE_CHANNEL;
+        case TvRemoteSm_StateId_CHANNEL_ENTRY:
+            return MODE_CHANNEL_ENTRY;
+        case TvRemoteSm_StateId_BRIGHTNESS_CHANGE__INITIAL:
+        case TvRemoteSm_StateId_BRIGHTNESS_UP:
+        case TvRemoteSm_StateId_BRIGHTNESS_DOWN:
+            return MODE_BRIGHTNESS;
+        default:
+            return MODE_VOLUME;
+    }
+}
+
+static void count_dispatch(void* ctx, const int event_id, const struct input_event* source)
+{
+    (void)source;
+    ((User*)ctx)->totals->sm_events[event_id]++;
+}
+
+static bool write_event(User* user, const long long at_us, const unsigned short type, const unsigned short code, const int value)
+{
+    const long long us = EPOCH_SECONDS * 1000000LL + at_us;
+    struct input_event event = { .type = type, .code = code, .value = value };
+    event.input_event_sec = us / 1000000;
+    event.input_event_usec = us % 1000000;
+    if (type == EV_KEY)
+    {
+        gesture_handle_input_event(&user->gestures, &event);
+        user->key_events++;
+    }
+    return user->out == NULL || fwrite(&event, sizeof(event), 1, user->out) == 1;
+}
+
+// One key edge as the kernel reports it: the key event & the SYN_REPORT that ends it.
+static bool key_edge(User* user, const long long at_us, const int code, const int value)
+{
+    return write_event(user, at_us, EV_KEY, (unsigned short)code, value) && write_event(user, at_us, EV_SYN, SYN_REPORT, 0);
+}
+
+// Let `us` pass, dispatching the presses whose window runs out meanwhile.
+static void wait_us(User* user, const long long us)
+{
+    user->now_us += us;
+    gesture_expire(&user->gestures, user->now_us);
+}
+
+// Press `code` for `hold_us`, with the auto-repeats of a held key.
+static bool press(User* user, const int code, const long long hold_us)
+{
+    const long long start = user->now_us;
+    bool ok = key_edge(user, start, code, PRESSED_EVENT);
+    for (long long at = start + REPEAT_DELAY_US; ok && at < start + hold_us; at += REPEAT_PERIOD_US)
+    {
+        ok = key_edge(user, at, code, REPEATED_EVENT);
+    }
+    user->now_us = start + hold_us;
+    return ok && key_edge(user, user->now_us, code, RELEASED_EVENT);
+}
+
+static bool tap(User* user, const int code)
+{
+    return press(user, code, short_press_us(user));
+}
+
+// `count` quick taps (a double or triple press).
+static bool multi_tap(User* user, const int code, const int count)
+{
+    bool ok = true;
+    for (int i = 0; i < count && ok; i++)
+    {
+        if (i > 0)
+        {
+            wait_us(user, gap_us(user, 90000));
+        }
+        ok = tap(user, code);
+    }
+    return ok;
+}
+
+// B1 & B2 pressed together, the second one a few ms after the first.
+static bool chord(User* user)
+{
+    const long long start = user->now_us;
+    const long long second = start + uniform_int(user, 0, 40) * 1000LL;
+    const long long hold = short_press_us(user) + 40000;
+    const bool ok = key_edge(user, start, B1_CODE, PRESSED_EVENT) && key_edge(user, second, B2_CODE, PRESSED_EVENT)
+        && key_edge(user, start + hold, B1_CODE, RELEASED_EVENT) && key_edge(user, second + hold, B2_CODE, RELEASED_EVENT);
+    user->now_us = second + hold;
+    return ok;
+}
+
+// Get the TV into `target` (not MODE_OFF), looking at the screen after every try.
+static bool enter_mode(User* user, const Mode target)
+{
+    bool ok = true;
+    for (int attempt = 0; attempt < 4 && ok && mode(user) != target; attempt++)
+    {
+        switch (mode(user))
+        {
+            case MODE_OFF:
+                ok = press(user, B1_CODE, long_press_us(user));
+                break;
+            case MODE_CHANNEL_ENTRY:
+                // Tune what was typed, back to channel select.
+                ok = multi_tap(user, B2_CODE, 2);
+                break;
+            default:
+                // Some people cycle through the modes with B2 long-presses instead of the gestures.
+                if (uniform_int(user, 1, 4) == 1)
+                {
+                    ok = press(user, B2_CODE, long_press_us(user));
+                    break;
+                }
+                ok = (target == MODE_VOLUME) ? chord(user)
+                    : (target == MODE_CHANNEL) ? multi_tap(user, B2_CODE, 2)
+                    : (target == MODE_BRIGHTNESS) ? multi_tap(user, B2_CODE, 3)
+                    : multi_tap(user, B2_CODE, 2);
+                break;
+        }
+        // Read the screen once the gesture windows ran out.
+        wait_us(user, gap_us(user, 600000));
+    }
+    return ok;
+}
+
+// `count` presses of mostly one button, `median_gap_us` apart.
+static bool burst(User* user, const int count, const int main_code, const int main_percent, const double median_gap_us)
+{
+    bool ok = true;
+    const int other_code = (main_code == B1_CODE) ? B2_CODE : B1_CODE;
+    for (int i = 0; i < count && ok; i++)
+    {
+        ok = tap(user, uniform_int(user, 1, 100) <= main_percent ? main_code : other_code);
+        wait_us(user, gap_us(user, median_gap_us));
+    }
+    return ok;
+}
+
+static bool play(User* user, const Activity activity)
+{
+    bool ok = true;
+    switch (activity)
+    {
+        case WATCH:
+            wait_us(user, exponential_us(user, WATCH_MEAN_US));
+            break;
+        case SURF:
+            ok = enter_mode(user, MODE_CHANNEL) && burst(user, uniform_int(user, 3, 15), B1_CODE, 85, 450000);
+            if (ok && uniform_int(user, 1, 10) == 1)
+            {
+                // Jump to a favorite.
+                ok = multi_tap(user, B1_CODE, 2);
+                wait_us(user, gap_us(user, 800000));
+            }
+            break;
+        case VOLUME:
+            ok = enter_mode(user, MODE_VOLUME)
+                && burst(user, uniform_int(user, 1, 6), uniform_int(user, 0, 1) ? B1_CODE : B2_CODE, 90, 350000);
+            break;
+        case TYPE_CHANNEL:
+            ok = enter_mode(user, MODE_CHANNEL) && multi_tap(user, B2_CODE, 2);
+            wait_us(user, gap_us(user, 600000));
+            for (int digits = uniform_int(user, 1, 3); ok && digits > 0 && mode(user) == MODE_CHANNEL_ENTRY; digits--)
+            {
+                ok = burst(user, uniform_int(user, 0, 9), B1_CODE, 100, 380000) && tap(user, B2_CODE);
+                wait_us(user, gap_us(user, 500000));
+            }
+            if (ok && mode(user) == MODE_CHANNEL_ENTRY)
+            {
+                ok = multi_tap(user, B2_CODE, 2);
+                wait_us(user, gap_us(user, 600000));
+            }
+            break;
+        case BRIGHTNESS:
+            ok = enter_mode(user, MODE_BRIGHTNESS) && burst(user, uniform_int(user, 1, 8), B1_CODE, 60, 400000);
+            break;
+        case POWER_OFF:
+            ok = press(user, B1_CODE, long_press_us(user));
+            wait_us(user, gap_us(user, 600000));
+            if (ok && mode(user) == MODE_OFF)
+            {
+                wait_us(user, exponential_us(user, OFF_MEAN_US));
+            }
+            break;
+        default:
+            break;
+    }
+    return ok;
+}
+
+static Activity next_activity(User* user, const Activity current)
+{
+    if (current != WATCH)
+    {
+        return WATCH;
+    }
+    int roll = uniform_int(user, 1, 100);
+    for (int activity = 0; activity < ACTIVITY_COUNT; activity++)
+    {
+        roll -= FROM_WATCH[activity];
+        if (roll <= 0)
+        {
+            return (Activity)activity;
+        }
+    }
+    return WATCH;
+}
+
+// Sleep until `worker` is back under its share of the rate.
+static void pace(Worker* worker, const uint64_t key_events)
+{
+    const double rate = worker->options->rate / worker->options->threads;
+    worker->paced_events += key_events;
+    const double due = (double)worker->paced_events / rate;
+    struct timespec deadline = worker->start;
+    deadline.tv_sec += (time_t)due;
+    deadline.tv_nsec += (long)((due - (double)(time_t)due) * 1e9);
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR)
+    {
+    }
+}
+
+static bool run_user(Worker* worker, const uint64_t index)
+{
+    const Options* options = worker->options;
+    User user;
+    memset(&user, 0, sizeof(user));
+    user.random = splitmix64(options->seed ^ splitmix64(index));
+    user.random = (user.random != 0) ? user.random : 1;
+    user.totals = &worker->totals;
+    TvRemoteSm_ctor(&user.sm);
+    user.sm.vars.output = &tv_output_null_sink;
+    TvRemoteSm_start(&user.sm);
+    gesture_init(&user.gestures, &user.sm, DEFAULT_TAP_WINDOW, DEFAULT_CHORD_WINDOW);
+    gesture_set_callback(&user.gestures, count_dispatch, &user);
+
+    char path[PATH_SIZE];
+    if (options->directory != NULL)
+    {
+        snprintf(path, sizeof(path), "%s/user-%08llu.ev", options->directory, (unsigned long long)index);
+        user.out = fopen(path, "wb");
+        if (user.out == NULL)
+        {
+            fprintf(stderr, "Cannot create %s: %s.\n", path, strerror(errno));
+            return false;
+        }
+        setvbuf(user.out, worker->buffer, _IOFBF, WRITE_BUFFER_SIZE);
+    }
+
+    // Most users start watching a TV that is off.
+    Activity activity = POWER_OFF;
+    user.now_us = exponential_us(&user, OFF_MEAN_US / 10);
+    bool ok = press(&user, B1_CODE, long_press_us(&user));
+    uint64_t paced = 0;
+    while (ok && user.key_events < options->events_per_user)
+    {
+        activity = next_activity(&user, activity);
+        worker->totals.activities[activity]++;
+        ok = play(&user, activity);
+        if (options->rate > 0 && user.key_events - paced >= PACE_EVERY)
+        {
+            pace(worker, user.key_events - paced);
+            paced = user.key_events;
+        }
+    }
+    gesture_flush(&user.gestures);
+    if (options->rate > 0)
+    {
+        pace(worker, user.key_events - paced);
+    }
+
+    if (user.out != NULL && (fclose(user.out) != 0 || !ok))
+    {
+        fprintf(stderr, "Cannot write %s: %s.\n", path, strerror(errno));
+        return false;
+    }
+    worker->totals.key_events += user.key_events;
+    worker->totals.virtual_us += (uint64_t)user.now_us;
+    worker->totals.users++;
+    return true;
+}
+
+static void* run_worker(void* arg)
+{
+    Worker* worker = arg;
+    clock_gettime(CLOCK_MONOTONIC, &worker->start);
+    if (worker->options->directory != NULL && (worker->buffer = malloc(WRITE_BUFFER_SIZE)) == NULL)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        worker->failed = true;
+        return NULL;
+    }
+    uint64_t index;
+    while (!worker->failed && (index = atomic_fetch_add(&next_user, 1)) < worker->options->users)
+    {
+        worker->failed = !run_user(worker, index);
+    }
+    free(worker->buffer);
+    return NULL;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-u USERS] [-n KEY_EVENTS_PER_USER] [-j THREADS] [-s SEED] [-o DIR | -r KEY_EVENTS_PER_SEC]\n", name);
+}
+
+int main(int argc, char ** argv)
+{
+    Options options = {
+        .users = 1000,
+        .events_per_user = 10000,
+        .seed = 0x5eed,
+        .rate = 0,
+        .directory = NULL,
+        .threads = (int)sysconf(_SC_NPROCESSORS_ONLN),
+    };
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-u") == 0 && i + 1 < argc)
+        {
+            options.users = strtoull(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            options.events_per_user = strtoull(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            options.threads = (int)strtol(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            options.seed = strtoull(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            options.directory = argv[++i];
+        }
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+        {
+            options.rate = strtod(argv[++i], NULL);
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (options.threads < 1)
+    {
+        options.threads = 1;
+    }
+    if (options.threads > MAX_THREADS)
+    {
+        options.threads = MAX_THREADS;
+    }
+    if (options.directory != NULL && options.rate > 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    static Worker workers[MAX_THREADS];
+    const double start = seconds_now();
+    int started = 0;
+    for (; started < options.threads; started++)
+    {
+        workers[started].options = &options;
+        if (pthread_create(&workers[started].thread, NULL, run_worker, &workers[started]) != 0)
+        {
+            fprintf(stderr, "Cannot start thread %d.\n", started);
+            break;
+        }
+    }
+    Totals totals = { 0 };
+    bool failed = started == 0;
+    for (int t = 0; t < started; t++)
+    {
+        pthread_join(workers[t].thread, NULL);
+        failed = failed || workers[t].failed;
+        totals.key_events += workers[t].totals.key_events;
+        totals.virtual_us += workers[t].totals.virtual_us;
+        totals.users += workers[t].totals.users;
+        for (int e = 0; e < TvRemoteSm_EventIdCount; e++)
+        {
+            totals.sm_events[e] += workers[t].totals.sm_events[e];
+        }
+        for (int a = 0; a < ACTIVITY_COUNT; a++)
+        {
+            totals.activities[a] += workers[t].totals.activities[a];
+        }
+    }
+    const double seconds = seconds_now() - start;
+
+    uint64_t sm_events = 0;
+    for (int e = 0; e < TvRemoteSm_EventIdCount; e++)
+    {
+        sm_events += totals.sm_events[e];
+    }
+    printf("%llu users, %llu key events, %llu state machine events, %.1f virtual hours in %.2f s with %d threads\n",
+        (unsigned long long)totals.users, (unsigned long long)totals.key_events, (unsigned long long)sm_events,
+        (double)totals.virtual_us / 3.6e9, seconds, started);
+    printf("%.1f M key events/s, %.1f M state machine events/s\n", (double)totals.key_events / seconds / 1e6,
+        (double)sm_events / seconds / 1e6);
+    for (int e = 0; e < TvRemoteSm_EventIdCount; e++)
+    {
+        printf("  %-16s %6.2f %%\n", TvRemoteSm_event_id_to_string((TvRemoteSm_EventId)e),
+            sm_events ? 100.0 * (double)totals.sm_events[e] / (double)sm_events : 0.0);
+    }
+    uint64_t activities = 0;
+    for (int a = 0; a < ACTIVITY_COUNT; a++)
+    {
+        activities += totals.activities[a];
+    }
+    for (int a = 0; a < ACTIVITY_COUNT; a++)
+    {
+        printf("  %-16s %6.2f %%\n", ACTIVITY_NAMES[a], activities ? 100.0 * (double)totals.activities[a] / (double)activities : 0.0);
+    }
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
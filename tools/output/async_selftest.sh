@@ -0,0 +1,90 @@
+#!/bin/sh
+# Checks `remote --async-output` against a slow stdout: replays a burst of volume up presses with
+# `--throttle-us` so the queue overflows, once per policy, and checks the counters & that the last
+# line written is the final volume. Needs no keyboard: the key events are piped in.
+#
+# Usage: async_selftest.sh BUILD_DIR [PRESSES] [THROTTLE_US]
+
+set -e
+
+build_dir=${1:?Usage: $0 BUILD_DIR [PRESSES] [THROTTLE_US]}
+presses=${2:-30}
+throttle_us=${3:-20000}
+queue=8
+
+work_dir=$(mktemp -d)
+trap 'rm -rf "$work_dir"' EXIT
+
+# Little endian integer $1 of $2 bytes.
+le() {
+    n=$1
+    b=0
+    while [ "$b" -lt "$2" ]; do
+        printf '%b' "\\0$(printf '%o' $((n & 255)))"
+        n=$((n >> 8))
+        b=$((b + 1))
+    done
+}
+
+# struct input_event of key $3 with value $4 at $1 s $2 us.
+key() {
+    le "$1" 8
+    le "$2" 8
+    le 1 2
+    le "$3" 2
+    le "$4" 4
+}
+
+# B1 (w, 17) long-press turns the TV on in volume change at 50, then every B1 press turns it up.
+{
+    key 1 0 17 1
+    key 1 900000 17 2
+    key 1 950000 17 0
+    i=0
+    while [ "$i" -lt "$presses" ]; do
+        key 2 $((i * 20000)) 17 1
+        key 2 $((i * 20000 + 10000)) 17 0
+        i=$((i + 1))
+    done
+} > "$work_dir/burst.ev"
+if [ "$presses" -lt "$queue" ] || [ "$presses" -gt 50 ]; then
+    echo "PRESSES must be in [$queue, 50] to overflow the queue before the volume stops at 100." >&2
+    exit 1
+fi
+volume=$((50 + presses))
+# "TV OFF", "TV ON" & "Volume Change", then "Volume Up" & the volume per press.
+messages=$((3 + 2 * presses))
+
+# The counter $1 of the report in $2.
+counter() {
+    sed -n "s/^Async output:.* \([0-9]*\) $1.*/\1/p" "$2"
+}
+
+failed=0
+for policy in drop-oldest coalesce; do
+    "$build_dir/remote" --device /dev/stdin --tap-ms 0 --chord-ms 0 --async-output --async-queue "$queue" \
+        --async-policy "$policy" --throttle-us "$throttle_us" < "$work_dir/burst.ev" \
+        > "$work_dir/out" 2> "$work_dir/err" || true
+    queued=$(counter queued "$work_dir/err")
+    written=$(counter written "$work_dir/err")
+    dropped=$(counter dropped "$work_dir/err")
+    coalesced=$(counter coalesced "$work_dir/err")
+    last=$(tail -n 1 "$work_dir/out")
+    echo "$policy: $queued queued, $written written, $dropped dropped, $coalesced coalesced, last line \"$last\""
+
+    # Every message is written, dropped or coalesced, and the newest value always survives.
+    if [ -z "$queued" ] || [ "$queued" -ne "$messages" ] \
+        || [ $((written + dropped + coalesced)) -ne "$queued" ] || [ "$last" != "$volume" ]; then
+        echo "$policy: expected $messages messages, all accounted for, ending with $volume." >&2
+        failed=1
+    fi
+    if [ "$policy" = drop-oldest ] && { [ "$dropped" -eq 0 ] || [ "$coalesced" -ne 0 ]; }; then
+        echo "$policy: expected dropped messages & none coalesced." >&2
+        failed=1
+    fi
+    if [ "$policy" = coalesce ] && [ "$coalesced" -eq 0 ]; then
+        echo "$policy: expected coalesced values." >&2
+        failed=1
+    fi
+done
+exit "$failed"
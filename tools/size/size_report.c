@@ -0,0 +1,452 @@
+// Code size of the generated state machine, per function, & the size and startup time of programs.
+//
+// Reads a relocatable ELF object (TvRemoteSm.c compiled with -ffunction-sections -fdata-sections) and
+// lists the .text of every function and the .rodata it references: the objects it points to & the
+// strings of the merged string sections (each string counted once per function, and once in the
+// total). With `--max BYTES` the exit status is non-zero when .text + .rodata of the object exceed
+// BYTES, which the build uses to catch code size regressions.
+//
+// Executables (e.g. `remote` & `remote_embedded`) only get the section totals & their file size.
+// With `--startup PROGRAM [ARGS...]` (the last option) the program is run a few times with stdin on
+// /dev/null & the median time from fork() to its first output byte is printed.
+
+#include <elf.h> // for Elf64_Ehdr
+#include <errno.h> // for errno
+#include <fcntl.h> // for open
+#include <stdbool.h> // for bool
+#include <stdint.h> // for uint64_t
+#include <stdio.h> // for printf
+#include <stdlib.h> // for qsort
+#include <string.h> // for strcmp
+#include <sys/mman.h> // for mmap
+#include <sys/stat.h> // for fstat
+#include <signal.h> // for kill
+#include <sys/wait.h> // for waitpid
+#include <time.h> // for clock_gettime
+#include <unistd.h> // for fork
+
+#define MAX_FUNCTIONS 1024
+#define MAX_STRINGS 4096
+#define MAX_FUNCTION_REFS 64
+#define STARTUP_RUNS 21
+
+typedef struct Function {
+    const char* name;
+    uint16_t section;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t rodata;
+    // The strings & objects referenced so far, to count each once (index into `refs`).
+    int ref_count;
+    int refs[MAX_FUNCTION_REFS];
+} Function;
+
+typedef struct Object {
+    const unsigned char* data;
+    size_t size;
+    const Elf64_Ehdr* header;
+    const Elf64_Shdr* sections;
+    const char* section_names;
+    const Elf64_Sym* symbols;
+    size_t symbol_count;
+    const char* symbol_names;
+} Object;
+
+// A referenced string or object: section & offset.
+typedef struct Ref {
+    uint16_t section;
+    uint64_t offset;
+    uint64_t size;
+} Ref;
+
+static Function functions[MAX_FUNCTIONS];
+static int function_count = 0;
+static Ref refs[MAX_STRINGS];
+static int ref_count = 0;
+
+static const char* section_name(const Object* object, const int index)
+{
+    return object->section_names + object->sections[index].sh_name;
+}
+
+static bool is_rodata(const Object* object, const int index)
+{
+    return index > 0 && index < object->header->e_shnum && strncmp(section_name(object, index), ".rodata", 7) == 0;
+}
+
+static bool load(Object* object, const char* path)
+{
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat info;
+    if (fd == -1 || fstat(fd, &info) == -1)
+    {
+        fprintf(stderr, "Cannot open %s: %s.\n", path, strerror(errno));
+        return false;
+    }
+    object->size = (size_t)info.st_size;
+    object->data = mmap(NULL, object->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (object->data == MAP_FAILED)
+    {
+        fprintf(stderr, "Cannot map %s: %s.\n", path, strerror(errno));
+        return false;
+    }
+    object->header = (const Elf64_Ehdr*)object->data;
+    if (object->size < sizeof(Elf64_Ehdr) || memcmp(object->header->e_ident, ELFMAG, SELFMAG) != 0
+        || object->header->e_ident[EI_CLASS] != ELFCLASS64
+        || (object->header->e_type != ET_REL && object->header->e_type != ET_EXEC && object->header->e_type != ET_DYN)
+        || object->header->e_shoff + (uint64_t)object->header->e_shnum * sizeof(Elf64_Shdr) > object->size)
+    {
+        fprintf(stderr, "%s is not a 64-bit ELF object or executable.\n", path);
+        return false;
+    }
+    object->sections = (const Elf64_Shdr*)(object->data + object->header->e_shoff);
+    object->section_names = (const char*)(object->data + object->sections[object->header->e_shstrndx].sh_offset);
+    for (int i = 0; i < object->header->e_shnum; i++)
+    {
+        if (object->sections[i].sh_type == SHT_SYMTAB)
+        {
+            object->symbols = (const Elf64_Sym*)(object->data + object->sections[i].sh_offset);
+            object->symbol_count = object->sections[i].sh_size / sizeof(Elf64_Sym);
+            object->symbol_names = (const char*)(object->data + object->sections[object->sections[i].sh_link].sh_offset);
+        }
+    }
+    // Executables may be stripped.
+    if (object->symbols == NULL && object->header->e_type == ET_REL)
+    {
+        fprintf(stderr, "%s has no symbol table.\n", path);
+        return false;
+    }
+    return true;
+}
+
+static Function* function_at(const uint16_t section, const uint64_t offset)
+{
+    for (int i = 0; i < function_count; i++)
+    {
+        Function* function = &functions[i];
+        if (function->section == section && offset >= function->offset && offset < function->offset + function->size)
+        {
+            return function;
+        }
+    }
+    return NULL;
+}
+
+// The string or object at `offset` of rodata `section`, added to `refs` if new. Returns its index or -1.
+static int find_ref(const Object* object, const uint16_t section, uint64_t offset)
+{
+    const Elf64_Shdr* shdr = &object->sections[section];
+    if (offset >= shdr->sh_size)
+    {
+        return -1;
+    }
+    uint64_t size = 0;
+    if (shdr->sh_flags & SHF_STRINGS)
+    {
+        // Merged strings: from the start of the string `offset` points into to its NUL.
+        const char* strings = (const char*)(object->data + shdr->sh_offset);
+        while (offset > 0 && strings[offset - 1] != '\0')
+        {
+            offset--;
+        }
+        size = strnlen(&strings[offset], shdr->sh_size - offset) + 1;
+    }
+    else
+    {
+        // An object: the symbol that covers `offset`, or the whole section.
+        size = shdr->sh_size;
+        for (size_t i = 0; i < object->symbol_count; i++)
+        {
+            const Elf64_Sym* symbol = &object->symbols[i];
+            if (symbol->st_shndx == section && ELF64_ST_TYPE(symbol->st_info) == STT_OBJECT
+                && offset >= symbol->st_value && offset < symbol->st_value + symbol->st_size)
+            {
+                offset = symbol->st_value;
+                size = symbol->st_size;
+                break;
+            }
+        }
+        if (size == shdr->sh_size)
+        {
+            offset = 0;
+        }
+    }
+    for (int i = 0; i < ref_count; i++)
+    {
+        if (refs[i].section == section && refs[i].offset == offset)
+        {
+            return i;
+        }
+    }
+    if (ref_count == MAX_STRINGS)
+    {
+        return -1;
+    }
+    refs[ref_count] = (Ref){ .section = section, .offset = offset, .size = size };
+    return ref_count++;
+}
+
+// Where a relocation points to, relative to its symbol. PC-relative x86-64 relocations carry the
+// distance to the end of the instruction in the addend, which is added back.
+static int64_t target_addend(const Object* object, const Elf64_Rela* rela)
+{
+    const uint32_t type = (uint32_t)ELF64_R_TYPE(rela->r_info);
+    if (object->header->e_machine == EM_X86_64 && (type == R_X86_64_PC32 || type == R_X86_64_PLT32))
+    {
+        return rela->r_addend + 4;
+    }
+    return rela->r_addend;
+}
+
+static void collect(const Object* object)
+{
+    for (size_t i = 0; i < object->symbol_count && function_count < MAX_FUNCTIONS; i++)
+    {
+        const Elf64_Sym* symbol = &object->symbols[i];
+        if (ELF64_ST_TYPE(symbol->st_info) == STT_FUNC && symbol->st_shndx != SHN_UNDEF && symbol->st_size > 0)
+        {
+            functions[function_count++] = (Function){
+                .name = object->symbol_names + symbol->st_name,
+                .section = symbol->st_shndx,
+                .offset = symbol->st_value,
+                .size = symbol->st_size
+            };
+        }
+    }
+
+    for (int s = 0; s < object->header->e_shnum; s++)
+    {
+        const Elf64_Shdr* shdr = &object->sections[s];
+        if (shdr->sh_type != SHT_RELA || !(object->sections[shdr->sh_info].sh_flags & SHF_EXECINSTR))
+        {
+            continue;
+        }
+        const Elf64_Rela* relas = (const Elf64_Rela*)(object->data + shdr->sh_offset);
+        for (size_t r = 0; r < shdr->sh_size / sizeof(Elf64_Rela); r++)
+        {
+            const Elf64_Sym* symbol = &object->symbols[ELF64_R_SYM(relas[r].r_info)];
+            if (!is_rodata(object, symbol->st_shndx))
+            {
+                continue;
+            }
+            Function* function = function_at((uint16_t)shdr->sh_info, relas[r].r_offset);
+            const int64_t offset = (int64_t)symbol->st_value + target_addend(object, &relas[r]);
+            const int ref = (offset >= 0) ? find_ref(object, symbol->st_shndx, (uint64_t)offset) : -1;
+            if (function == NULL || ref < 0)
+            {
+                continue;
+            }
+            bool seen = false;
+            for (int i = 0; i < function->ref_count && !seen; i++)
+            {
+                seen = function->refs[i] == ref;
+            }
+            if (!seen && function->ref_count < MAX_FUNCTION_REFS)
+            {
+                function->refs[function->ref_count++] = ref;
+                function->rodata += refs[ref].size;
+            }
+        }
+    }
+}
+
+static int by_size(const void* a, const void* b)
+{
+    const Function* fa = a;
+    const Function* fb = b;
+    const uint64_t sa = fa->size + fa->rodata;
+    const uint64_t sb = fb->size + fb->rodata;
+    return (sa < sb) - (sa > sb);
+}
+
+static double seconds_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+    const double da = *(const double*)a;
+    const double db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+// Median time from fork() to the first output byte of `argv[0]` in us, or -1.
+static double startup_us(char ** argv)
+{
+    double samples[STARTUP_RUNS];
+    for (int run = 0; run < STARTUP_RUNS; run++)
+    {
+        int pipe_fds[2];
+        if (pipe(pipe_fds) == -1)
+        {
+            return -1;
+        }
+        const double start = seconds_now();
+        const pid_t pid = fork();
+        if (pid == 0)
+        {
+            // No terminal & no input: programs that read stdin or a device see the end of it.
+            const int null_fd = open("/dev/null", O_RDWR);
+            dup2(null_fd, STDIN_FILENO);
+            dup2(null_fd, STDERR_FILENO);
+            dup2(pipe_fds[1], STDOUT_FILENO);
+            close(pipe_fds[0]);
+            execv(argv[0], argv);
+            _exit(127);
+        }
+        close(pipe_fds[1]);
+        char output;
+        const ssize_t n = read(pipe_fds[0], &output, 1);
+        const double end = seconds_now();
+        close(pipe_fds[0]);
+        if (pid > 0)
+        {
+            kill(pid, SIGKILL);
+            waitpid(pid, NULL, 0);
+        }
+        if (pid == -1 || n != 1)
+        {
+            fprintf(stderr, "Cannot run %s (no output).\n", argv[0]);
+            return -1;
+        }
+        samples[run] = (end - start) * 1e6;
+    }
+    qsort(samples, STARTUP_RUNS, sizeof(samples[0]), compare_double);
+    return samples[STARTUP_RUNS / 2];
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s ELF_FILE [--max BYTES] [-q] [--startup PROGRAM [ARGS...]]\n", name);
+}
+
+int main(int argc, char ** argv)
+{
+    const char* path = NULL;
+    char ** startup = NULL;
+    unsigned long long max = 0;
+    bool quiet = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--max") == 0 && i + 1 < argc)
+        {
+            max = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--startup") == 0 && i + 1 < argc)
+        {
+            startup = &argv[i + 1];
+            break;
+        }
+        else if (strcmp(argv[i], "-q") == 0)
+        {
+            quiet = true;
+        }
+        else if (argv[i][0] != '-' && path == NULL)
+        {
+            path = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (path == NULL)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Object object = { 0 };
+    if (!load(&object, path))
+    {
+        return EXIT_FAILURE;
+    }
+    const bool relocatable = object.header->e_type == ET_REL;
+    if (relocatable)
+    {
+        collect(&object);
+    }
+
+    uint64_t text = 0;
+    uint64_t rodata = 0;
+    uint64_t data = 0;
+    uint64_t unwind = 0;
+    uint64_t other = 0;
+    for (int i = 0; i < object.header->e_shnum; i++)
+    {
+        const Elf64_Shdr* shdr = &object.sections[i];
+        if (!(shdr->sh_flags & SHF_ALLOC))
+        {
+            continue;
+        }
+        if (shdr->sh_flags & SHF_EXECINSTR)
+        {
+            text += shdr->sh_size;
+        }
+        else if (is_rodata(&object, i))
+        {
+            rodata += shdr->sh_size;
+        }
+        else if (shdr->sh_flags & SHF_WRITE)
+        {
+            data += shdr->sh_size;
+        }
+        else if (strncmp(section_name(&object, i), ".eh_frame", 9) == 0 || strcmp(section_name(&object, i), ".gcc_except_table") == 0)
+        {
+            // Not counted in the limit (-fno-asynchronous-unwind-tables drops them).
+            unwind += shdr->sh_size;
+        }
+        else
+        {
+            // Notes, dynamic symbols & relocations of executables.
+            other += shdr->sh_size;
+        }
+    }
+
+    if (relocatable && !quiet)
+    {
+        qsort(functions, (size_t)function_count, sizeof(functions[0]), by_size);
+        printf("%-48s %7s %7s\n", "function", ".text", ".rodata");
+        for (int i = 0; i < function_count; i++)
+        {
+            printf("%-48s %7llu %7llu\n", functions[i].name, (unsigned long long)functions[i].size, (unsigned long long)functions[i].rodata);
+        }
+    }
+    if (relocatable)
+    {
+        printf("%s: %d functions, .text %llu, .rodata %llu, .data/.bss %llu, unwind tables %llu bytes.\n", path, function_count,
+            (unsigned long long)text, (unsigned long long)rodata, (unsigned long long)data, (unsigned long long)unwind);
+    }
+    else
+    {
+        printf("%s: file %zu, .text %llu, .rodata %llu, .data/.bss %llu, unwind tables %llu, other %llu bytes.\n", path,
+            object.size, (unsigned long long)text, (unsigned long long)rodata, (unsigned long long)data,
+            (unsigned long long)unwind, (unsigned long long)other);
+    }
+
+    int status = EXIT_SUCCESS;
+    if (startup != NULL)
+    {
+        const double us = startup_us(startup);
+        if (us < 0)
+        {
+            status = EXIT_FAILURE;
+        }
+        else
+        {
+            printf("%s: fork() to first output %.1f us (median of %d runs).\n", startup[0], us, STARTUP_RUNS);
+        }
+    }
+    if (max > 0 && text + rodata > max)
+    {
+        fprintf(stderr, "Code size regression: .text + .rodata is %llu bytes, the limit is %llu (TVREMOTE_SM_SIZE_LIMIT).\n",
+            (unsigned long long)(text + rodata), max);
+        status = EXIT_FAILURE;
+    }
+    return status;
+}
@@ -0,0 +1,211 @@
+// Converts recorded key sessions between `struct input_event` dumps and the columnar trace format
+// (see input/key_trace.h), and queries the time spent in each state straight from the mapped file.
+//
+//   encode IN.ev OUT.ktr  keep the key events of IN, each with the state the machine is in once the
+//                         recognizer has handled it (on the clock of the events, output discarded)
+//   decode IN.ktr OUT.ev  write the key events back, each followed by a SYN_REPORT, which replays
+//                         (remote --device) & encodes again to the same trace
+//   states IN.ktr         time spent in each state, from every key event to the next
+
+#include <errno.h> // for errno
+#include <linux/input.h> // for input_event
+#include <stdio.h> // for fopen
+#include <stdlib.h> // for EXIT_FAILURE
+#include <string.h> // for strcmp
+#include <time.h> // for clock_gettime
+
+#include "input/gesture.h"
+#include "input/key_trace.h"
+
+// input_event records read or written at a time.
+#define BUFFER_EVENTS 4096
+
+static KeyTraceWriter writer;
+static struct input_event buffer[BUFFER_EVENTS];
+
+static double seconds_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int64_t event_us(const struct input_event* event)
+{
+    return (int64_t)event->input_event_sec * 1000000 + event->input_event_usec;
+}
+
+static int encode(const char* in_path, const char* out_path)
+{
+    FILE* in = fopen(in_path, "rb");
+    if (in == NULL)
+    {
+        fprintf(stderr, "Cannot open %s: %s.\n", in_path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (!key_trace_writer_open(&writer, out_path))
+    {
+        fprintf(stderr, "Cannot create %s: %s.\n", out_path, strerror(errno));
+        fclose(in);
+        return EXIT_FAILURE;
+    }
+    TvRemoteSm sm;
+    TvRemoteSm_ctor(&sm);
+    sm.vars.output = &tv_output_null_sink;
+    TvRemoteSm_start(&sm);
+    GestureRecognizer gestures;
+    gesture_init(&gestures, &sm, DEFAULT_TAP_WINDOW, DEFAULT_CHORD_WINDOW);
+
+    bool ok = true;
+    size_t n;
+    uint64_t read = 0;
+    while (ok && (n = fread(buffer, sizeof(buffer[0]), BUFFER_EVENTS, in)) > 0)
+    {
+        read += n;
+        for (size_t i = 0; i < n && ok; i++)
+        {
+            const struct input_event* event = &buffer[i];
+            if (event->type != EV_KEY)
+            {
+                continue;
+            }
+            gesture_handle_input_event(&gestures, event);
+            ok = key_trace_writer_add(&writer, event_us(event), event->code, (uint8_t)event->value, (uint8_t)sm.state_id);
+        }
+    }
+    const bool read_error = ferror(in);
+    fclose(in);
+    const uint64_t events = writer.header.event_count;
+    ok = key_trace_writer_close(&writer) && ok;
+    if (read_error || !ok)
+    {
+        fprintf(stderr, "Cannot %s: %s.\n", read_error ? "read the events" : "write the trace", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    printf("%llu input events, %llu key events\n", (unsigned long long)read, (unsigned long long)events);
+    return EXIT_SUCCESS;
+}
+
+static int decode(const char* in_path, const char* out_path)
+{
+    KeyTrace trace;
+    if (!key_trace_open(&trace, in_path))
+    {
+        fprintf(stderr, "Cannot open %s: %s.\n", in_path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    FILE* out = fopen(out_path, "wb");
+    if (out == NULL)
+    {
+        fprintf(stderr, "Cannot create %s: %s.\n", out_path, strerror(errno));
+        key_trace_close(&trace);
+        return EXIT_FAILURE;
+    }
+    static int64_t times_us[KEY_TRACE_BLOCK_EVENTS];
+    bool ok = true;
+    for (uint32_t block = 0; block < trace.header->block_count && ok; block++)
+    {
+        if (!key_trace_times(&trace, block, times_us))
+        {
+            errno = EINVAL;
+            ok = false;
+            break;
+        }
+        const uint16_t* codes = key_trace_codes(&trace, block);
+        const uint8_t* values = key_trace_values(&trace, block);
+        size_t n = 0;
+        for (uint32_t i = 0; i < trace.blocks[block].count && ok; i++)
+        {
+            struct input_event key = { .type = EV_KEY, .code = codes[i], .value = values[i] };
+            key.input_event_sec = times_us[i] / 1000000;
+            key.input_event_usec = times_us[i] % 1000000;
+            struct input_event sync = key;
+            sync.type = EV_SYN;
+            sync.code = SYN_REPORT;
+            sync.value = 0;
+            buffer[n++] = key;
+            buffer[n++] = sync;
+            if (n == BUFFER_EVENTS)
+            {
+                ok = fwrite(buffer, sizeof(buffer[0]), n, out) == n;
+                n = 0;
+            }
+        }
+        ok = ok && fwrite(buffer, sizeof(buffer[0]), n, out) == n;
+    }
+    ok = (fclose(out) == 0) && ok;
+    key_trace_close(&trace);
+    if (!ok)
+    {
+        fprintf(stderr, "Cannot decode %s: %s.\n", in_path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+static int states(const char* path)
+{
+    KeyTrace trace;
+    if (!key_trace_open(&trace, path))
+    {
+        fprintf(stderr, "Cannot open %s: %s.\n", path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    uint64_t state_us[KEY_TRACE_MAX_STATES] = { 0 };
+    const double start = seconds_now();
+    const bool ok = key_trace_time_in_states(&trace, state_us);
+    const double seconds = seconds_now() - start;
+    if (!ok)
+    {
+        fprintf(stderr, "Cannot read %s: %s.\n", path, strerror(EINVAL));
+        key_trace_close(&trace);
+        return EXIT_FAILURE;
+    }
+    uint64_t total_us = 0;
+    for (int id = 0; id < trace.header->state_count; id++)
+    {
+        total_us += state_us[id];
+    }
+    for (int id = 0; id < trace.header->state_count; id++)
+    {
+        if (state_us[id] > 0)
+        {
+            printf("%-32s %12.1f s %6.2f%%\n", trace.state_names[id], (double)state_us[id] / 1e6,
+                100.0 * (double)state_us[id] / (double)total_us);
+        }
+    }
+    // The time & state columns are what the query reads.
+    uint64_t scanned = 0;
+    for (uint32_t block = 0; block < trace.header->block_count; block++)
+    {
+        scanned += trace.blocks[block].count + trace.blocks[block].time_size;
+    }
+    printf("%llu key events, %.1f MB of columns in %.2f ms (%.2f GB/s, %.1f M events/s)\n",
+        (unsigned long long)trace.header->event_count, (double)scanned / 1e6, seconds * 1e3,
+        (double)scanned / seconds / 1e9, (double)trace.header->event_count / seconds / 1e6);
+    key_trace_close(&trace);
+    return EXIT_SUCCESS;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s encode IN.ev OUT.ktr | decode IN.ktr OUT.ev | states IN.ktr\n", name);
+}
+
+int main(int argc, char ** argv)
+{
+    if (argc == 4 && strcmp(argv[1], "encode") == 0)
+    {
+        return encode(argv[2], argv[3]);
+    }
+    if (argc == 4 && strcmp(argv[1], "decode") == 0)
+    {
+        return decode(argv[2], argv[3]);
+    }
+    if (argc == 3 && strcmp(argv[1], "states") == 0)
+    {
+        return states(argv[2]);
+    }
+    usage(argv[0]);
+    return EXIT_FAILURE;
+}
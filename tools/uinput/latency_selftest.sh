@@ -0,0 +1,33 @@
+#!/bin/sh
+# Measures the input-to-action latency of `remote` with key presses injected by `uinput_inject`.
+# Needs root (uinput & the event device). Extra arguments are passed to uinput_inject.
+#
+# Usage: latency_selftest.sh BUILD_DIR [-r PRESSES_PER_SEC] [-n COUNT] ...
+
+set -e
+
+build_dir=${1:?Usage: $0 BUILD_DIR [uinput_inject options]}
+shift
+
+path_file=$(mktemp)
+rm -f "$path_file"
+trap 'rm -f "$path_file"' EXIT
+
+"$build_dir/uinput_inject" -p "$path_file" "$@" >/dev/null &
+inject_pid=$!
+
+# Wait for the virtual keyboard to show up.
+while [ ! -s "$path_file" ]; do
+    if ! kill -0 "$inject_pid" 2>/dev/null; then
+        echo "uinput_inject failed." >&2
+        exit 1
+    fi
+    sleep 0.05
+done
+
+"$build_dir/remote" --latency --device "$(cat "$path_file")" >/dev/null &
+remote_pid=$!
+
+wait "$inject_pid"
+kill -INT "$remote_pid"
+wait "$remote_pid"
@@ -0,0 +1,401 @@
+// End-to-end test of the `remote` binary through a virtual uinput keyboard (needs root).
+//
+// Creates the keyboard, starts `remote --device <keyboard>` with its stdout on a pipe, waits for
+// "Starting loop." and then runs a script, one command per line ('#' starts a comment):
+//   press KEY [MS]       press KEY (B1 or B2) & release it after MS ms (default 20)
+//   hold KEY MS          same as press, for long-presses
+//   wait MS              sleep
+//   expect TEXT          the next output line of remote must be TEXT (within the -t timeout)
+//   burst COUNT [LINES]  short-press B1 & B2 alternately COUNT times as fast as remote keeps up,
+//                        each press producing LINES output lines (default 2), and report the throughput
+// Key events are sent on an absolute schedule so the press & hold times don't drift.
+//
+// Usage: remote_e2e [-b REMOTE] [-t TIMEOUT_MS] [-W WINDOW] SCRIPT [-- REMOTE_OPTIONS...]
+// Exits with 0 when every expectation was met.
+
+#include <errno.h> // for errno
+#include <fcntl.h> // for open
+#include <poll.h> // for poll
+#include <signal.h> // for kill
+#include <stdbool.h> // for bool
+#include <stdio.h> // for printf
+#include <stdlib.h> // for strtoul
+#include <string.h> // for strcmp
+#include <sys/wait.h> // for waitpid
+#include <time.h> // for clock_nanosleep
+#include <unistd.h> // for fork
+
+#include "input/key_input.h"
+#include "input/uinput_device.h"
+
+#define NANOSEC_PER_SEC 1000000000LL
+#define NANOSEC_PER_MS 1000000LL
+#define DEFAULT_PRESS_MS 20
+#define DEFAULT_BURST_LINES 2
+#define MAX_LINE 256
+#define MAX_REMOTE_ARGS 32
+
+// Line reader for the output of remote.
+typedef struct OutputReader {
+    int fd;
+    char buffer[4096];
+    size_t length;
+    unsigned long lines;
+} OutputReader;
+
+typedef struct Harness {
+    int keyboard;
+    pid_t remote;
+    OutputReader output;
+    int timeout_ms;
+    unsigned int window;
+} Harness;
+
+static void add_ns(struct timespec* ts, const long long ns)
+{
+    long long total = ts->tv_nsec + ns;
+    ts->tv_sec += total / NANOSEC_PER_SEC;
+    ts->tv_nsec = total % NANOSEC_PER_SEC;
+}
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * NANOSEC_PER_SEC + ts.tv_nsec;
+}
+
+static void sleep_until(const struct timespec* deadline)
+{
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, deadline, NULL) == EINTR)
+    {
+    }
+}
+
+static void sleep_ms(const long long ms)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    add_ns(&deadline, ms * NANOSEC_PER_MS);
+    sleep_until(&deadline);
+}
+
+// Press `code`, release it `hold_ms` after the press.
+static void press_key(const int keyboard, const int code, const long long hold_ms)
+{
+    struct timespec release;
+    clock_gettime(CLOCK_MONOTONIC, &release);
+    uinput_send_key(keyboard, code, PRESSED_EVENT);
+    add_ns(&release, hold_ms * NANOSEC_PER_MS);
+    sleep_until(&release);
+    uinput_send_key(keyboard, code, RELEASED_EVENT);
+}
+
+// Read the next line (without the newline) into `line`.
+// Returns false on timeout or when remote closed its output.
+static bool read_line(OutputReader* reader, char* line, const size_t size, const int timeout_ms)
+{
+    const long long deadline = now_ns() + (long long)timeout_ms * NANOSEC_PER_MS;
+    for (;;)
+    {
+        char* newline = memchr(reader->buffer, '\n', reader->length);
+        if (newline != NULL)
+        {
+            size_t length = (size_t)(newline - reader->buffer);
+            size_t copied = length < size - 1 ? length : size - 1;
+            memcpy(line, reader->buffer, copied);
+            line[copied] = '\0';
+            reader->length -= length + 1;
+            memmove(reader->buffer, newline + 1, reader->length);
+            reader->lines++;
+            return true;
+        }
+        if (reader->length == sizeof(reader->buffer))
+        {
+            // Overlong line, return it in pieces.
+            reader->buffer[reader->length - 1] = '\n';
+            continue;
+        }
+
+        const long long left_ms = (deadline - now_ns()) / NANOSEC_PER_MS;
+        if (left_ms < 0)
+        {
+            return false;
+        }
+        struct pollfd input = { .fd = reader->fd, .events = POLLIN };
+        const int ready = poll(&input, 1, (int)left_ms);
+        if (ready == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ready <= 0)
+        {
+            return false;
+        }
+        const ssize_t n = read(reader->fd, reader->buffer + reader->length, sizeof(reader->buffer) - reader->length);
+        if (n <= 0)
+        {
+            return false;
+        }
+        reader->length += (size_t)n;
+    }
+}
+
+// Start remote reading `device_path`, with its stdout on a pipe.
+static pid_t start_remote(const char* remote, const char* device_path, char** extra_args, const int extra_count, int* output_fd)
+{
+    int pipe_fds[2];
+    if (pipe(pipe_fds) == -1)
+    {
+        return -1;
+    }
+
+    char* args[MAX_REMOTE_ARGS + 4];
+    int count = 0;
+    args[count++] = (char*)remote;
+    args[count++] = "--device";
+    args[count++] = (char*)device_path;
+    for (int i = 0; i < extra_count && i < MAX_REMOTE_ARGS; i++)
+    {
+        args[count++] = extra_args[i];
+    }
+    args[count] = NULL;
+
+    const pid_t pid = fork();
+    if (pid == 0)
+    {
+        // Keep remote away from the terminal settings of the harness.
+        const int null_fd = open("/dev/null", O_RDONLY);
+        if (null_fd != -1)
+        {
+            dup2(null_fd, STDIN_FILENO);
+            close(null_fd);
+        }
+        dup2(pipe_fds[1], STDOUT_FILENO);
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        execv(remote, args);
+        fprintf(stderr, "Cannot run %s: %s.\n", remote, strerror(errno));
+        _exit(127);
+    }
+    close(pipe_fds[1]);
+    if (pid == -1)
+    {
+        close(pipe_fds[0]);
+        return -1;
+    }
+    *output_fd = pipe_fds[0];
+    return pid;
+}
+
+static int key_code(const char* name)
+{
+    if (strcmp(name, "B1") == 0)
+    {
+        return B1_CODE;
+    }
+    if (strcmp(name, "B2") == 0)
+    {
+        return B2_CODE;
+    }
+    return -1;
+}
+
+// Alternate B1 & B2 short-presses, keeping at most `window` presses whose output hasn't been read
+// yet so the evdev buffer of remote never overflows.
+static bool run_burst(Harness* harness, const unsigned long count, const unsigned long lines_per_press)
+{
+    char line[MAX_LINE];
+    unsigned long sent = 0;
+    unsigned long lines = 0;
+    const long long start = now_ns();
+    while (lines < count * lines_per_press)
+    {
+        while (sent < count && sent - lines / lines_per_press < harness->window)
+        {
+            const int code = (sent % 2 == 0) ? B1_CODE : B2_CODE;
+            uinput_send_key(harness->keyboard, code, PRESSED_EVENT);
+            uinput_send_key(harness->keyboard, code, RELEASED_EVENT);
+            sent++;
+        }
+        if (!read_line(&harness->output, line, sizeof(line), harness->timeout_ms))
+        {
+            fprintf(stderr, "Burst stalled after %lu of %lu presses (%lu lines).\n", lines / lines_per_press, count, lines);
+            return false;
+        }
+        lines++;
+    }
+    const double seconds = (double)(now_ns() - start) / 1e9;
+    printf("Burst: %lu presses, %lu lines in %.3f s (%.0f presses/s, %.1f us/press).\n",
+        count, lines, seconds, (double)count / seconds, seconds * 1e6 / (double)count);
+    return true;
+}
+
+// Run the script. Returns the number of failed commands.
+static int run_script(Harness* harness, FILE* script, const char* script_name)
+{
+    char command_line[MAX_LINE];
+    char line[MAX_LINE];
+    unsigned int line_number = 0;
+    int failures = 0;
+    while (fgets(command_line, sizeof(command_line), script) != NULL)
+    {
+        line_number++;
+        command_line[strcspn(command_line, "\r\n#")] = '\0';
+
+        char command[16];
+        int offset = 0;
+        if (sscanf(command_line, " %15s %n", command, &offset) != 1)
+        {
+            continue;
+        }
+        const char* arguments = command_line + offset;
+
+        char key[8];
+        unsigned long first = 0;
+        unsigned long second = 0;
+        if (strcmp(command, "press") == 0 || strcmp(command, "hold") == 0)
+        {
+            second = DEFAULT_PRESS_MS;
+            const int parsed = sscanf(arguments, "%7s %lu", key, &second);
+            const int code = parsed >= 1 ? key_code(key) : -1;
+            if (code == -1 || (strcmp(command, "hold") == 0 && parsed != 2))
+            {
+                fprintf(stderr, "%s:%u: usage: %s B1|B2 %s\n", script_name, line_number, command, strcmp(command, "hold") == 0 ? "MS" : "[MS]");
+                return failures + 1;
+            }
+            press_key(harness->keyboard, code, (long long)second);
+        }
+        else if (strcmp(command, "wait") == 0 && sscanf(arguments, "%lu", &first) == 1)
+        {
+            sleep_ms((long long)first);
+        }
+        else if (strcmp(command, "expect") == 0)
+        {
+            if (!read_line(&harness->output, line, sizeof(line), harness->timeout_ms))
+            {
+                fprintf(stderr, "%s:%u: expected \"%s\", got no output.\n", script_name, line_number, arguments);
+                return failures + 1;
+            }
+            if (strcmp(line, arguments) != 0)
+            {
+                fprintf(stderr, "%s:%u: expected \"%s\", got \"%s\".\n", script_name, line_number, arguments, line);
+                failures++;
+            }
+        }
+        else if (strcmp(command, "burst") == 0 && sscanf(arguments, "%lu %lu", &first, &second) >= 1)
+        {
+            if (second == 0)
+            {
+                second = DEFAULT_BURST_LINES;
+            }
+            if (!run_burst(harness, first, second))
+            {
+                return failures + 1;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "%s:%u: unknown command \"%s\".\n", script_name, line_number, command_line);
+            return failures + 1;
+        }
+    }
+    return failures;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-b REMOTE] [-t TIMEOUT_MS] [-W WINDOW] SCRIPT [-- REMOTE_OPTIONS...]\n", name);
+}
+
+int main(int argc, char ** argv)
+{
+    const char* remote = "./remote";
+    Harness harness = { .timeout_ms = 2000, .window = 8 };
+
+    int option;
+    while ((option = getopt(argc, argv, "b:t:W:")) != -1)
+    {
+        switch (option)
+        {
+            case 'b': remote = optarg; break;
+            case 't': harness.timeout_ms = (int)strtoul(optarg, NULL, 10); break;
+            case 'W': harness.window = (unsigned int)strtoul(optarg, NULL, 10); break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind >= argc || harness.window == 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char* script_name = argv[optind];
+    FILE* script = fopen(script_name, "r");
+    if (script == NULL)
+    {
+        fprintf(stderr, "Cannot open %s: %s.\n", script_name, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    // Everything after the script (getopt stops at the first operand & skips "--") goes to remote.
+    char** extra_args = argv + optind + 1;
+    int extra_count = argc - optind - 1;
+    if (extra_count > 0 && strcmp(extra_args[0], "--") == 0)
+    {
+        extra_args++;
+        extra_count--;
+    }
+
+    const int codes[] = { B1_CODE, B2_CODE };
+    char device_path[64];
+    harness.keyboard = uinput_create_keyboard("TvRemote e2e keypad", codes, 2, device_path, sizeof(device_path));
+    if (harness.keyboard == -1)
+    {
+        fprintf(stderr, "Cannot create the virtual keyboard: %s.\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    harness.remote = start_remote(remote, device_path, extra_args, extra_count, &harness.output.fd);
+    if (harness.remote == -1)
+    {
+        fprintf(stderr, "Cannot start %s: %s.\n", remote, strerror(errno));
+        uinput_destroy_keyboard(harness.keyboard);
+        return EXIT_FAILURE;
+    }
+
+    // The device is open once the loop starts.
+    int failures = 0;
+    char line[MAX_LINE];
+    bool started = false;
+    while (!started && read_line(&harness.output, line, sizeof(line), harness.timeout_ms))
+    {
+        started = strcmp(line, "Starting loop.") == 0;
+    }
+    if (!started)
+    {
+        fprintf(stderr, "%s didn't start.\n", remote);
+        failures++;
+    }
+    else
+    {
+        harness.output.lines = 0;
+        const long long start = now_ns();
+        failures += run_script(&harness, script, script_name);
+        printf("Script: %lu output lines in %.3f s, %d failures.\n",
+            harness.output.lines, (double)(now_ns() - start) / 1e9, failures);
+    }
+    fclose(script);
+
+    kill(harness.remote, SIGINT);
+    int status = 0;
+    waitpid(harness.remote, &status, 0);
+    if (!WIFEXITED(status))
+    {
+        fprintf(stderr, "%s was killed by signal %d.\n", remote, WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+        failures++;
+    }
+    close(harness.output.fd);
+    uinput_destroy_keyboard(harness.keyboard);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,154 @@
+// Injects B1/B2 key presses at a fixed rate through a virtual uinput keyboard (needs root).
+//
+// Prints the event device of the virtual keyboard, waits so `remote --device` can open it, then:
+//   - holds B1 to turn the TV on,
+//   - sends COUNT short presses alternating B1 & B2, on an absolute schedule so the rate doesn't drift,
+//   - holds B1 to turn the TV off.
+// Used by latency_selftest.sh to get reproducible latency numbers without a human at the keyboard.
+
+#include <errno.h> // for errno
+#include <stdio.h> // for printf
+#include <stdlib.h> // for strtoul
+#include <string.h> // for strerror
+#include <time.h> // for clock_nanosleep
+#include <unistd.h> // for getopt
+
+#include "input/key_input.h"
+#include "input/uinput_device.h"
+
+#define NANOSEC_PER_SEC 1000000000LL
+#define NANOSEC_PER_MS 1000000LL
+
+static void add_ns(struct timespec* ts, const long long ns)
+{
+    long long total = ts->tv_nsec + ns;
+    ts->tv_sec += total / NANOSEC_PER_SEC;
+    ts->tv_nsec = total % NANOSEC_PER_SEC;
+}
+
+static long long to_ns(const struct timespec* ts)
+{
+    return (long long)ts->tv_sec * NANOSEC_PER_SEC + ts->tv_nsec;
+}
+
+static void sleep_until(const struct timespec* deadline)
+{
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, deadline, NULL) == EINTR)
+    {
+    }
+}
+
+static void hold_key(const int fd, const int code, const long long hold_ms)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    uinput_send_key(fd, code, PRESSED_EVENT);
+    add_ns(&deadline, hold_ms * NANOSEC_PER_MS);
+    sleep_until(&deadline);
+    uinput_send_key(fd, code, RELEASED_EVENT);
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-r PRESSES_PER_SEC] [-n COUNT] [-H HOLD_MS] [-w WAIT_MS] [-p DEVICE_PATH_FILE]\n", name);
+}
+
+int main(int argc, char ** argv)
+{
+    unsigned long rate = 10;
+    unsigned long count = 200;
+    unsigned long hold_ms = 20;
+    unsigned long wait_ms = 1000;
+    const char* path_file = NULL;
+
+    int option;
+    while ((option = getopt(argc, argv, "r:n:H:w:p:")) != -1)
+    {
+        switch (option)
+        {
+            case 'r': rate = strtoul(optarg, NULL, 10); break;
+            case 'n': count = strtoul(optarg, NULL, 10); break;
+            case 'H': hold_ms = strtoul(optarg, NULL, 10); break;
+            case 'w': wait_ms = strtoul(optarg, NULL, 10); break;
+            case 'p': path_file = optarg; break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (rate == 0)
+    {
+        rate = 1;
+    }
+    const long long period_ns = NANOSEC_PER_SEC / (long long)rate;
+    if ((long long)hold_ms * NANOSEC_PER_MS >= period_ns)
+    {
+        fprintf(stderr, "The hold time must be shorter than the press period (%lld ms).\n", period_ns / NANOSEC_PER_MS);
+        return EXIT_FAILURE;
+    }
+
+    const int codes[] = { B1_CODE, B2_CODE };
+    char device_path[64];
+    const int fd = uinput_create_keyboard("TvRemote virtual keypad", codes, 2, device_path, sizeof(device_path));
+    if (fd == -1)
+    {
+        fprintf(stderr, "Cannot create the virtual keyboard: %s.\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    printf("%s\n", device_path);
+    fflush(stdout);
+    if (path_file != NULL)
+    {
+        FILE* file = fopen(path_file, "w");
+        if (file != NULL)
+        {
+            fprintf(file, "%s\n", device_path);
+            fclose(file);
+        }
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    add_ns(&deadline, (long long)wait_ms * NANOSEC_PER_MS);
+    sleep_until(&deadline);
+
+    // Power on.
+    hold_key(fd, B1_CODE, LONG_PRESS_TIMEOUT + 200);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    deadline = start;
+    unsigned long late = 0;
+    for (unsigned long i = 0; i < count; i++)
+    {
+        const int code = (i % 2 == 0) ? B1_CODE : B2_CODE;
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (to_ns(&now) > to_ns(&deadline) + NANOSEC_PER_MS)
+        {
+            late++;
+        }
+        sleep_until(&deadline);
+        uinput_send_key(fd, code, PRESSED_EVENT);
+        struct timespec release = deadline;
+        add_ns(&release, (long long)hold_ms * NANOSEC_PER_MS);
+        sleep_until(&release);
+        uinput_send_key(fd, code, RELEASED_EVENT);
+        add_ns(&deadline, period_ns);
+    }
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    // Power off.
+    hold_key(fd, B1_CODE, LONG_PRESS_TIMEOUT + 200);
+
+    const double seconds = (double)(to_ns(&end) - to_ns(&start)) / 1e9;
+    fprintf(stderr, "Injected %lu presses in %.3f s (%.1f/s, %lu late).\n", count, seconds, (double)count / seconds, late);
+
+    // Give the reader time to drain the last events before the device disappears.
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    add_ns(&deadline, 200 * NANOSEC_PER_MS);
+    sleep_until(&deadline);
+    uinput_destroy_keyboard(fd);
+    return EXIT_SUCCESS;
+}